@@ -0,0 +1,114 @@
+import argparse
+import json
+import sys
+from collections import Counter
+
+# Highest capture_version this script understands
+SUPPORTED_CAPTURE_VERSION = 2
+
+# Matches SchemaTypeCategory_t of hl2sdk
+TYPE_CATEGORIES = ['builtin', 'ptr', 'bitfield', 'fixed_array', 'atomic', 'declared_class', 'declared_enum']
+
+class CaptureStats:
+	def __init__(self):
+		self.scopes = 0
+		self.classes = 0
+		self.enums = 0
+		self.fields = 0
+		self.enumerators = 0
+		self.atomic_infos = 0
+		self.metatags = Counter()
+		self.type_categories = Counter()
+		self.type_depths = Counter()
+		self.atomic_uses = Counter()
+		self.base_counts = Counter()
+		self.field_counts = Counter()
+
+	def add_metatags(self, node):
+		for metatag in node.get('metatags', []):
+			self.metatags[metatag['name']] += 1
+
+	def add_type(self, node, depth = 1):
+		"""
+		Walks a captured field type tree, returns its nesting depth.
+		"""
+
+		category = node.get('category', -1)
+		self.type_categories[TYPE_CATEGORIES[category] if 0 <= category < len(TYPE_CATEGORIES) else 'invalid'] += 1
+
+		if 'atomic_token' in node:
+			self.atomic_uses[node['name'].split('<')[0].strip()] += 1
+
+		max_depth = depth
+		for inner in ([node['inner']] if 'inner' in node else []) + node.get('template', []):
+			max_depth = max(max_depth, self.add_type(inner, depth + 1))
+
+		return max_depth
+
+	def add_scope(self, scope):
+		self.scopes += 1
+		self.atomic_infos += len(scope.get('atomics', []))
+
+		for atomic in scope.get('atomics', []):
+			self.add_metatags(atomic)
+
+		for cls in scope.get('classes', []):
+			self.classes += 1
+			self.add_metatags(cls)
+			self.base_counts[len(cls.get('bases', []))] += 1
+			self.field_counts[len(cls.get('fields', []))] += 1
+
+			for field in cls.get('fields', []):
+				self.fields += 1
+				self.add_metatags(field)
+				self.type_depths[self.add_type(field['type'])] += 1
+
+		for enum in scope.get('enums', []):
+			self.enums += 1
+			self.add_metatags(enum)
+
+			for enumerator in enum.get('enumerators', []):
+				self.enumerators += 1
+				self.add_metatags(enumerator)
+
+	def to_json(self, top):
+		return {
+			'scopes': self.scopes,
+			'classes': self.classes,
+			'enums': self.enums,
+			'fields': self.fields,
+			'enumerators': self.enumerators,
+			'atomic_infos': self.atomic_infos,
+			'metatags_total': sum(self.metatags.values()),
+			'metatags_distinct': len(self.metatags),
+			'metatags_top': dict(self.metatags.most_common(top)),
+			'type_categories': dict(self.type_categories),
+			'type_depths': dict(sorted(self.type_depths.items())),
+			'atomic_uses_top': dict(self.atomic_uses.most_common(top)),
+			'base_counts': dict(sorted(self.base_counts.items())),
+			'field_counts': dict(sorted(self.field_counts.items()))
+		}
+
+def main():
+	parser = argparse.ArgumentParser(description = 'Prints the shape of real schema data out of a capture file (see capture dump flag), such as metatag distribution, type nesting depth and atomic reuse, to calibrate synthetic benchmarks against.')
+	parser.add_argument('capture_path', help = 'The path to the *_capture.json file.', type = str)
+	parser.add_argument('-t', '--top', help = 'Amount of most common metatags and atomics to list. Default is 20.', type = int, dest = 'top', default = 20)
+
+	args = parser.parse_args()
+
+	with open(args.capture_path, 'r') as inp:
+		capture = json.load(inp)
+
+	capture_version = capture.get('capture_version', 0)
+	if capture_version > SUPPORTED_CAPTURE_VERSION:
+		raise Exception(f'Unsupported capture format version {capture_version}, max supported is {SUPPORTED_CAPTURE_VERSION}')
+
+	stats = CaptureStats()
+	for scope in capture.get('scopes', []):
+		stats.add_scope(scope)
+
+	json.dump(stats.to_json(args.top), sys.stdout, indent = '\t')
+	print()
+
+if __name__ == '__main__':
+	main()
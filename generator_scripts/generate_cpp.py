@@ -69,7 +69,8 @@ class CppWriter(FileWriter):
 							bitfield_last_member = j
 							break
 					for j in range(i, bitfield_last_member):
-						class_obj.get_members()[j].get_type().expected_size = bitfield_size
+						bitfield_type = class_obj.get_members()[j].get_type()
+						bitfield_type.expected_size = bitfield_type.unit_size or bitfield_size
 
 				bitfield_accum += member.get_type().bits_count
 			else:
@@ -637,7 +638,7 @@ def main():
 			print_stdout('Generating all class definitions...')
 
 			for defn in schema_file.defs:
-				if defn.project in ['server', 'client'] and defn.project != args.preferred_project:
+				if not defn.is_in_preferred_project(args.preferred_project):
 					continue
 
 				total_generated += 1
@@ -157,7 +157,7 @@ def main():
 
 				start_at = schema_file.defs.get_def_idx(defn) + 1
 
-				if defn.project in ['server', 'client'] and defn.project != args.preferred_project:
+				if not defn.is_in_preferred_project(args.preferred_project):
 					continue
 
 				total_generated += 1
@@ -282,6 +282,13 @@ class SubTypeBitfield:
 	bits_count = 0
 	expected_size = 1
 
+	# Storage unit placement guessed by the dumper (placement is 'heuristic'), None for older dumps
+	# or when the guess contradicts the class layout
+	placement = None
+	storage_offset = None
+	unit_size = None
+	shift = None
+
 	def __init__(self):
 		pass
 
@@ -305,6 +312,10 @@ class SubTypeBitfield:
 	def parse_from(obj_list: 'ObjectList', raw_bitfield):
 		subtype_bitfield = SubTypeBitfield()
 		subtype_bitfield.bits_count = raw_bitfield['count']
+		subtype_bitfield.placement = raw_bitfield.get('placement')
+		subtype_bitfield.storage_offset = raw_bitfield.get('storage_offset')
+		subtype_bitfield.unit_size = raw_bitfield.get('unit_size')
+		subtype_bitfield.shift = raw_bitfield.get('shift')
 		return subtype_bitfield
 
 class SubTypeLiteral:
@@ -461,6 +472,7 @@ class ObjectDefinition:
 	name = ''
 	scope = ''
 	project = ''
+	projects: list[str] = None
 	type: ObjectTypes = ObjectTypes.NONE
 	size = 0
 	alignment = 0
@@ -478,6 +490,17 @@ class ObjectDefinition:
 	def is_parent_scope_def(self):
 		return '::' not in self.name
 
+	def is_in_preferred_project(self, preferred_project):
+		"""
+		Returns:
+			bool: False if definition only belongs to the server or client project other than the preferred one.
+		"""
+
+		if preferred_project in self.projects:
+			return True
+
+		return not any(project in ['server', 'client'] for project in self.projects)
+
 	def get_scoped_name(self):
 		return self.name.split('::')[-1]
 
@@ -631,6 +654,7 @@ class ObjectDefinition:
 		obj_def.size = -1
 		obj_def.alignment = -1
 		obj_def.traits = None
+		obj_def.projects = []
 		obj_def.synthetic = True
 		return obj_def
 
@@ -641,6 +665,9 @@ class ObjectDefinition:
 		obj_def.scope = raw_def.get('scope', '')
 		obj_def.project = raw_def.get('project', '')
 
+		# Defs merged across projects list all of them (dedupe_projects dump flag)
+		obj_def.projects = raw_def.get('projects', [obj_def.project])
+
 		if not ObjectTypes.has_value(raw_def['type']):
 			raise Exception(f'Unknown object type: {raw_def["type"]}')
 
@@ -37,9 +37,38 @@ class PulseTraits:
 
 		return pulse_traits
 
+class PulseTypeDescriptor:
+	kind = ''
+	name = ''
+	library_class = ''
+	subtype: 'PulseTypeDescriptor' = None
+
+	def __init__(self):
+		pass
+
+	@staticmethod
+	def parse_from_list(raw_types):
+		"""
+		Parses pulse_types table, subtypes are always placed before the types referencing them.
+		"""
+
+		pulse_types = []
+		for raw_type in raw_types:
+			pulse_type = PulseTypeDescriptor()
+			pulse_type.kind = raw_type['kind']
+			pulse_type.name = raw_type['name']
+			pulse_type.library_class = raw_type.get('library_class', '')
+
+			if 'subtype_idx' in raw_type:
+				pulse_type.subtype = pulse_types[raw_type['subtype_idx']]
+
+			pulse_types.append(pulse_type)
+		return pulse_types
+
 class DomainFunctionParam:
 	name = ''
 	type = ''
+	type_desc: PulseTypeDescriptor | None = None
 	default_value = ''
 	traits: PulseTraits = None
 	
@@ -66,19 +95,25 @@ class DomainFunctionParam:
 		return ''
 
 	@staticmethod
-	def parse_from(raw_param):
+	def parse_from(raw_param, pulse_types):
 		param = DomainFunctionParam()
 		param.name = raw_param['name']
-		param.type = raw_param['type']
+
+		# Older dumps stored the stringified type directly
+		if 'type_idx' in raw_param:
+			param.type_desc = pulse_types[raw_param['type_idx']]
+			param.type = param.type_desc.name
+		else:
+			param.type = raw_param['type']
 		param.default_value = raw_param.get('default_value', '')
 		param.traits = PulseTraits.parse_from(raw_param.get('traits', {}))
 		return param
 	
 	@staticmethod
-	def parse_from_list(raw_params):
+	def parse_from_list(raw_params, pulse_types):
 		params = []
 		for raw_param in raw_params:
-			params.append(DomainFunctionParam.parse_from(raw_param))
+			params.append(DomainFunctionParam.parse_from(raw_param, pulse_types))
 		return params
 
 class DomainFunctionDefinition:
@@ -97,24 +132,24 @@ class DomainFunctionDefinition:
 		return self.library_name.split('!')[-1].split('::')[-1]
 
 	@staticmethod
-	def parse_from(raw_function):
+	def parse_from(raw_function, pulse_types):
 		function_def = DomainFunctionDefinition()
 		function_def.name = raw_function['name']
 		function_def.library_name = raw_function['library_name']
 		function_def.description = raw_function['description']
 		function_def.type = raw_function['type']
 
-		function_def.params = DomainFunctionParam.parse_from_list(raw_function['params'])
-		function_def.rets = DomainFunctionParam.parse_from_list(raw_function['rets'])
+		function_def.params = DomainFunctionParam.parse_from_list(raw_function['params'], pulse_types)
+		function_def.rets = DomainFunctionParam.parse_from_list(raw_function['rets'], pulse_types)
 
 		function_def.traits = PulseTraits.parse_from(raw_function.get('traits', {}))
 		return function_def
 
 	@staticmethod
-	def parse_from_list(raw_functions):
+	def parse_from_list(raw_functions, pulse_types):
 		function_defs = []
 		for raw_function in raw_functions:
-			function_defs.append(DomainFunctionDefinition.parse_from(raw_function))
+			function_defs.append(DomainFunctionDefinition.parse_from(raw_function, pulse_types))
 		return function_defs
 
 class DomainScopeDefinition:
@@ -125,17 +160,17 @@ class DomainScopeDefinition:
 		pass
 
 	@staticmethod
-	def parse_from(raw_scope):
+	def parse_from(raw_scope, pulse_types):
 		scope_def = DomainScopeDefinition()
 		scope_def.name = raw_scope['name']
-		scope_def.functions = DomainFunctionDefinition.parse_from_list(raw_scope['functions'])
+		scope_def.functions = DomainFunctionDefinition.parse_from_list(raw_scope['functions'], pulse_types)
 		return scope_def
 
 	@staticmethod
-	def parse_from_list(raw_scopes):
+	def parse_from_list(raw_scopes, pulse_types):
 		scope_defs = []
 		for raw_scope in raw_scopes:
-			scope_defs.append(DomainScopeDefinition.parse_from(raw_scope))
+			scope_defs.append(DomainScopeDefinition.parse_from(raw_scope, pulse_types))
 		return scope_defs
 
 class DomainDefinition:
@@ -149,18 +184,20 @@ class DomainDefinition:
 		pass
 
 	@staticmethod
-	def parse_from(raw_domain):
+	def parse_from(raw_domain, pulse_types):
 		domain_def = DomainDefinition()
 		domain_def.name = raw_domain['name']
 		domain_def.description = raw_domain.get('description', '')
 		domain_def.friendly_name = raw_domain.get('friendly_name', '')
 		domain_def.cursor = raw_domain.get('cursor', '')
-		domain_def.scopes = DomainScopeDefinition.parse_from_list(raw_domain['cpp_scopes'])
+		domain_def.scopes = DomainScopeDefinition.parse_from_list(raw_domain['cpp_scopes'], pulse_types)
 		return domain_def
 	
 	@staticmethod
-	def parse_from_list(raw_domains):
+	def parse_from_list(raw_domains, raw_pulse_types = []):
+		pulse_types = PulseTypeDescriptor.parse_from_list(raw_pulse_types)
+
 		domain_defs = []
 		for raw_domain in raw_domains:
-			domain_defs.append(DomainDefinition.parse_from(raw_domain))
+			domain_defs.append(DomainDefinition.parse_from(raw_domain, pulse_types))
 		return domain_defs
\ No newline at end of file
@@ -4,6 +4,9 @@ from generator_scripts.common import ArgsFlags
 from generator_scripts.obj_defs import ObjectList
 from generator_scripts.pulse_defs import DomainDefinition
 
+# Highest dump_format_version these scripts understand
+SUPPORTED_DUMP_FORMAT_VERSION = 2
+
 class SchemaFile:
 	path = ''
 	schema = None
@@ -27,10 +30,174 @@ class SchemaFile:
 				self.schema = json.load(inp)
 			except:
 				raise Exception('Failed to parse JSON schema info')
+
+		dump_format_version = self.schema.get('dumper_info', {}).get('dump_format_version', 1)
+		if dump_format_version > SUPPORTED_DUMP_FORMAT_VERSION:
+			raise Exception(f'Unsupported schema file format version {dump_format_version}, max supported is {SUPPORTED_DUMP_FORMAT_VERSION}')
+
+		compact = self.schema.get('compact', {})
+		typed_metatags = set(compact.get('typed_metatags', []))
+
+		if self.has_interned_strings():
+			strings = self.schema.get('strings', [])
+			SchemaFile.resolve_interned_strings(self.schema, strings, typed_metatags)
+
+			if 'defaults' in compact:
+				SchemaFile.resolve_interned_strings(compact['defaults'], strings, typed_metatags)
+
+		if self.is_compact():
+			SchemaFile.expand_compact(self.schema, compact)
 		
 		self.defs = ObjectList.parse_from(self.schema.get('defs', []))
-		self.pulse_bindings = DomainDefinition.parse_from_list(self.schema.get('pulse_bindings', []))
+		self.pulse_bindings = DomainDefinition.parse_from_list(self.schema.get('pulse_bindings', []), self.schema.get('pulse_types', []))
 		
+	@staticmethod
+	def resolve_interned_strings(node, strings, typed_metatags = set(), parent_key = None):
+		"""
+		Replaces string table indices with the strings they reference, in place.
+		Args:
+			node: The JSON node to walk.
+			strings (list): The root strings table of the schema file.
+			typed_metatags (set): Metatags which values are typed rather than interned (compact profile only).
+			parent_key (str): The key the node is stored under.
+		"""
+
+		if isinstance(node, list):
+			for entry in node:
+				SchemaFile.resolve_interned_strings(entry, strings, typed_metatags, parent_key)
+			return
+
+		if not isinstance(node, dict):
+			return
+
+		interned_keys = ['scope', 'project']
+
+		if parent_key == 'metatags':
+			interned_keys.append('name')
+			if isinstance(node.get('name'), int):
+				node['name'] = strings[node['name']]
+
+			if node.get('name') not in typed_metatags:
+				interned_keys.append('value')
+		elif parent_key == 'atomics' or node.get('type') == 'atomic':
+			interned_keys.append('name')
+
+		for key, value in node.items():
+			if key in interned_keys and isinstance(value, int):
+				node[key] = strings[value]
+			elif key == 'projects':
+				node[key] = [strings[project] if isinstance(project, int) else project for project in value]
+			elif key not in ['strings', 'compact']:
+				SchemaFile.resolve_interned_strings(value, strings, typed_metatags, key)
+
+	@staticmethod
+	def metatag_value_to_str(value):
+		"""
+		Converts a typed metatag value of a compact schema file to its stringified form.
+		"""
+
+		if isinstance(value, bool) or isinstance(value, str):
+			return value
+
+		if isinstance(value, int):
+			return str(value)
+
+		if isinstance(value, float):
+			return f'{value:f}'
+
+		if isinstance(value, dict):
+			if 'class' in value:
+				return f'{value["class"]}::{value["field"]}'
+
+			if 'type' in value:
+				return f'{value["type"]} {value["field"]}'
+
+			return value['field']
+
+		return value
+
+	@staticmethod
+	def expand_flags(mask, flag_names):
+		flags = []
+		for flag in flag_names:
+			if mask & flag['mask']:
+				flags.append(flag['name'])
+				mask &= ~flag['mask']
+
+		for i in range(32):
+			if mask & (1 << i):
+				flags.append(f'UNKNOWN_BIT_{i}')
+
+		return flags
+
+	@staticmethod
+	def expand_compact_metatags(node):
+		if isinstance(node, list):
+			for entry in node:
+				SchemaFile.expand_compact_metatags(entry)
+			return
+
+		if not isinstance(node, dict):
+			return
+
+		for key, value in node.items():
+			if key == 'metatags' and isinstance(value, list):
+				for metatag in value:
+					if 'value' in metatag:
+						metatag['value'] = SchemaFile.metatag_value_to_str(metatag['value'])
+			elif key != 'compact':
+				SchemaFile.expand_compact_metatags(value)
+
+	@staticmethod
+	def expand_compact_atomic_names(node, atomics):
+		if isinstance(node, list):
+			for entry in node:
+				SchemaFile.expand_compact_atomic_names(entry, atomics)
+			return
+
+		if not isinstance(node, dict):
+			return
+
+		if node.get('type') == 'atomic' and 'name' not in node and 'atomic_idx' in node:
+			node['name'] = atomics[node['atomic_idx']]['name']
+
+		for value in node.values():
+			SchemaFile.expand_compact_atomic_names(value, atomics)
+
+	@staticmethod
+	def expand_compact(schema, compact):
+		"""
+		Restores values omitted by the compact profile, so the rest of the scripts see a regular schema file, in place.
+		Args:
+			schema (dict): The schema file root.
+			compact (dict): The compact section of the schema file.
+		"""
+
+		defaults = compact.get('defaults', {})
+
+		for raw_def in schema.get('defs', []):
+			for key, value in defaults.items():
+				raw_def.setdefault(key, value)
+
+			raw_traits = raw_def.get('traits', None)
+			if raw_traits is None:
+				continue
+
+			if raw_def['type'] == 'class':
+				raw_traits.setdefault('members', [])
+				flag_names = compact.get('class_flags', [])
+			elif raw_def['type'] == 'enum':
+				raw_traits.setdefault('fields', [])
+				flag_names = compact.get('enum_flags', [])
+			else:
+				continue
+
+			if isinstance(raw_traits.get('flags'), int):
+				raw_traits['flags'] = SchemaFile.expand_flags(raw_traits['flags'], flag_names)
+
+		SchemaFile.expand_compact_metatags(schema)
+		SchemaFile.expand_compact_atomic_names(schema.get('defs', []), schema.get('atomics', []))
+
 	def get_flags(self):
 		"""
 		Returns:
@@ -64,6 +231,22 @@ class SchemaFile:
 
 		return 'has_pulse_bindings' in self.get_flags()
 
+	def has_interned_strings(self):
+		"""
+		Returns:
+			bool: True if the schema file stores strings as indices into its strings table, False otherwise.
+		"""
+
+		return 'strings_interned' in self.get_flags()
+
+	def is_compact(self):
+		"""
+		Returns:
+			bool: True if the schema file was dumped with the compact profile, False otherwise.
+		"""
+
+		return 'compact' in self.get_flags()
+
 class FileWriter:
 	fd = None
 	indent_level = 0
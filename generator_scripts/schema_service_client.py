@@ -0,0 +1,67 @@
+import argparse
+import json
+import socket
+import struct
+import sys
+
+DEFAULT_SOCKET_PATH = '/tmp/schemadump.sock'
+
+class SchemaServiceClient:
+	def __init__(self, path = DEFAULT_SOCKET_PATH):
+		self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+		self.sock.connect(path)
+
+	def __enter__(self):
+		return self
+
+	def __exit__(self, *args):
+		self.sock.close()
+
+	def recv_exact(self, size):
+		data = b''
+		while len(data) < size:
+			chunk = self.sock.recv(size - len(data))
+			if not chunk:
+				raise ConnectionError('Schema service closed the connection')
+			data += chunk
+		return data
+
+	def request(self, *args):
+		payload = ' '.join(args).encode('utf8')
+		self.sock.sendall(struct.pack('<I', len(payload)) + payload)
+
+		(length,) = struct.unpack('<I', self.recv_exact(4))
+		return json.loads(self.recv_exact(length).decode('utf8'))
+
+	def find_class(self, name):
+		return self.request('class', name)
+
+	def find_field(self, class_name, field_name):
+		return self.request('field', class_name, field_name)
+
+	def find_def(self, name):
+		return self.request('def', name)
+
+	def changed(self, layout_hash, class_name = None):
+		if class_name is None:
+			return self.request('changed', layout_hash)
+		return self.request('changed', class_name, layout_hash)
+
+def main():
+	parser = argparse.ArgumentParser(description = 'Queries live schema from the schema service hosted by the plugin (see schema_service command).')
+	parser.add_argument('-p', '--path', help = f'The path to the service unix socket. Default is {DEFAULT_SOCKET_PATH}.', type = str, dest = 'path', default = DEFAULT_SOCKET_PATH)
+	parser.add_argument('request', help = 'Request to send, e.g. "class CBaseEntity", "field CBaseEntity m_iHealth", "def CBaseEntity" or "changed <hash>".', nargs = '+', type = str)
+
+	args = parser.parse_args()
+
+	with SchemaServiceClient(args.path) as client:
+		result = client.request(*args.request)
+
+	json.dump(result, sys.stdout, indent = '\t')
+	print()
+
+	if 'error' in result:
+		sys.exit(1)
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// FNV-1a 64 bit hashing used for layout hashes of schema dumps.
+// Header only and free of any sdk dependencies, so plugins can include it as is
+// to compute or compare layout hashes at compile time or startup.
+
+constexpr uint64_t SCHEMADUMP_HASH_OFFSET = 0xcbf29ce484222325ull;
+constexpr uint64_t SCHEMADUMP_HASH_PRIME = 0x100000001b3ull;
+
+constexpr uint64_t SchemaDumpHashBytes( const char *data, size_t size, uint64_t hash = SCHEMADUMP_HASH_OFFSET )
+{
+	for(size_t i = 0; i < size; i++)
+	{
+		hash ^= (uint8_t)data[i];
+		hash *= SCHEMADUMP_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+// Hashes string including its null terminator, so consecutive strings can't run into each other
+constexpr uint64_t SchemaDumpHashString( const char *str, uint64_t hash = SCHEMADUMP_HASH_OFFSET )
+{
+	do
+	{
+		hash ^= (uint8_t)*str;
+		hash *= SCHEMADUMP_HASH_PRIME;
+	} while(*str++);
+
+	return hash;
+}
+
+// Hashes integer as 8 little endian bytes, independent of the host byte order
+constexpr uint64_t SchemaDumpHashInt( int64_t value, uint64_t hash = SCHEMADUMP_HASH_OFFSET )
+{
+	for(int i = 0; i < 8; i++)
+	{
+		hash ^= (uint8_t)((uint64_t)value >> (i * 8));
+		hash *= SCHEMADUMP_HASH_PRIME;
+	}
+
+	return hash;
+}
@@ -0,0 +1,448 @@
+#pragma once
+
+#include "schemadump_hash.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+// Header only runtime offset resolver built on top of a schema dump produced by this plugin.
+//
+// Dump is expected to be loaded into a KeyValues3 (or any node type with the same FindMember,
+// GetArrayElementCount, GetArrayElement, GetString and GetInt methods) by the user,
+// resolver then flattens every class with its inherited fields into a sorted
+// (class hash, field hash) table, so lookups are a binary search over a contiguous array.
+//
+// Same named classes of different projects (e.g. server and client) can't be told apart by name hash,
+// so Build takes an optional project to only flatten classes of that project. Names that still resolve
+// to more than one class are reported by AmbiguousClasses and are left out of lookups.
+//
+// Example:
+//	SchemaDumpResolver resolver;
+//	resolver.Build( kv3_root, "server" );
+//	int offset = resolver.FindOffset( SCHEMADUMP_HASH( "CBaseEntity" ), SCHEMADUMP_HASH( "m_iHealth" ) );
+//
+// Dumps made with the hierarchy flag also allow constant time is-a checks:
+//	bool is_entity = resolver.IsA( SCHEMADUMP_HASH( "CBaseModelEntity" ), SCHEMADUMP_HASH( "CBaseEntity" ) );
+
+// Forces hash to be computed at compile time at the call site
+#define SCHEMADUMP_HASH( str ) std::integral_constant<uint64_t, SchemaDumpHashString( str )>::value
+
+enum SchemaDumpFieldKind : uint8_t
+{
+	SDFK_UNKNOWN = 0,
+	SDFK_REF,
+	SDFK_PTR,
+	SDFK_ATOMIC,
+	SDFK_BITFIELD,
+	SDFK_FIXED_ARRAY
+};
+
+struct SchemaDumpFieldEntry
+{
+	uint64_t m_ClassHash;
+	uint64_t m_FieldHash;
+
+	// Absolute offset within the class, inherited fields included
+	int32_t m_nOffset;
+
+	// Size in bytes, storage unit size for bitfields (0 if the dump has no bitfield placements)
+	int32_t m_nSize;
+
+	// Def index of the referenced type for SDFK_REF kinds (or of the innermost type for arrays), -1 otherwise
+	int32_t m_nTypeIdx;
+
+	SchemaDumpFieldKind m_Kind;
+
+	// Bitfield value is (unit >> m_nBitShift) & ((1 << m_nBitCount) - 1), with the unit read at m_nOffset
+	uint8_t m_nBitShift;
+	uint8_t m_nBitCount;
+
+	// Bitfield placement is a dumper guess (placement: "heuristic"), as schema doesn't record it
+	bool m_bInferredPlacement;
+};
+
+struct SchemaDumpHierarchyEntry
+{
+	// Pre order index of the class in the single inheritance tree and the last one within its subtree, -1 for non classes
+	int32_t m_nPre = -1;
+	int32_t m_nPost = -1;
+
+	// Bit of the class in secondary base bitsets, -1 if no class reaches it through a secondary base
+	int32_t m_nBit = -1;
+
+	// Bitset of ancestors reached through secondary bases, as a range of SchemaDumpResolver bitset words
+	uint32_t m_nBitsOffset = 0;
+	uint32_t m_nBitsCount = 0;
+};
+
+class SchemaDumpResolver
+{
+public:
+	// Only classes of the given project are flattened if it's provided, defs merged with the
+	// dedupe_projects flag match any of their projects
+	template <typename KV3>
+	bool Build( KV3 *root, const char *project = nullptr );
+
+	const SchemaDumpFieldEntry *Find( uint64_t class_hash, uint64_t field_hash ) const
+	{
+		auto iter = std::lower_bound( m_Entries.begin(), m_Entries.end(), std::make_pair( class_hash, field_hash ), []( const SchemaDumpFieldEntry &entry, const std::pair<uint64_t, uint64_t> &key ) {
+			return entry.m_ClassHash != key.first ? entry.m_ClassHash < key.first : entry.m_FieldHash < key.second;
+		} );
+
+		if(iter == m_Entries.end() || iter->m_ClassHash != class_hash || iter->m_FieldHash != field_hash)
+			return nullptr;
+
+		return &*iter;
+	}
+
+	const SchemaDumpFieldEntry *Find( const char *class_name, const char *field_name ) const
+	{
+		return Find( SchemaDumpHashString( class_name ), SchemaDumpHashString( field_name ) );
+	}
+
+	// Returns -1 if field wasn't found
+	int32_t FindOffset( uint64_t class_hash, uint64_t field_hash ) const
+	{
+		auto entry = Find( class_hash, field_hash );
+		return entry ? entry->m_nOffset : -1;
+	}
+
+	size_t Count() const { return m_Entries.size(); }
+	const std::vector<SchemaDumpFieldEntry> &Entries() const { return m_Entries; }
+
+	// Returns def index of the class with the given name hash, -1 if it wasn't found or is ambiguous
+	int32_t FindClassIdx( uint64_t class_hash ) const
+	{
+		auto iter = std::lower_bound( m_ClassIndices.begin(), m_ClassIndices.end(), std::make_pair( class_hash, INT32_MIN ) );
+
+		if(iter == m_ClassIndices.end() || iter->first != class_hash)
+			return -1;
+
+		return iter->second;
+	}
+
+	// Sorted name hashes of classes that matched more than one def, these have no entries
+	const std::vector<uint64_t> &AmbiguousClasses() const { return m_AmbiguousClasses; }
+
+	bool IsAmbiguous( uint64_t class_hash ) const
+	{
+		return std::binary_search( m_AmbiguousClasses.begin(), m_AmbiguousClasses.end(), class_hash );
+	}
+
+	// Whether class at def index idx is the base_idx class or derives from it,
+	// always false if the dump was made without the hierarchy flag
+	bool IsA( int32_t idx, int32_t base_idx ) const
+	{
+		if(idx < 0 || base_idx < 0 || idx >= (int32_t)m_Hierarchy.size() || base_idx >= (int32_t)m_Hierarchy.size())
+			return false;
+
+		auto &entry = m_Hierarchy[idx], &base = m_Hierarchy[base_idx];
+		if(entry.m_nPre < 0 || base.m_nPre < 0)
+			return false;
+
+		if(base.m_nPre <= entry.m_nPre && entry.m_nPre <= base.m_nPost)
+			return true;
+
+		if(base.m_nBit < 0 || (uint32_t)base.m_nBit / 32 >= entry.m_nBitsCount)
+			return false;
+
+		return (m_HierarchyBits[entry.m_nBitsOffset + base.m_nBit / 32] >> (base.m_nBit % 32)) & 1;
+	}
+
+	bool IsA( uint64_t class_hash, uint64_t base_hash ) const
+	{
+		return IsA( FindClassIdx( class_hash ), FindClassIdx( base_hash ) );
+	}
+
+	bool IsA( const char *class_name, const char *base_name ) const
+	{
+		return IsA( SchemaDumpHashString( class_name ), SchemaDumpHashString( base_name ) );
+	}
+
+private:
+	template <typename KV3>
+	static void ReadFieldType( KV3 *defs, KV3 *subtype, int32_t base_offset, SchemaDumpFieldEntry &entry );
+
+	template <typename KV3>
+	void ReadHierarchy( KV3 *def, SchemaDumpHierarchyEntry &entry );
+
+	// Project members are indices into the root strings table in dumps made with intern_strings
+	template <typename KV3>
+	static bool IsInProject( KV3 *def, KV3 *strings, const char *project );
+
+	std::vector<SchemaDumpFieldEntry> m_Entries;
+
+	// Sorted (class hash, def index) pairs
+	std::vector<std::pair<uint64_t, int32_t>> m_ClassIndices;
+	std::vector<uint64_t> m_AmbiguousClasses;
+
+	// Indexed by def index
+	std::vector<SchemaDumpHierarchyEntry> m_Hierarchy;
+	std::vector<uint32_t> m_HierarchyBits;
+};
+
+template <typename KV3>
+inline void SchemaDumpResolver::ReadHierarchy( KV3 *def, SchemaDumpHierarchyEntry &entry )
+{
+	auto isa = def->FindMember( "isa" );
+	if(!isa)
+		return;
+
+	auto pre = isa->FindMember( "pre" );
+	auto post = isa->FindMember( "post" );
+	auto bit = isa->FindMember( "bit" );
+	auto bits = isa->FindMember( "bits" );
+
+	entry.m_nPre = pre ? pre->GetInt( -1 ) : -1;
+	entry.m_nPost = post ? post->GetInt( -1 ) : -1;
+	entry.m_nBit = bit ? bit->GetInt( -1 ) : -1;
+
+	if(!bits)
+		return;
+
+	entry.m_nBitsOffset = (uint32_t)m_HierarchyBits.size();
+	entry.m_nBitsCount = (uint32_t)bits->GetArrayElementCount();
+
+	for(uint32_t i = 0; i < entry.m_nBitsCount; i++)
+		m_HierarchyBits.push_back( (uint32_t)bits->GetArrayElement( i )->GetInt( 0 ) );
+}
+
+template <typename KV3>
+inline bool SchemaDumpResolver::IsInProject( KV3 *def, KV3 *strings, const char *project )
+{
+	auto matches = [strings, project]( KV3 *value ) {
+		if(!strings)
+			return std::strcmp( value->GetString( "" ), project ) == 0;
+
+		int idx = value->GetInt( -1 );
+		return idx >= 0 && idx < strings->GetArrayElementCount() && std::strcmp( strings->GetArrayElement( idx )->GetString( "" ), project ) == 0;
+	};
+
+	if(auto projects = def->FindMember( "projects" ))
+	{
+		for(int i = 0; i < projects->GetArrayElementCount(); i++)
+		{
+			if(matches( projects->GetArrayElement( i ) ))
+				return true;
+		}
+
+		return false;
+	}
+
+	auto def_project = def->FindMember( "project" );
+	return def_project && matches( def_project );
+}
+
+template <typename KV3>
+inline void SchemaDumpResolver::ReadFieldType( KV3 *defs, KV3 *subtype, int32_t base_offset, SchemaDumpFieldEntry &entry )
+{
+	int32_t multiplier = 1;
+
+	entry.m_nTypeIdx = -1;
+	entry.m_Kind = SDFK_UNKNOWN;
+	entry.m_nBitShift = 0;
+	entry.m_nBitCount = 0;
+	entry.m_bInferredPlacement = false;
+
+	// Fixed arrays nest their element types, walk down to the innermost one
+	for(bool outermost = true; subtype; outermost = false)
+	{
+		auto type_kv = subtype->FindMember( "type" );
+		const char *type = type_kv ? type_kv->GetString( "" ) : "";
+
+		SchemaDumpFieldKind kind = SDFK_UNKNOWN;
+		if(std::strcmp( type, "ref" ) == 0)
+			kind = SDFK_REF;
+		else if(std::strcmp( type, "ptr" ) == 0)
+			kind = SDFK_PTR;
+		else if(std::strcmp( type, "atomic" ) == 0)
+			kind = SDFK_ATOMIC;
+		else if(std::strcmp( type, "bitfield" ) == 0)
+			kind = SDFK_BITFIELD;
+		else if(std::strcmp( type, "fixed_array" ) == 0)
+			kind = SDFK_FIXED_ARRAY;
+
+		if(outermost)
+			entry.m_Kind = kind;
+
+		if(kind == SDFK_FIXED_ARRAY)
+		{
+			auto count = subtype->FindMember( "count" );
+			multiplier *= count ? count->GetInt( 0 ) : 0;
+			subtype = subtype->FindMember( "subtype" );
+			continue;
+		}
+
+		if(kind == SDFK_REF)
+		{
+			auto ref_idx = subtype->FindMember( "ref_idx" );
+			entry.m_nTypeIdx = ref_idx ? ref_idx->GetInt( -1 ) : -1;
+
+			auto def = entry.m_nTypeIdx >= 0 && entry.m_nTypeIdx < defs->GetArrayElementCount() ? defs->GetArrayElement( entry.m_nTypeIdx ) : nullptr;
+			auto size = def ? def->FindMember( "size" ) : nullptr;
+			entry.m_nSize = multiplier * (size ? size->GetInt( 0 ) : 0);
+		}
+		else if(kind == SDFK_PTR)
+		{
+			entry.m_nSize = multiplier * (int32_t)sizeof( void * );
+		}
+		else if(kind == SDFK_ATOMIC)
+		{
+			auto size = subtype->FindMember( "size" );
+			entry.m_nSize = multiplier * (size ? size->GetInt( 0 ) : 0);
+		}
+		else if(kind == SDFK_BITFIELD)
+		{
+			auto storage_offset = subtype->FindMember( "storage_offset" );
+			auto unit_size = subtype->FindMember( "unit_size" );
+			auto shift = subtype->FindMember( "shift" );
+			auto count = subtype->FindMember( "count" );
+			auto placement = subtype->FindMember( "placement" );
+
+			// Bitfields have no offset in schema, placement resolved by the dumper is used instead
+			if(storage_offset)
+				entry.m_nOffset = base_offset + storage_offset->GetInt( 0 );
+
+			entry.m_bInferredPlacement = placement && std::strcmp( placement->GetString( "" ), "heuristic" ) == 0;
+
+			entry.m_nSize = unit_size ? unit_size->GetInt( 0 ) : 0;
+			entry.m_nBitShift = (uint8_t)(shift ? shift->GetInt( 0 ) : 0);
+			entry.m_nBitCount = (uint8_t)(count ? count->GetInt( 0 ) : 0);
+		}
+		else
+		{
+			entry.m_nSize = 0;
+		}
+
+		break;
+	}
+}
+
+template <typename KV3>
+inline bool SchemaDumpResolver::Build( KV3 *root, const char *project )
+{
+	m_Entries.clear();
+	m_ClassIndices.clear();
+	m_AmbiguousClasses.clear();
+	m_Hierarchy.clear();
+	m_HierarchyBits.clear();
+
+	auto defs = root ? root->FindMember( "defs" ) : nullptr;
+	if(!defs)
+		return false;
+
+	auto strings = root->FindMember( "strings" );
+
+	int def_count = defs->GetArrayElementCount();
+	m_Hierarchy.resize( def_count );
+
+	// Pairs of def index and its offset within the class being flattened
+	std::vector<std::pair<int, int32_t>> stack;
+
+	for(int i = 0; i < def_count; i++)
+	{
+		auto def = defs->GetArrayElement( i );
+		auto def_type = def->FindMember( "type" );
+		auto def_name = def->FindMember( "name" );
+
+		// Compact dumps omit type of class defs
+		if(!def_name || (def_type && std::strcmp( def_type->GetString( "" ), "class" ) != 0))
+			continue;
+
+		if(project && !IsInProject( def, strings, project ))
+			continue;
+
+		uint64_t class_hash = SchemaDumpHashString( def_name->GetString( "" ) );
+
+		m_ClassIndices.push_back( { class_hash, i } );
+		ReadHierarchy( def, m_Hierarchy[i] );
+
+		stack.clear();
+		stack.push_back( { i, 0 } );
+
+		while(!stack.empty())
+		{
+			auto [idx, base_offset] = stack.back();
+			stack.pop_back();
+
+			if(idx < 0 || idx >= def_count)
+				continue;
+
+			auto traits = defs->GetArrayElement( idx )->FindMember( "traits" );
+			if(!traits)
+				continue;
+
+			if(auto members = traits->FindMember( "members" ))
+			{
+				for(int k = 0; k < members->GetArrayElementCount(); k++)
+				{
+					auto member = members->GetArrayElement( k );
+					auto name = member->FindMember( "name" );
+					auto offset = member->FindMember( "offset" );
+					auto member_traits = member->FindMember( "traits" );
+
+					if(!name || !offset)
+						continue;
+
+					SchemaDumpFieldEntry entry;
+					entry.m_ClassHash = class_hash;
+					entry.m_FieldHash = SchemaDumpHashString( name->GetString( "" ) );
+					entry.m_nOffset = base_offset + offset->GetInt( 0 );
+					entry.m_nSize = 0;
+
+					ReadFieldType( defs, member_traits ? member_traits->FindMember( "subtype" ) : nullptr, base_offset, entry );
+					m_Entries.push_back( entry );
+				}
+			}
+
+			if(auto baseclasses = traits->FindMember( "baseclasses" ))
+			{
+				// Pushed in reverse, so the first base class is flattened first
+				for(int k = baseclasses->GetArrayElementCount() - 1; k >= 0; k--)
+				{
+					auto baseclass = baseclasses->GetArrayElement( k );
+					auto ref_idx = baseclass->FindMember( "ref_idx" );
+					auto offset = baseclass->FindMember( "offset" );
+
+					if(ref_idx)
+						stack.push_back( { ref_idx->GetInt( -1 ), base_offset + (offset ? offset->GetInt( 0 ) : 0) } );
+				}
+			}
+		}
+	}
+
+	std::sort( m_ClassIndices.begin(), m_ClassIndices.end() );
+
+	// Names shared by several defs are dropped, rather than resolving to whichever def came first
+	for(size_t i = 1; i < m_ClassIndices.size(); i++)
+	{
+		if(m_ClassIndices[i].first == m_ClassIndices[i - 1].first && (m_AmbiguousClasses.empty() || m_AmbiguousClasses.back() != m_ClassIndices[i].first))
+			m_AmbiguousClasses.push_back( m_ClassIndices[i].first );
+	}
+
+	if(!m_AmbiguousClasses.empty())
+	{
+		m_ClassIndices.erase( std::remove_if( m_ClassIndices.begin(), m_ClassIndices.end(), [this]( const std::pair<uint64_t, int32_t> &entry ) {
+			return IsAmbiguous( entry.first );
+		} ), m_ClassIndices.end() );
+
+		m_Entries.erase( std::remove_if( m_Entries.begin(), m_Entries.end(), [this]( const SchemaDumpFieldEntry &entry ) {
+			return IsAmbiguous( entry.m_ClassHash );
+		} ), m_Entries.end() );
+	}
+
+	// Derived class fields are added before its bases, so stable sort keeps them first for shadowed names
+	std::stable_sort( m_Entries.begin(), m_Entries.end(), []( const SchemaDumpFieldEntry &a, const SchemaDumpFieldEntry &b ) {
+		return a.m_ClassHash != b.m_ClassHash ? a.m_ClassHash < b.m_ClassHash : a.m_FieldHash < b.m_FieldHash;
+	} );
+
+	m_Entries.erase( std::unique( m_Entries.begin(), m_Entries.end(), []( const SchemaDumpFieldEntry &a, const SchemaDumpFieldEntry &b ) {
+		return a.m_ClassHash == b.m_ClassHash && a.m_FieldHash == b.m_FieldHash;
+	} ), m_Entries.end() );
+
+	return true;
+}
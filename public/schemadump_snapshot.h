@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+// Binary schema snapshot layout published by the plugin into a POSIX shared memory object
+// (SCHEMADUMP_SNAPSHOT_DEFAULT_NAME unless changed), meant to be mapped read only by local processes.
+//
+// All offsets are in bytes from the start of the mapping and all strings are null terminated
+// and stored in the strings block. Classes are sorted by their name hash (SchemaDumpHashString),
+// classes with the same name from different scopes are adjacent.
+//
+// Snapshot could be refreshed in place, so readers should use it as a seqlock:
+// read m_Generation, bail (or retry) if it's odd, read the data, then verify m_Generation is unchanged.
+// If m_TotalSize grows past the mapped size, the object should be remapped.
+
+#define SCHEMADUMP_SNAPSHOT_MAGIC 0x53534453 // 'SDSS'
+#define SCHEMADUMP_SNAPSHOT_VERSION 1
+#define SCHEMADUMP_SNAPSHOT_DEFAULT_NAME "/schemadump_snapshot"
+
+struct SchemaSnapshotHeader
+{
+	uint32_t m_Magic;
+	uint32_t m_Version;
+
+	// Odd while the snapshot is being written, incremented twice per refresh
+	std::atomic<uint64_t> m_Generation;
+
+	uint64_t m_TotalSize;
+
+	uint64_t m_ClassesOffset;
+	uint32_t m_ClassCount;
+
+	uint32_t m_FieldCount;
+	uint64_t m_FieldsOffset;
+
+	uint64_t m_BasesOffset;
+	uint32_t m_BaseCount;
+
+	uint32_t m_StringsSize;
+	uint64_t m_StringsOffset;
+};
+
+struct SchemaSnapshotClass
+{
+	uint64_t m_NameHash;
+
+	// Layout hash, as dumped in the layout_hash field of defs
+	uint64_t m_LayoutHash;
+
+	uint32_t m_NameOffset;
+	uint32_t m_ScopeOffset;
+	uint32_t m_ProjectOffset;
+
+	int32_t m_nSize;
+	uint32_t m_nAlignment;
+
+	// Fields and bases of a class are stored contiguously
+	uint32_t m_FirstField;
+	uint32_t m_FieldCount;
+	uint32_t m_FirstBase;
+	uint32_t m_BaseCount;
+};
+
+struct SchemaSnapshotField
+{
+	uint64_t m_NameHash;
+	uint32_t m_NameOffset;
+	uint32_t m_TypeNameOffset;
+
+	// Offset within the declaring class, add base offsets for inherited fields
+	int32_t m_nOffset;
+	int32_t m_nSize;
+};
+
+struct SchemaSnapshotBase
+{
+	// Index into the classes table, UINT32_MAX if the base class wasn't found
+	uint32_t m_ClassIdx;
+	int32_t m_nOffset;
+};
+
+static_assert( std::atomic<uint64_t>::is_always_lock_free, "Snapshot generation counter has to be lock free to be shared between processes" );
+
+inline const SchemaSnapshotClass *SchemaSnapshotClasses( const void *base )
+{
+	auto header = reinterpret_cast<const SchemaSnapshotHeader *>(base);
+	return reinterpret_cast<const SchemaSnapshotClass *>(reinterpret_cast<const uint8_t *>(base) + header->m_ClassesOffset);
+}
+
+inline const SchemaSnapshotField *SchemaSnapshotFields( const void *base )
+{
+	auto header = reinterpret_cast<const SchemaSnapshotHeader *>(base);
+	return reinterpret_cast<const SchemaSnapshotField *>(reinterpret_cast<const uint8_t *>(base) + header->m_FieldsOffset);
+}
+
+inline const SchemaSnapshotBase *SchemaSnapshotBases( const void *base )
+{
+	auto header = reinterpret_cast<const SchemaSnapshotHeader *>(base);
+	return reinterpret_cast<const SchemaSnapshotBase *>(reinterpret_cast<const uint8_t *>(base) + header->m_BasesOffset);
+}
+
+inline const char *SchemaSnapshotString( const void *base, uint32_t offset )
+{
+	auto header = reinterpret_cast<const SchemaSnapshotHeader *>(base);
+	return reinterpret_cast<const char *>(base) + header->m_StringsOffset + offset;
+}
+
+// Returns the first class with the matching name hash, or nullptr
+inline const SchemaSnapshotClass *SchemaSnapshotFindClass( const void *base, uint64_t name_hash )
+{
+	auto header = reinterpret_cast<const SchemaSnapshotHeader *>(base);
+	auto classes = SchemaSnapshotClasses( base );
+
+	uint32_t low = 0, high = header->m_ClassCount;
+	while(low < high)
+	{
+		uint32_t mid = low + (high - low) / 2;
+
+		if(classes[mid].m_NameHash < name_hash)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low < header->m_ClassCount && classes[low].m_NameHash == name_hash ? &classes[low] : nullptr;
+}
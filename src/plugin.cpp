@@ -1,7 +1,22 @@
 #include "plugin.h"
 #include "schemareader.h"
+#include "schemaindex.h"
+#include "schemaservice.h"
+
+#include "eiface.h"
+
+#include <chrono>
+
+SH_DECL_HOOK3_void( IServerGameDLL, GameFrame, SH_NOATTRIB, 0, bool, bool, bool );
 
 MMSPlugin g_ThisPlugin;
+IServerGameDLL *g_pServerGameDLL = nullptr;
+
+static void Hook_GameFrame( bool simulating, bool first_tick, bool last_tick )
+{
+	// Schema service snapshot could only be rebuilt from the game thread
+	UpdateSchemaService();
+}
 
 PLUGIN_EXPOSE( MMSPlugin, g_ThisPlugin );
 bool MMSPlugin::Load( PluginId id, ISmmAPI *ismm, char *error, size_t maxlen, bool late )
@@ -10,6 +25,9 @@ bool MMSPlugin::Load( PluginId id, ISmmAPI *ismm, char *error, size_t maxlen, bo
 
 	GET_V_IFACE_ANY( GetEngineFactory, g_pCVar, ICvar, CVAR_INTERFACE_VERSION );
 	GET_V_IFACE_ANY( GetEngineFactory, g_pSchemaSystem, ISchemaSystem, SCHEMASYSTEM_INTERFACE_VERSION );
+	GET_V_IFACE_ANY( GetServerFactory, g_pServerGameDLL, IServerGameDLL, INTERFACEVERSION_SERVERGAMEDLL );
+
+	SH_ADD_HOOK( IServerGameDLL, GameFrame, g_pServerGameDLL, SH_STATIC( Hook_GameFrame ), true );
 
 	// Required to get the IMetamodListener events
 	g_SMAPI->AddListener( this, this );
@@ -19,13 +37,23 @@ bool MMSPlugin::Load( PluginId id, ISmmAPI *ismm, char *error, size_t maxlen, bo
 	return true;
 }
 
+bool MMSPlugin::Unload( char *error, size_t maxlen )
+{
+	SH_REMOVE_HOOK( IServerGameDLL, GameFrame, g_pServerGameDLL, SH_STATIC( Hook_GameFrame ), true );
+
+	// Service thread runs plugin code, so it has to be gone before the plugin is
+	StopSchemaService();
+
+	return true;
+}
+
 CON_COMMAND( dump_schema, "Dumps schema to kv3/json file" )
 {
 	if(args.ArgC() > 1)
 	{
 		if(std::strcmp( args.Arg( 1 ), "help" ) == 0)
 		{
-			META_CONPRINTF( "Usage: dump_schema [flags]\n" );
+			META_CONPRINTF( "Usage: dump_schema [flags] [| flags ...]\n" );
 			META_CONPRINTF( "Flags:\n" );
 
 			for(int i = 0; i < ARRAYSIZE( SchemaReader::s_FlagsMap ); i++)
@@ -43,7 +71,148 @@ CON_COMMAND( dump_schema, "Dumps schema to kv3/json file" )
 	}
 
 	SchemaReader sr;
-	sr.ReadSchema( SchemaReader::ParseDumpFlags( args.ArgS() ) );
+	if(!sr.ReadSchema( SchemaReader::ParseDumpProfiles( args.ArgS() ) ))
+		return;
 	
 	sr.WriteToOutDir();
 }
+
+static void PrintClassLayout( SchemaClassInfoData_t *ci )
+{
+	META_CONPRINTF( "%s (scope: %s, project: %s, size: %d, alignment: %d)\n", ci->m_pszName, ci->m_pDeclaredClass->m_pTypeScope->GetScopeName(), ci->m_pszProjectName, ci->m_nSize, ci->m_nAlignment );
+
+	for(int i = 0; i < ci->m_nBaseClassCount; i++)
+		META_CONPRINTF( "\tbase %s at 0x%x\n", ci->m_pBaseClasses[i].m_pClass->m_pszName, ci->m_pBaseClasses[i].m_nOffset );
+
+	for(int i = 0; i < ci->m_nFieldCount; i++)
+	{
+		auto &field = ci->m_pFields[i];
+		META_CONPRINTF( "\t0x%x %s %s\n", field.m_nSingleInheritanceOffset, field.m_pType->m_sTypeName.Get(), field.m_pszName );
+	}
+}
+
+static void PrintSchemaQueryUsage()
+{
+	META_CONPRINTF( "Usage:\n" );
+	META_CONPRINTF( "\tschema_query class <name>: Prints class layout\n" );
+	META_CONPRINTF( "\tschema_query field <class> <field>: Prints absolute offset of a field, including inherited ones\n" );
+	META_CONPRINTF( "\tschema_query enum <name>: Prints enum values\n" );
+	META_CONPRINTF( "\tschema_query metatag <name>: Prints classes that have metatag on them or on their fields\n" );
+	META_CONPRINTF( "\tschema_query rebuild: Forces index rebuild\n" );
+}
+
+CON_COMMAND( schema_query, "Queries schema classes, fields, enums and metatags" )
+{
+	if(args.ArgC() < 2)
+	{
+		PrintSchemaQueryUsage();
+		return;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	auto index = SchemaIndex::Get( std::strcmp( args.Arg( 1 ), "rebuild" ) == 0 );
+
+	if(!index)
+		return;
+
+	if(std::strcmp( args.Arg( 1 ), "rebuild" ) == 0)
+	{
+		META_CONPRINTF( "Indexed %d classes and %d enums.\n", index->GetClassCount(), index->GetEnumCount() );
+	}
+	else if(std::strcmp( args.Arg( 1 ), "class" ) == 0 && args.ArgC() >= 3)
+	{
+		auto classes = index->FindClasses( args.Arg( 2 ) );
+
+		if(!classes)
+			META_CONPRINTF( "Class \"%s\" not found.\n", args.Arg( 2 ) );
+		else
+		{
+			for(auto ci : *classes)
+				PrintClassLayout( ci );
+		}
+	}
+	else if(std::strcmp( args.Arg( 1 ), "field" ) == 0 && args.ArgC() >= 4)
+	{
+		auto classes = index->FindClasses( args.Arg( 2 ) );
+
+		if(!classes)
+			META_CONPRINTF( "Class \"%s\" not found.\n", args.Arg( 2 ) );
+		else
+		{
+			for(auto ci : *classes)
+			{
+				SchemaIndex::FieldLocation location;
+
+				if(SchemaIndex::FindField( ci, args.Arg( 3 ), location ))
+				{
+					META_CONPRINTF( "%s::%s (scope: %s) at 0x%x (%d), type %s, declared in %s\n", ci->m_pszName, location.m_pField->m_pszName,
+									ci->m_pDeclaredClass->m_pTypeScope->GetScopeName(), location.m_nAbsoluteOffset, location.m_nAbsoluteOffset,
+									location.m_pField->m_pType->m_sTypeName.Get(), location.m_pClass->m_pszName );
+				}
+				else
+				{
+					META_CONPRINTF( "Field \"%s\" not found in %s (scope: %s).\n", args.Arg( 3 ), ci->m_pszName, ci->m_pDeclaredClass->m_pTypeScope->GetScopeName() );
+				}
+			}
+		}
+	}
+	else if(std::strcmp( args.Arg( 1 ), "enum" ) == 0 && args.ArgC() >= 3)
+	{
+		auto enums = index->FindEnums( args.Arg( 2 ) );
+
+		if(!enums)
+			META_CONPRINTF( "Enum \"%s\" not found.\n", args.Arg( 2 ) );
+		else
+		{
+			for(auto ei : *enums)
+			{
+				META_CONPRINTF( "%s (scope: %s, size: %d)\n", ei->m_pszName, ei->m_pTypeScope->GetScopeName(), ei->m_nSize );
+
+				for(int i = 0; i < ei->m_nEnumeratorCount; i++)
+					META_CONPRINTF( "\t%s = %lld\n", ei->m_pEnumerators[i].m_pszName, (long long)ei->m_pEnumerators[i].m_nValue );
+			}
+		}
+	}
+	else if(std::strcmp( args.Arg( 1 ), "metatag" ) == 0 && args.ArgC() >= 3)
+	{
+		auto classes = index->FindClassesWithMetaTag( args.Arg( 2 ) );
+
+		if(!classes)
+			META_CONPRINTF( "No classes with \"%s\" metatag found.\n", args.Arg( 2 ) );
+		else
+		{
+			for(auto ci : *classes)
+				META_CONPRINTF( "\t%s (scope: %s)\n", ci->m_pszName, ci->m_pDeclaredClass->m_pTypeScope->GetScopeName() );
+
+			META_CONPRINTF( "%d classes found.\n", (int)classes->size() );
+		}
+	}
+	else
+	{
+		PrintSchemaQueryUsage();
+		return;
+	}
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::high_resolution_clock::now() - start );
+	META_CONPRINTF( "Query took %lld us.\n", (long long)elapsed.count() );
+}
+
+CON_COMMAND( schema_service, "Controls local unix socket schema query service" )
+{
+	if(args.ArgC() >= 2 && std::strcmp( args.Arg( 1 ), "start" ) == 0)
+	{
+		StartSchemaService( args.ArgC() >= 3 ? args.Arg( 2 ) : SCHEMADUMP_SERVICE_DEFAULT_PATH );
+	}
+	else if(args.ArgC() >= 2 && std::strcmp( args.Arg( 1 ), "stop" ) == 0)
+	{
+		StopSchemaService();
+	}
+	else if(args.ArgC() >= 2 && std::strcmp( args.Arg( 1 ), "status" ) == 0)
+	{
+		META_CONPRINTF( "Schema service is %s.\n", IsSchemaServiceRunning() ? "running" : "stopped" );
+	}
+	else
+	{
+		META_CONPRINTF( "Usage: schema_service <start [socket path]|stop|status>\n" );
+	}
+}
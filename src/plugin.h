@@ -9,7 +9,7 @@ class MMSPlugin : public ISmmPlugin, public IMetamodListener
 {
 public:
 	bool Load( PluginId id, ISmmAPI *ismm, char *error, size_t maxlen, bool late );
-	bool Unload( char *error, size_t maxlen ) { return true; }
+	bool Unload( char *error, size_t maxlen );
 
 public:
 	const char *GetAuthor() { return PLUGIN_AUTHOR; }
@@ -55,16 +55,26 @@ struct PulseParamType
 	bool IsValid() const { return m_Type != PVAL_INVALID; }
 
 	std::string ToString() const
+	{
+		if(m_Type == PVAL_ARRAY && m_SubType && m_SubType->IsValid())
+			return Format( m_Type, m_LibraryClass, m_SubType->ToString().c_str() );
+
+		return Format( m_Type, m_LibraryClass, nullptr );
+	}
+
+	// Formats a type from its parts, nested array types pass their already formatted subtype name,
+	// so cached subtype names could be reused instead of recursing into them
+	static std::string Format( PulseValueType_t type, const char *library_class, const char *subtype_name )
 	{
 		std::ostringstream ss;
 
-		switch(m_Type)
+		switch(type)
 		{
 			case PVAL_ARRAY:
 			{
-				if(m_SubType && m_SubType->IsValid())
+				if(subtype_name)
 				{
-					ss << m_SubType->ToString();
+					ss << subtype_name;
 				}
 				else if(SchemaReader::IsVerboseLogging())
 				{
@@ -91,28 +101,28 @@ struct PulseParamType
 			case PVAL_TRANSFORM:	ss << "transform"; break;
 			case PVAL_COLOR_RGB:	ss << "color"; break;
 
-			case PVAL_EHANDLE:		ss << "ehandle<" << (m_LibraryClass ? m_LibraryClass : "" ) << ">"; break;
-			case PVAL_RESOURCE:		ss << "resource<" << (m_LibraryClass ? m_LibraryClass : "") << ">"; break;
+			case PVAL_EHANDLE:		ss << "ehandle<" << (library_class ? library_class : "" ) << ">"; break;
+			case PVAL_RESOURCE:		ss << "resource<" << (library_class ? library_class : "") << ">"; break;
 			case PVAL_SNDEVT_GUID:	ss << "sndevent_guid"; break;
 			case PVAL_SNDEVT_NAME:	ss << "sndevent_name"; break;
 			case PVAL_ENTITY_NAME:	ss << "entname"; break;
-			case PVAL_OPAQUE_HANDLE:ss << (m_LibraryClass ? m_LibraryClass : "schema" ) << "*"; break;
-			case PVAL_TYPESAFE_INT:	ss << (m_LibraryClass ? m_LibraryClass : "!int"); break;
+			case PVAL_OPAQUE_HANDLE:ss << (library_class ? library_class : "schema" ) << "*"; break;
+			case PVAL_TYPESAFE_INT:	ss << (library_class ? library_class : "!int"); break;
 			case PVAL_CURSOR_FLOW:	ss << "cursor"; break;
 
 			case PVAL_VARIANT:		ss << "variant"; break;
 			case PVAL_UNKNOWN:		ss << "unknown"; break;
 
-			case PVAL_SCHEMA_ENUM:	ss << "enum {" << m_LibraryClass << "}"; break;
+			case PVAL_SCHEMA_ENUM:	ss << "enum {" << library_class << "}"; break;
 			case PVAL_PANORAMA_PANEL_HANDLE: ss << "panorama_panel_handle"; break;
-			case PVAL_TEST_HANDLE:	ss << "testhandle<" << (m_LibraryClass ? m_LibraryClass : "") << ">"; break;
+			case PVAL_TEST_HANDLE:	ss << "testhandle<" << (library_class ? library_class : "") << ">"; break;
 			case PVAL_PARTICLE_EHANDLE: ss << "particle_ehandle"; break;
 
 			default:
 			{
 				if(SchemaReader::IsVerboseLogging())
 				{
-					META_CONPRINTF( "Found unknown pulse type (%d).\n", m_Type );
+					META_CONPRINTF( "Found unknown pulse type (%d).\n", type );
 				}
 
 				ss << "<unknown>";
@@ -121,24 +131,64 @@ struct PulseParamType
 		}
 
 		// This is mostly to catch any changes in the pulse system
-		if(m_LibraryClass &&
-			m_Type != PVAL_EHANDLE &&
-			m_Type != PVAL_OPAQUE_HANDLE &&
-			m_Type != PVAL_TYPESAFE_INT &&
-			m_Type != PVAL_SCHEMA_ENUM &&
-			m_Type != PVAL_TEST_HANDLE &&
-			m_Type != PVAL_EHANDLE &&
-			m_Type != PVAL_RESOURCE)
+		if(library_class &&
+			type != PVAL_EHANDLE &&
+			type != PVAL_OPAQUE_HANDLE &&
+			type != PVAL_TYPESAFE_INT &&
+			type != PVAL_SCHEMA_ENUM &&
+			type != PVAL_TEST_HANDLE &&
+			type != PVAL_EHANDLE &&
+			type != PVAL_RESOURCE)
 		{
 			if(SchemaReader::IsVerboseLogging())
 			{
-				META_CONPRINTF( "Found valid library class (%s) field for type (%d).\n", m_LibraryClass, m_Type );
+				META_CONPRINTF( "Found valid library class (%s) field for type (%d).\n", library_class, type );
 			}
 		}
 		
 		return ss.str();
 	}
 
+	// Name of the value type alone, without its library class or subtype
+	static const char *KindToString( PulseValueType_t type )
+	{
+		switch(type)
+		{
+			case PVAL_BOOL:					return "bool";
+			case PVAL_INT:					return "int";
+			case PVAL_FLOAT:				return "float";
+			case PVAL_STRING:				return "string";
+			case PVAL_VEC2:					return "vec2";
+			case PVAL_VEC3:					return "vec3";
+			case PVAL_QANGLE:				return "qangle";
+			case PVAL_VEC3_WORLDSPACE:		return "vec3_world";
+			case PVAL_VEC4:					return "vec4";
+			case PVAL_TRANSFORM:			return "transform";
+			case PVAL_TRANSFORM_WORLDSPACE:	return "transform_world";
+			case PVAL_COLOR_RGB:			return "color";
+			case PVAL_GAMETIME:				return "game_time";
+			case PVAL_EHANDLE:				return "ehandle";
+			case PVAL_RESOURCE:				return "resource";
+			case PVAL_RESOURCE_NAME:		return "resource_name";
+			case PVAL_SNDEVT_GUID:			return "sndevent_guid";
+			case PVAL_SNDEVT_NAME:			return "sndevent_name";
+			case PVAL_ENTITY_NAME:			return "entname";
+			case PVAL_OPAQUE_HANDLE:		return "opaque_handle";
+			case PVAL_TYPESAFE_INT:			return "typesafe_int";
+			case PVAL_MODEL_MATERIAL_GROUP:	return "model_material_group";
+			case PVAL_CURSOR_FLOW:			return "cursor";
+			case PVAL_VARIANT:				return "variant";
+			case PVAL_UNKNOWN:				return "unknown";
+			case PVAL_SCHEMA_ENUM:			return "enum";
+			case PVAL_PANORAMA_PANEL_HANDLE:return "panorama_panel_handle";
+			case PVAL_TEST_HANDLE:			return "testhandle";
+			case PVAL_ARRAY:				return "array";
+			case PVAL_TYPESAFE_INT64:		return "typesafe_int64";
+			case PVAL_PARTICLE_EHANDLE:		return "particle_ehandle";
+			default:						return "<unknown>";
+		}
+	}
+
 	PulseValueType_t m_Type;
 	PulseParamType *m_SubType;
 	const char *m_LibraryClass;
@@ -7,6 +7,7 @@
 #include <string>
 #include <sstream>
 #include <map>
+#include <type_traits>
 
 #include "string_view"
 using namespace std::string_view_literals;
@@ -116,6 +117,9 @@ struct SchemaMetadataField : public SchemaMetadataEntryData_t
 	const T &Value() const { return *reinterpret_cast<T *>(m_pData); }
 	const char *Name() const { return m_pszName; }
 	std::string ToString() const { return ""; };
+
+	// Writes value member with its natural json type, returns false if there's none and value should be stringified
+	bool WriteTypedValue( KeyValues3 *metatag ) const { return false; }
 };
 
 template<> inline std::string SchemaMetadataField<const char *>::ToString() const { return Value(); }
@@ -123,6 +127,9 @@ template<> inline std::string SchemaMetadataField<const char [8]>::ToString() co
 template<> inline std::string SchemaMetadataField<int>::ToString() const { return std::to_string( Value() ); }
 template<> inline std::string SchemaMetadataField<float>::ToString() const { return std::to_string( Value() ); }
 
+template<> inline bool SchemaMetadataField<int>::WriteTypedValue( KeyValues3 *metatag ) const { metatag->SetMemberInt( "value", Value() ); return true; }
+template<> inline bool SchemaMetadataField<float>::WriteTypedValue( KeyValues3 *metatag ) const { metatag->SetMemberFloat( "value", Value() ); return true; }
+
 template<> inline std::string SchemaMetadataField<empty_t>::ToString() const
 {
 	if(m_pData != nullptr && SchemaReader::IsVerboseLogging())
@@ -146,6 +153,18 @@ template<> inline std::string SchemaMetadataField<CSchemaNetworkVarName>::ToStri
 	return ss.str();
 }
 
+template<> inline bool SchemaMetadataField<CSchemaNetworkVarName>::WriteTypedValue( KeyValues3 *metatag ) const
+{
+	auto &value = Value();
+	auto kv = metatag->FindOrCreateMember( "value" );
+
+	kv->SetMemberString( "field", value.m_FieldName );
+	if(value.m_TypeName != nullptr)
+		kv->SetMemberString( "type", value.m_TypeName );
+
+	return true;
+}
+
 template<> inline std::string SchemaMetadataField<CSchemaNetworkOverride>::ToString() const
 {
 	auto &value = Value();
@@ -159,6 +178,18 @@ template<> inline std::string SchemaMetadataField<CSchemaNetworkOverride>::ToStr
 	return ss.str();
 }
 
+template<> inline bool SchemaMetadataField<CSchemaNetworkOverride>::WriteTypedValue( KeyValues3 *metatag ) const
+{
+	auto &value = Value();
+	auto kv = metatag->FindOrCreateMember( "value" );
+
+	kv->SetMemberString( "field", value.m_FieldName );
+	if(value.m_TypeName != nullptr)
+		kv->SetMemberString( "class", value.m_TypeName );
+
+	return true;
+}
+
 template<> inline std::string SchemaMetadataField<FnGetKV3Defaults>::ToString() const
 {
 #if SOURCE_ENGINE == SE_CS2
@@ -187,11 +218,25 @@ class SchemaMetadataToString
 {
 public:
 	using FnSchemaMetadataToString = std::string( * )(SchemaMetadataEntryData_t *meta);
-	using MetadataMapType = std::map<std::string_view, FnSchemaMetadataToString>;
+	using FnSchemaMetadataWriteTyped = bool( * )(SchemaMetadataEntryData_t *meta, KeyValues3 *metatag);
+
+	struct MetadataHandlers
+	{
+		FnSchemaMetadataToString m_ToString;
+		FnSchemaMetadataWriteTyped m_WriteTyped;
+
+		// True if values of this tag are written by m_WriteTyped
+		bool m_bTyped;
 
-	SchemaMetadataToString( std::string_view metatag, FnSchemaMetadataToString cb )
+		// How the payload is laid out, see PayloadKind
+		const char *m_PayloadKind;
+	};
+
+	using MetadataMapType = std::map<std::string_view, MetadataHandlers>;
+
+	SchemaMetadataToString( std::string_view metatag, FnSchemaMetadataToString cb, FnSchemaMetadataWriteTyped typed_cb, bool typed, const char *payload_kind )
 	{
-		MetadataMap().emplace( metatag, cb );
+		MetadataMap().emplace( metatag, MetadataHandlers{ cb, typed_cb, typed, payload_kind } );
 	}
 
 	static std::string Eval( SchemaMetadataEntryData_t *meta )
@@ -207,7 +252,37 @@ public:
 			return "!!UNKNOWN!!";
 		}
 
-		return iter->second( meta );
+		return iter->second.m_ToString( meta );
+	}
+
+	// Returns false for tags without typed values, these should be stringified with Eval instead
+	static bool WriteTyped( SchemaMetadataEntryData_t *meta, KeyValues3 *metatag )
+	{
+		auto iter = MetadataMap().find( meta->m_pszName );
+		if(iter == MetadataMap().end() || !iter->second.m_bTyped)
+			return false;
+
+		return iter->second.m_WriteTyped( meta, metatag );
+	}
+
+	// Returns "opaque" for unknown tags, their payload can't be reconstructed from the stringified value
+	static const char *GetPayloadKind( SchemaMetadataEntryData_t *meta )
+	{
+		auto iter = MetadataMap().find( meta->m_pszName );
+		if(iter == MetadataMap().end())
+			return "opaque";
+
+		return iter->second.m_PayloadKind;
+	}
+
+	template <typename FN>
+	static void ForEachTypedTag( FN &&fn )
+	{
+		for(auto &[metatag, handlers] : MetadataMap())
+		{
+			if(handlers.m_bTyped)
+				fn( metatag );
+		}
 	}
 
 	template <typename T>
@@ -216,6 +291,41 @@ public:
 		return reinterpret_cast<SchemaMetadataField<T> *>(meta)->ToString();
 	}
 
+	template <typename T>
+	static bool FnWriteTyped( SchemaMetadataEntryData_t *meta, KeyValues3 *metatag )
+	{
+		return reinterpret_cast<SchemaMetadataField<T> *>(meta)->WriteTypedValue( metatag );
+	}
+
+	template <typename T>
+	static constexpr bool IsTyped()
+	{
+		return std::is_same_v<T, int> || std::is_same_v<T, float> || std::is_same_v<T, CSchemaNetworkVarName> || std::is_same_v<T, CSchemaNetworkOverride>;
+	}
+
+	// Payload layout as recorded in captures, so a replay can rebuild payloads from stringified values.
+	// Opaque payloads (function and module pointers) are replayed as zeroed data
+	template <typename T>
+	static constexpr const char *PayloadKind()
+	{
+		if constexpr(std::is_same_v<T, empty_t>)
+			return "empty";
+		else if constexpr(std::is_same_v<T, const char *>)
+			return "string";
+		else if constexpr(std::is_same_v<T, const char[8]>)
+			return "inline_string";
+		else if constexpr(std::is_same_v<T, int>)
+			return "int";
+		else if constexpr(std::is_same_v<T, float>)
+			return "float";
+		else if constexpr(std::is_same_v<T, CSchemaNetworkVarName>)
+			return "var_name";
+		else if constexpr(std::is_same_v<T, CSchemaNetworkOverride>)
+			return "override";
+		else
+			return "opaque";
+	}
+
 private:
 	static MetadataMapType &MetadataMap()
 	{
@@ -230,7 +340,7 @@ private:
 	static const char *Tag() { return s_ThisClassName; }\
 	static inline const char *s_ThisClassName = #name;\
 };\
-SchemaMetadataToString name##_decl( #name##sv, SchemaMetadataToString::FnToString<type> );
+SchemaMetadataToString name##_decl( #name##sv, SchemaMetadataToString::FnToString<type>, SchemaMetadataToString::FnWriteTyped<type>, SchemaMetadataToString::IsTyped<type>(), SchemaMetadataToString::PayloadKind<type>() );
 
 METADATA_TAG( MKV3TransferName, const char * );
 METADATA_TAG( MFieldVerificationName, const char * );
@@ -0,0 +1,187 @@
+#include "schemaindex.h"
+#include "schemareader.h"
+#include "schemadump_hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+static std::shared_ptr<const SchemaIndex> s_CurrentIndex;
+
+std::shared_ptr<const SchemaIndex> SchemaIndex::Get( bool force_rebuild )
+{
+	auto schema_system = SchemaReader::SchemaSystem();
+	if(!schema_system)
+		return nullptr;
+
+	// Signature is cheap to compute, so every query checks that the index is still up to date
+	uint64 signature = ComputeScopesSignature( schema_system );
+
+	auto current = Current();
+
+	if(force_rebuild || !current || current->m_ScopesSignature != signature)
+	{
+		auto index = std::make_shared<SchemaIndex>();
+		index->Build( schema_system );
+		index->m_ScopesSignature = signature;
+
+		current = std::move( index );
+
+		// Index could be read by the schema service thread
+		std::atomic_store( &s_CurrentIndex, current );
+	}
+
+	return current;
+}
+
+std::shared_ptr<const SchemaIndex> SchemaIndex::Current()
+{
+	return std::atomic_load( &s_CurrentIndex );
+}
+
+uint64 SchemaIndex::ComputeScopesSignature( CSchemaSystem *schema_system )
+{
+	auto gts = schema_system->GlobalTypeScope();
+
+	uint64 hash = SchemaDumpHashInt( schema_system->m_TypeScopes.GetNumStrings() );
+	hash = SchemaDumpHashInt( gts->m_DeclaredClasses.m_Map.Count(), hash );
+	hash = SchemaDumpHashInt( gts->m_DeclaredEnums.m_Map.Count(), hash );
+
+	for(int i = 0; i < schema_system->m_TypeScopes.GetNumStrings(); i++)
+	{
+		auto ts = schema_system->m_TypeScopes[i];
+
+		hash = SchemaDumpHashInt( (int64)(uintptr_t)ts, hash );
+		hash = SchemaDumpHashInt( ts->m_DeclaredClasses.m_Map.Count(), hash );
+		hash = SchemaDumpHashInt( ts->m_DeclaredEnums.m_Map.Count(), hash );
+	}
+
+	return hash;
+}
+
+void SchemaIndex::Build( CSchemaSystem *schema_system )
+{
+	AddTypeScope( schema_system->GlobalTypeScope() );
+
+	for(int i = 0; i < schema_system->m_TypeScopes.GetNumStrings(); i++)
+		AddTypeScope( schema_system->m_TypeScopes[i] );
+
+	ComputeLayoutHash();
+}
+
+void SchemaIndex::ComputeLayoutHash()
+{
+	std::vector<SchemaClassInfoData_t *> classes;
+	classes.reserve( m_nClassCount );
+
+	for(auto &[name, infos] : m_Classes)
+		classes.insert( classes.end(), infos.begin(), infos.end() );
+
+	std::sort( classes.begin(), classes.end(), []( SchemaClassInfoData_t *a, SchemaClassInfoData_t *b ) {
+		int result = std::strcmp( a->m_pszName, b->m_pszName );
+		if(result != 0)
+			return result < 0;
+
+		return std::strcmp( a->m_pDeclaredClass->m_pTypeScope->GetScopeName(), b->m_pDeclaredClass->m_pTypeScope->GetScopeName() ) < 0;
+	} );
+
+	m_LayoutHash = SCHEMADUMP_HASH_OFFSET;
+	for(auto ci : classes)
+		m_LayoutHash = SchemaDumpHashInt( (int64)SchemaReader::ComputeLayoutHash( ci->m_pDeclaredClass ), m_LayoutHash );
+}
+
+void SchemaIndex::AddTypeScope( CSchemaSystemTypeScope *scope )
+{
+	FOR_EACH_MAP( scope->m_DeclaredClasses.m_Map, iter )
+	{
+		auto ci = scope->m_DeclaredClasses.m_Map.Element( iter )->m_pClassInfo;
+		if(!ci)
+			continue;
+
+		m_Classes[ci->m_pszName].push_back( ci );
+		m_nClassCount++;
+
+		// Tags of a class and its fields are visited in a row, so checking the tail is enough to keep entries unique,
+		// class tags such as MNetworkVarNames repeat many times
+		for(int i = 0; i < ci->m_nStaticMetadataCount; i++)
+		{
+			auto &classes = m_MetaTags[ci->m_pStaticMetadata[i].m_pszName];
+
+			if(classes.empty() || classes.back() != ci)
+				classes.push_back( ci );
+		}
+
+		for(int i = 0; i < ci->m_nFieldCount; i++)
+		{
+			auto &field = ci->m_pFields[i];
+
+			for(int k = 0; k < field.m_nStaticMetadataCount; k++)
+			{
+				auto &classes = m_MetaTags[field.m_pStaticMetadata[k].m_pszName];
+
+				if(classes.empty() || classes.back() != ci)
+					classes.push_back( ci );
+			}
+		}
+	}
+
+	FOR_EACH_MAP( scope->m_DeclaredEnums.m_Map, iter )
+	{
+		auto ei = scope->m_DeclaredEnums.m_Map.Element( iter )->m_pEnumInfo;
+		if(!ei)
+			continue;
+
+		m_Enums[ei->m_pszName].push_back( ei );
+		m_nEnumCount++;
+	}
+}
+
+template <typename T>
+static const T *FindInIndex( const std::unordered_map<std::string_view, T> &map, std::string_view name )
+{
+	auto iter = map.find( name );
+	return iter != map.end() ? &iter->second : nullptr;
+}
+
+const std::vector<SchemaClassInfoData_t *> *SchemaIndex::FindClasses( std::string_view name ) const
+{
+	return FindInIndex( m_Classes, name );
+}
+
+const std::vector<SchemaEnumInfoData_t *> *SchemaIndex::FindEnums( std::string_view name ) const
+{
+	return FindInIndex( m_Enums, name );
+}
+
+const std::vector<SchemaClassInfoData_t *> *SchemaIndex::FindClassesWithMetaTag( std::string_view tag ) const
+{
+	return FindInIndex( m_MetaTags, tag );
+}
+
+bool SchemaIndex::FindField( SchemaClassInfoData_t *ci, std::string_view field_name, FieldLocation &location )
+{
+	// Pairs of a class and its offset within the queried class
+	std::vector<std::pair<SchemaClassInfoData_t *, int>> stack;
+	stack.push_back( { ci, 0 } );
+
+	while(!stack.empty())
+	{
+		auto [current, base_offset] = stack.back();
+		stack.pop_back();
+
+		for(int i = 0; i < current->m_nFieldCount; i++)
+		{
+			auto &field = current->m_pFields[i];
+
+			if(field_name == field.m_pszName)
+			{
+				location = { current, &field, base_offset + field.m_nSingleInheritanceOffset };
+				return true;
+			}
+		}
+
+		for(int i = current->m_nBaseClassCount - 1; i >= 0; i--)
+			stack.push_back( { current->m_pBaseClasses[i].m_pClass, base_offset + (int)current->m_pBaseClasses[i].m_nOffset } );
+	}
+
+	return false;
+}
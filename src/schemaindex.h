@@ -0,0 +1,64 @@
+#pragma once
+
+#include "schemasystem/schemasystem.h"
+
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Immutable name index over all type scopes, used to answer schema_query lookups
+// without dumping the whole schema. Built once and shared until type scopes change.
+class SchemaIndex
+{
+public:
+	// Reuses the current index if type scopes haven't changed since it was built,
+	// returns nullptr if schema system isn't ready yet
+	static std::shared_ptr<const SchemaIndex> Get( bool force_rebuild = false );
+
+	// Last built index without checking type scopes, safe to call from any thread
+	static std::shared_ptr<const SchemaIndex> Current();
+
+	struct FieldLocation
+	{
+		SchemaClassInfoData_t *m_pClass;
+		SchemaClassFieldData_t *m_pField;
+
+		// Offset within the queried class, including base class offsets
+		int m_nAbsoluteOffset;
+	};
+
+	// Classes and enums with the same name could exist in multiple scopes (e.g. server and client)
+	const std::vector<SchemaClassInfoData_t *> *FindClasses( std::string_view name ) const;
+	const std::vector<SchemaEnumInfoData_t *> *FindEnums( std::string_view name ) const;
+
+	// Classes that have the metatag on themselves or on any of their fields
+	const std::vector<SchemaClassInfoData_t *> *FindClassesWithMetaTag( std::string_view tag ) const;
+
+	// Searches the class and its bases, returns false if field wasn't found
+	static bool FindField( SchemaClassInfoData_t *ci, std::string_view field_name, FieldLocation &location );
+
+	const std::unordered_map<std::string_view, std::vector<SchemaClassInfoData_t *>> &GetClasses() const { return m_Classes; }
+	const std::unordered_map<std::string_view, std::vector<SchemaEnumInfoData_t *>> &GetEnums() const { return m_Enums; }
+
+	// Combined layout hash of every class, in name and scope order
+	uint64 GetLayoutHash() const { return m_LayoutHash; }
+
+	int GetClassCount() const { return m_nClassCount; }
+	int GetEnumCount() const { return m_nEnumCount; }
+
+private:
+	static uint64 ComputeScopesSignature( CSchemaSystem *schema_system );
+	void Build( CSchemaSystem *schema_system );
+	void AddTypeScope( CSchemaSystemTypeScope *scope );
+	void ComputeLayoutHash();
+
+	std::unordered_map<std::string_view, std::vector<SchemaClassInfoData_t *>> m_Classes;
+	std::unordered_map<std::string_view, std::vector<SchemaEnumInfoData_t *>> m_Enums;
+	std::unordered_map<std::string_view, std::vector<SchemaClassInfoData_t *>> m_MetaTags;
+
+	uint64 m_ScopesSignature = 0;
+	uint64 m_LayoutHash = 0;
+	int m_nClassCount = 0;
+	int m_nEnumCount = 0;
+};
@@ -0,0 +1,108 @@
+#include "schemalayout.h"
+
+#include <algorithm>
+
+SchemaLayoutReport AnalyzeSchemaLayout( int size, std::vector<SchemaLayoutField> &fields )
+{
+	SchemaLayoutReport report;
+
+	std::stable_sort( fields.begin(), fields.end(), []( const SchemaLayoutField &a, const SchemaLayoutField &b ) {
+		return a.m_nOffset < b.m_nOffset;
+	} );
+
+	// Fields could overlap (unions, bitfields sharing storage), so track the furthest covered byte
+	int covered = 0;
+	for(auto &field : fields)
+	{
+		if(field.m_nOffset > covered)
+		{
+			report.m_Holes.push_back( { covered, field.m_nOffset - covered } );
+			report.m_nWastedBytes += field.m_nOffset - covered;
+		}
+
+		covered = (std::max)( covered, field.m_nOffset + field.m_nSize );
+	}
+
+	if(size > covered)
+	{
+		report.m_nTailPadding = size - covered;
+		report.m_nWastedBytes += report.m_nTailPadding;
+	}
+
+	report.m_nCacheLines = (size + SR_CACHE_LINE_SIZE - 1) / SR_CACHE_LINE_SIZE;
+
+	// A field counts towards every line it touches
+	for(auto &field : fields)
+	{
+		if(!field.m_bNetworked)
+			continue;
+
+		int first_line = field.m_nOffset / SR_CACHE_LINE_SIZE;
+		int last_line = (field.m_nOffset + (std::max)( field.m_nSize, 1 ) - 1) / SR_CACHE_LINE_SIZE;
+
+		for(int line = first_line; line <= last_line; line++)
+		{
+			if(report.m_SharedNetworkLines.empty() || report.m_SharedNetworkLines.back().m_nLine < line)
+				report.m_SharedNetworkLines.push_back( { line, {} } );
+
+			// Fields are visited in offset order, so any line up to the last one is already present
+			auto iter = std::find_if( report.m_SharedNetworkLines.rbegin(), report.m_SharedNetworkLines.rend(), [line]( const SchemaLayoutSharedLine &shared ) {
+				return shared.m_nLine == line;
+			} );
+
+			iter->m_Fields.push_back( field.m_pszName );
+		}
+	}
+
+	report.m_SharedNetworkLines.erase( std::remove_if( report.m_SharedNetworkLines.begin(), report.m_SharedNetworkLines.end(), []( const SchemaLayoutSharedLine &shared ) {
+		return shared.m_Fields.size() < 2;
+	} ), report.m_SharedNetworkLines.end() );
+
+	return report;
+}
+
+void AddSchemaBitfieldUnit( std::vector<SchemaLayoutField> &fields, const char *name, int offset, int unit_size, bool networked )
+{
+	if(!fields.empty() && fields.back().m_bBitfieldUnit && fields.back().m_nOffset == offset)
+	{
+		fields.back().m_bNetworked |= networked;
+		return;
+	}
+
+	fields.push_back( { name, offset, unit_size, networked, true } );
+}
+
+int PlaceSchemaBitfieldRun( int offset, const int *bit_counts, int count, SchemaBitfieldPlacement *placements )
+{
+	int widest = 1;
+	for(int i = 0; i < count; i++)
+		widest = (std::max)( widest, (bit_counts[i] + 7) / 8 );
+
+	int unit_size = 1;
+	while(unit_size < widest && unit_size < 8)
+		unit_size *= 2;
+
+	// Units are naturally aligned
+	offset = (offset + unit_size - 1) / unit_size * unit_size;
+
+	int bit = 0;
+	for(int i = 0; i < count; i++)
+	{
+		int bits = (std::min)( bit_counts[i], unit_size * 8 );
+
+		if(bit + bits > unit_size * 8)
+		{
+			offset += unit_size;
+			bit = 0;
+		}
+
+		placements[i].m_nStorageOffset = offset;
+		placements[i].m_nUnitSize = unit_size;
+		placements[i].m_nShift = bit;
+		placements[i].m_nMask = bits >= 64 ? ~0ull : (1ull << bits) - 1;
+
+		bit += bits;
+	}
+
+	return bit > 0 ? offset + unit_size : offset;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#define SR_CACHE_LINE_SIZE 64
+
+struct SchemaLayoutField
+{
+	const char *m_pszName;
+	int m_nOffset;
+	int m_nSize;
+
+	// Has MNetworkEnable metatag
+	bool m_bNetworked;
+
+	// Storage unit of one or more bitfields (see AddSchemaBitfieldUnit)
+	bool m_bBitfieldUnit = false;
+};
+
+struct SchemaLayoutHole
+{
+	int m_nOffset;
+	int m_nSize;
+};
+
+// Networked fields that fall onto the same cache line
+struct SchemaLayoutSharedLine
+{
+	int m_nLine;
+	std::vector<const char *> m_Fields;
+};
+
+struct SchemaLayoutReport
+{
+	std::vector<SchemaLayoutHole> m_Holes;
+
+	// Padding after the last field, already included in m_nWastedBytes
+	int m_nTailPadding = 0;
+	int m_nWastedBytes = 0;
+
+	// Lines spanned assuming the object starts at a cache line boundary
+	int m_nCacheLines = 0;
+
+	std::vector<SchemaLayoutSharedLine> m_SharedNetworkLines;
+};
+
+// Analyzes a complete (flattened) object layout, fields are sorted by their offset in place
+SchemaLayoutReport AnalyzeSchemaLayout( int size, std::vector<SchemaLayoutField> &fields );
+
+// Adds a bitfield placed by PlaceSchemaBitfieldRun to a layout as its storage unit, consecutive bitfields
+// sharing a unit make up a single field named after the first of them, networked if any of them is
+void AddSchemaBitfieldUnit( std::vector<SchemaLayoutField> &fields, const char *name, int offset, int unit_size, bool networked );
+
+struct SchemaBitfieldPlacement
+{
+	// Offset of the storage unit the bitfield is read from and its size in bytes
+	int m_nStorageOffset = 0;
+	int m_nUnitSize = 0;
+
+	// Bitfield value is (unit >> m_nShift) & m_nMask
+	int m_nShift = 0;
+	uint64_t m_nMask = 0;
+};
+
+// Places a run of consecutive bitfields that starts after offset, schema doesn't record declared types of bitfields,
+// so the unit is sized after the widest bitfield of the run and a bitfield that doesn't fit starts a new unit.
+// This is a guess: e.g. 12 bit fields declared as uint32 share a unit in reality, but are split here, and
+// reuse of base class tail padding isn't known either. Returns the offset past the last used unit
+int PlaceSchemaBitfieldRun( int offset, const int *bit_counts, int count, SchemaBitfieldPlacement *placements );
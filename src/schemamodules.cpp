@@ -0,0 +1,89 @@
+#include "schemamodules.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if defined( __linux__ )
+#include <elf.h>
+
+std::string ReadElfBuildId( const dl_phdr_info *info )
+{
+	for(int i = 0; i < info->dlpi_phnum; i++)
+	{
+		auto &phdr = info->dlpi_phdr[i];
+		if(phdr.p_type != PT_NOTE)
+			continue;
+
+		auto data = reinterpret_cast<const uint8_t *>(info->dlpi_addr + phdr.p_vaddr);
+		size_t offset = 0;
+
+		while(offset + sizeof( ElfW( Nhdr ) ) <= phdr.p_memsz)
+		{
+			auto note = reinterpret_cast<const ElfW( Nhdr ) *>(data + offset);
+			auto name = reinterpret_cast<const char *>(note + 1);
+			auto desc = reinterpret_cast<const uint8_t *>(name) + ((note->n_namesz + 3) & ~3);
+
+			if(note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && std::memcmp( name, "GNU", 4 ) == 0)
+			{
+				static const char s_HexChars[] = "0123456789abcdef";
+
+				std::string build_id;
+				for(uint32_t k = 0; k < note->n_descsz; k++)
+				{
+					build_id += s_HexChars[desc[k] >> 4];
+					build_id += s_HexChars[desc[k] & 0xf];
+				}
+
+				return build_id;
+			}
+
+			offset += sizeof( ElfW( Nhdr ) ) + ((note->n_namesz + 3) & ~3) + ((note->n_descsz + 3) & ~3);
+		}
+	}
+
+	return "";
+}
+
+std::vector<SchemaLoadedModule> EnumerateLoadedModules()
+{
+	std::vector<SchemaLoadedModule> modules;
+
+	dl_iterate_phdr( []( dl_phdr_info *info, size_t, void *data ) -> int {
+		if(info->dlpi_name && info->dlpi_name[0])
+			static_cast<std::vector<SchemaLoadedModule> *>(data)->push_back( { info->dlpi_name, ReadElfBuildId( info ) } );
+
+		return 0;
+	}, &modules );
+
+	return modules;
+}
+#else
+std::vector<SchemaLoadedModule> EnumerateLoadedModules()
+{
+	return {};
+}
+#endif
+
+std::filesystem::path SchemaModuleCache::GetPath( const std::string &build_id ) const
+{
+	if(build_id.empty())
+		return {};
+
+	return m_Dir / (build_id + ".kv3");
+}
+
+bool SchemaModuleCache::Load( const std::string &build_id, std::string &content ) const
+{
+	auto path = GetPath( build_id );
+	if(path.empty())
+		return false;
+
+	std::ifstream inp( path, std::ios::binary );
+	if(!inp.is_open())
+		return false;
+
+	content.assign( std::istreambuf_iterator<char>( inp ), std::istreambuf_iterator<char>() );
+	return !content.empty();
+}
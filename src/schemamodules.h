@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if defined( __linux__ )
+#include <link.h>
+#endif
+
+// Loaded module enumeration and the on disk cache of their extracted metadata keyed by ELF build id.
+// Free of sdk dependencies, so it's covered by tests/modules_test.cpp against a stub module. Linux only
+
+struct SchemaLoadedModule
+{
+	std::string m_Path;
+
+	// Hex encoded NT_GNU_BUILD_ID note, empty if the module has none
+	std::string m_BuildId;
+};
+
+#if defined( __linux__ )
+std::string ReadElfBuildId( const dl_phdr_info *info );
+#endif
+
+// Every loaded shared object, main executable and vdso come without a path and are skipped
+std::vector<SchemaLoadedModule> EnumerateLoadedModules();
+
+class SchemaModuleCache
+{
+public:
+	explicit SchemaModuleCache( std::filesystem::path dir ) : m_Dir( std::move( dir ) ) {}
+
+	// Empty for modules without a build id, these are never cached
+	std::filesystem::path GetPath( const std::string &build_id ) const;
+
+	// Reads cached content of the module, returns false on a miss
+	bool Load( const std::string &build_id, std::string &content ) const;
+
+private:
+	std::filesystem::path m_Dir;
+};
@@ -1,16 +1,28 @@
 #include "schemareader.h"
 #include "schema_metadata.h"
 #include "pulse_metadata.h"
+#include "schemadump_hash.h"
+#include "schemaindex.h"
+#include "schemasnapshot.h"
 
 #include "plugin.h"
 
 #include <fstream>
 #include <filesystem>
 #include <ctime>
+#include <chrono>
+#include <algorithm>
+#include <cerrno>
+#include <queue>
+#include <unordered_set>
 
 #if PLATFORM_WINDOWS
 #include <windows.h>
 #include <tlhelp32.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <dlfcn.h>
 #endif
 
 CSchemaSystem *SchemaReader::SchemaSystem()
@@ -31,11 +43,11 @@ CSchemaSystem *SchemaReader::SchemaSystem()
 	return s_SchemaSystem;
 }
 
-KeyValues3 *SchemaReader::FindDefEntry( CSchemaType *type )
+KV3Fanout SchemaReader::FindDefEntry( CSchemaType *type ) const
 {
 	int idx = FindTypeMapEntry( type );
 	if(idx == -1)
-		return nullptr;
+		return KV3Fanout();
 
 	return FindDefEntry( idx );
 }
@@ -49,27 +61,13 @@ int SchemaReader::FindTypeMapEntry( CSchemaType *type ) const
 	return iter->second;
 }
 
-std::string SchemaReader::SplitTemplatedName( CSchemaType *type ) const
-{
-	std::string name = type->m_sTypeName.Get();
-
-	if(IsSplittingAtomicNames())
-	{
-		auto pos = name.find( '<' );
-		if(pos != std::string::npos)
-			name.resize( pos );
-	}
-
-	return name;
-}
-
 void SchemaReader::RecordGameInfo()
 {
 	std::ifstream inp( std::filesystem::path( g_SMAPI->GetBaseDir() ) / "steam.inf" );
 
 	if(inp.is_open())
 	{
-		auto game_info = GetRoot()->FindOrCreateMember( "game_info" );
+		auto game_info = GetRoots().FindOrCreateMember( "game_info" );
 
 		std::string key, value;
 		do
@@ -79,7 +77,7 @@ void SchemaReader::RecordGameInfo()
 			if(!std::getline( inp, value, '\n' ))
 				break;
 
-			game_info->SetMemberString( key.c_str(), value.c_str() );
+			game_info.SetMemberString( key.c_str(), value.c_str() );
 		} while(inp.good());
 	}
 	else
@@ -90,9 +88,9 @@ void SchemaReader::RecordGameInfo()
 
 void SchemaReader::RecordDumperInfo()
 {
-	auto dumper_info = GetRoot()->FindOrCreateMember( "dumper_info" );
+	auto dumper_info = GetRoots().FindOrCreateMember( "dumper_info" );
 
-	dumper_info->SetMemberString( "version", g_ThisPlugin.GetVersion() );
+	dumper_info.SetMemberString( "version", g_ThisPlugin.GetVersion() );
 
 	{
 		std::time_t time = std::time( nullptr );
@@ -102,26 +100,94 @@ void SchemaReader::RecordDumperInfo()
 
 		// Formatted for ISO 8601 UTC time
 		std::strftime( buf, sizeof( buf ), "%Y-%m-%dT%H:%M:%SZ", gtm );
-		dumper_info->SetMemberString( "dump_date", buf );
+		dumper_info.SetMemberString( "dump_date", buf );
 	}
 
-	dumper_info->SetMemberInt( "dump_format_version", DUMPER_FILE_FORMAT_VERSION );
+	dumper_info.SetMemberInt( "dump_format_version", DUMPER_FILE_FORMAT_VERSION );
 }
 
+static std::pair<uint32, const char *> s_ClassFlagMap[] = {
+	{ SCHEMA_CF1_HAS_VIRTUAL_MEMBERS, "has_virtual_members" },
+	{ SCHEMA_CF1_IS_ABSTRACT, "is_abstract" },
+	{ SCHEMA_CF1_HAS_TRIVIAL_CONSTRUCTOR, "has_trivial_constructor" },
+	{ SCHEMA_CF1_HAS_TRIVIAL_DESTRUCTOR, "has_trivial_destructor" },
+	{ SCHEMA_CF1_LIMITED_METADATA, "limited_metadata" },
+	{ SCHEMA_CF1_INHERITANCE_DEPTH_CALCULATED, "inheritance_depth_calculated" },
+	{ SCHEMA_CF1_MODULE_LOCAL_TYPE_SCOPE, "local_type_scope" },
+	{ SCHEMA_CF1_GLOBAL_TYPE_SCOPE, "global_type_scope" },
+	{ SCHEMA_CF1_CONSTRUCT_ALLOWED, "construct_allowed" },
+	{ SCHEMA_CF1_CONSTRUCT_DISALLOWED, "construct_disallowed" },
+	{ SCHEMA_CF1_INFO_TAG_MNetworkAssumeNotNetworkable, "MNetworkAssumeNotNetworkable" },
+	{ SCHEMA_CF1_INFO_TAG_MNetworkNoBase, "MNetworkNoBase" },
+	{ SCHEMA_CF1_INFO_TAG_MIgnoreTypeScopeMetaChecks, "MIgnoreTypeScopeMetaChecks" },
+	{ SCHEMA_CF1_INFO_TAG_MDisableDataDescValidation, "MDisableDataDescValidation" },
+	{ SCHEMA_CF1_INFO_TAG_MClassHasEntityLimitedDataDesc, "MClassHasEntityLimitedDataDesc" },
+	{ SCHEMA_CF1_INFO_TAG_MClassHasCustomAlignedNewDelete, "MClassHasCustomAlignedNewDelete" },
+	{ SCHEMA_CF1_UNK016, "unk016" },
+	{ SCHEMA_CF1_INFO_TAG_MConstructibleClassBase, "MConstructibleClassBase" },
+	{ SCHEMA_CF1_INFO_TAG_MHasKV3TransferPolymorphicClassname, "MHasKV3TransferPolymorphicClassname" }
+};
+
+static std::pair<uint32, const char *> s_EnumFlagMap[] = {
+	{ SCHEMA_EF_IS_REGISTERED, "is_registered" },
+	{ SCHEMA_EF_MODULE_LOCAL_TYPE_SCOPE, "local_type_scope" },
+	{ SCHEMA_EF_GLOBAL_TYPE_SCOPE, "global_type_scope" }
+};
+
 void SchemaReader::RecordDumpFlags()
 {
-	auto dump_flags = GetRoot()->FindOrCreateMember( "dump_flags" );
-	dump_flags->SetToEmptyArray();
-
-	for(int i = 0; i < ARRAYSIZE( s_FlagsMap ); i++)
+	for(auto &profile : m_Profiles)
 	{
-		if(s_FlagsMap[i].m_OutName && (s_Flags & s_FlagsMap[i].m_Flag) != 0)
+		auto dump_flags = profile->GetRoot()->FindOrCreateMember( "dump_flags" );
+		dump_flags->SetToEmptyArray();
+
+		for(int i = 0; i < ARRAYSIZE( s_FlagsMap ); i++)
 		{
-			dump_flags->ArrayAddElementToTail()->SetString( s_FlagsMap[i].m_OutName );
+			if(s_FlagsMap[i].m_OutName && profile->HasFlag( s_FlagsMap[i].m_Flag ))
+			{
+				dump_flags->ArrayAddElementToTail()->SetString( s_FlagsMap[i].m_OutName );
+			}
 		}
 	}
 }
 
+void SchemaReader::RecordCompactInfo()
+{
+	auto roots = GetRoots().Where( SR_COMPACT );
+	if(roots.IsEmpty())
+		return;
+
+	auto compact = roots.FindOrCreateMember( "compact" );
+
+	// Defs omit type and scope when they match these, empty members and fields arrays are omitted too
+	auto defaults = compact.FindOrCreateMember( "defaults" );
+	defaults.SetMemberString( "type", SchemaTypeToString<CSchemaType_DeclaredClass>() );
+	defaults.SetMemberInterned( "scope", SchemaSystem()->GlobalTypeScope()->GetScopeName(), m_Strings );
+
+	auto write_flag_names = [&compact]( const char *name, std::pair<uint32, const char *> *flag_map, int count ) {
+		auto flag_names = compact.FindOrCreateMember( name );
+		flag_names.SetArrayElementCount( count );
+
+		for(int i = 0; i < count; i++)
+		{
+			auto flag = flag_names.GetArrayElement( i );
+			flag.SetMemberUInt( "mask", flag_map[i].first );
+			flag.SetMemberString( "name", flag_map[i].second );
+		}
+	};
+
+	write_flag_names( "class_flags", s_ClassFlagMap, ARRAYSIZE( s_ClassFlagMap ) );
+	write_flag_names( "enum_flags", s_EnumFlagMap, ARRAYSIZE( s_EnumFlagMap ) );
+
+	// Values of these metatags are numbers or objects rather than strings
+	auto typed_metatags = compact.FindOrCreateMember( "typed_metatags" );
+	typed_metatags.SetToEmptyArray();
+
+	SchemaMetadataToString::ForEachTypedTag( [&typed_metatags]( std::string_view metatag ) {
+		typed_metatags.ArrayAddElementToTail().SetString( std::string( metatag ).c_str() );
+	} );
+}
+
 uint32 SchemaReader::ParseDumpFlags( const char *flags )
 {
 	uint32 result = 0;
@@ -153,22 +219,119 @@ uint32 SchemaReader::ParseDumpFlags( const char *flags )
 	return result;
 }
 
-void SchemaReader::ReadSchema( uint32 flags )
+std::vector<uint32> SchemaReader::ParseDumpProfiles( const char *profiles )
+{
+	std::vector<uint32> result;
+
+	CSplitString split( profiles, "|" );
+	for(int i = 0; i < split.Count() && result.size() < SR_MAX_DUMP_PROFILES; i++)
+		result.push_back( ParseDumpFlags( split[i] ) );
+
+	if(split.Count() > SR_MAX_DUMP_PROFILES)
+		META_CONPRINTF( "Too many dump profiles provided, only first %d would be dumped...\n", SR_MAX_DUMP_PROFILES );
+
+	if(result.empty())
+		result.push_back( ParseDumpFlags( "" ) );
+
+	return result;
+}
+
+bool SchemaReader::ReadSchema( const std::vector<uint32> &profiles )
 {
+	// Flags that reorder shared def indices, these can't differ between profiles of a single dump
+	static const uint32 s_SharedIndexFlags[] = { SR_TOPO_ORDER, SR_DEDUPE_PROJECTS };
+
+	for(auto shared_flag : s_SharedIndexFlags)
+	{
+		bool any = false, all = true;
+		for(auto flags : profiles)
+		{
+			any |= (flags & shared_flag) != 0;
+			all &= (flags & shared_flag) != 0;
+		}
+
+		if(any && !all)
+		{
+			for(int i = 0; i < ARRAYSIZE( s_FlagsMap ); i++)
+			{
+				if(s_FlagsMap[i].m_Flag == shared_flag)
+				{
+					META_CONPRINTF( "Flag \"%s\" must be set on every dump profile or none, aborting...\n", s_FlagsMap[i].m_Name );
+					break;
+				}
+			}
+
+			return false;
+		}
+	}
+
 	META_CONPRINTF( "Reading schema...\n" );
 
+	m_Flags = 0;
+	for(auto flags : profiles)
+	{
+		std::string name;
+		for(int i = 0; i < ARRAYSIZE( s_FlagsMap ); i++)
+		{
+			if(s_FlagsMap[i].m_OutName && (flags & s_FlagsMap[i].m_Flag) != 0)
+			{
+				if(!name.empty())
+					name += '_';
+
+				name += s_FlagsMap[i].m_Name;
+			}
+		}
+
+		m_Profiles.push_back( std::make_unique<SchemaDumpProfile>( flags, name.empty() ? "default" : name ) );
+		m_Roots.Add( m_Profiles.back()->GetRoot(), m_Profiles.back().get() );
+		m_Flags |= flags;
+	}
+
+	s_VerboseLogging = (m_Flags & SR_VERBOSE_LOGGING) != 0;
+
 	RecordGameInfo();
 	RecordDumperInfo();
-
-	s_Flags = flags;
 	RecordDumpFlags();
+	RecordCompactInfo();
+
+	CollectSchemaTypes();
+
+	if(m_Flags & SR_DEDUPE_PROJECTS)
+		DedupeProjectTypes();
+
+	if(m_Flags & SR_TOPO_ORDER)
+		SortSchemaTypesTopologically();
+
+	ReadSchemaTypes();
+	ReadScopeLayoutHashes();
+	ReadTypeGraph();
+
+	if(m_Flags & SR_DUMP_HIERARCHY)
+		ReadHierarchy();
+
+	if(m_Flags & (SR_DUMP_FLATTENED | SR_LAYOUT_REPORT | SR_NET_REPORT))
+	{
+		std::vector<std::vector<FlattenedField>> layouts;
+		BuildFlattenedLayouts( layouts );
+
+		ReadFlattenedLayouts( layouts );
+
+		if(m_Flags & SR_LAYOUT_REPORT)
+			ReadLayoutReports( layouts );
+
+		if(m_Flags & SR_NET_REPORT)
+			ReadNetReports( layouts );
+	}
 
-	ReadBuiltins();
-	ReadDeclClasses();
-	ReadDeclEnums();
 	ReadAtomics();
 	ReadPulseBindings();
 	ReadModuleMetadata();
+
+	ReadStringTable();
+
+	ReportStorageUsage();
+
+	return true;
 }
 
 void SchemaReader::SetOutDir( const std::filesystem::path &out_dir )
@@ -184,27 +347,47 @@ void SchemaReader::ValidateOutDir()
 		SetOutDir( "dumps/" );
 }
 
-void SchemaReader::ReadBuiltins()
+int SchemaReader::RequestTypeMapEntry( CSchemaType *type )
 {
-	META_CONPRINTF( "Reading builtins...\n" );
+	auto [iter, inserted] = m_TypeMap.emplace( type, (int)m_Types.size() );
+
+	if(inserted)
+		m_Types.push_back( { type } );
 
+	return iter->second;
+}
+
+void SchemaReader::CollectBuiltins()
+{
 	auto gts = SchemaSystem()->GlobalTypeScope();
 
 	for(int i = SCHEMA_BUILTIN_TYPE_VOID; i < SCHEMA_BUILTIN_TYPE_COUNT; i++)
 	{
-		CreateDefEntry( &gts->m_BuiltinTypes[i] );
+		RequestTypeMapEntry( &gts->m_BuiltinTypes[i] );
 	}
 }
 
-void SchemaReader::ReadDeclClasses()
+template <typename T>
+static void SortSchemaTypes( std::vector<T *> &types )
 {
-	META_CONPRINTF( "Reading classes...\n" );
+	// Type scopes are ordered by module load order, so sort to keep output order stable between runs
+	std::sort( types.begin(), types.end(), []( T *a, T *b ) {
+		int result = std::strcmp( a->m_pTypeScope->GetScopeName(), b->m_pTypeScope->GetScopeName() );
+		if(result != 0)
+			return result < 0;
+
+		return std::strcmp( a->m_sTypeName.Get(), b->m_sTypeName.Get() ) < 0;
+	} );
+}
 
+void SchemaReader::CollectDeclClasses()
+{
+	std::vector<CSchemaType_DeclaredClass *> classes;
 	auto gts = SchemaSystem()->GlobalTypeScope();
 
 	FOR_EACH_MAP( gts->m_DeclaredClasses.m_Map, iter )
 	{
-		ReadDeclClass( gts->m_DeclaredClasses.m_Map.Element( iter ) );
+		classes.push_back( gts->m_DeclaredClasses.m_Map.Element( iter ) );
 	}
 
 	for(int i = 0; i < SchemaSystem()->m_TypeScopes.GetNumStrings(); i++)
@@ -213,20 +396,24 @@ void SchemaReader::ReadDeclClasses()
 
 		FOR_EACH_MAP( ts->m_DeclaredClasses.m_Map, iter )
 		{
-			ReadDeclClass( ts->m_DeclaredClasses.m_Map.Element( iter ) );
+			classes.push_back( ts->m_DeclaredClasses.m_Map.Element( iter ) );
 		}
 	}
+
+	SortSchemaTypes( classes );
+
+	for(auto type : classes)
+		RequestTypeMapEntry( type );
 }
 
-void SchemaReader::ReadDeclEnums()
+void SchemaReader::CollectDeclEnums()
 {
-	META_CONPRINTF( "Reading enums...\n" );
-
+	std::vector<CSchemaType_DeclaredEnum *> enums;
 	auto gts = SchemaSystem()->GlobalTypeScope();
 
 	FOR_EACH_MAP( gts->m_DeclaredEnums.m_Map, iter )
 	{
-		ReadDeclEnum( gts->m_DeclaredEnums.m_Map.Element( iter ) );
+		enums.push_back( gts->m_DeclaredEnums.m_Map.Element( iter ) );
 	}
 
 	for(int i = 0; i < SchemaSystem()->m_TypeScopes.GetNumStrings(); i++)
@@ -235,878 +422,3200 @@ void SchemaReader::ReadDeclEnums()
 
 		FOR_EACH_MAP( ts->m_DeclaredEnums.m_Map, iter )
 		{
-			ReadDeclEnum( ts->m_DeclaredEnums.m_Map.Element( iter ) );
+			enums.push_back( ts->m_DeclaredEnums.m_Map.Element( iter ) );
 		}
 	}
+
+	SortSchemaTypes( enums );
+
+	for(auto type : enums)
+		RequestTypeMapEntry( type );
 }
 
-void SchemaReader::ReadAtomics()
+void SchemaReader::CountSchemaTypes( SchemaTypeCounts &counts ) const
 {
-	if(!IsDumpingAtomics())
-		return;
+	counts = SchemaTypeCounts();
+	counts.m_nDefs = SCHEMA_BUILTIN_TYPE_COUNT;
 
-	META_CONPRINTF( "Reading atomics...\n" );
+	auto count_scope = [&counts]( CSchemaSystemTypeScope *ts ) {
+		counts.m_nAtomics += ts->m_AtomicInfos.m_Map.Count();
 
-	auto gts = SchemaSystem()->GlobalTypeScope();
+		FOR_EACH_MAP( ts->m_DeclaredClasses.m_Map, iter )
+		{
+			counts.m_nDefs++;
 
-	FOR_EACH_MAP( gts->m_AtomicInfos.m_Map, iter )
-	{
-		ReadAtomicInfo( gts->m_AtomicInfos.m_Map.Element( iter ).Get() );
-	}
+			auto ci = ts->m_DeclaredClasses.m_Map.Element( iter )->m_pClassInfo;
+			if(!ci)
+				continue;
 
-	for(int i = 0; i < SchemaSystem()->m_TypeScopes.GetNumStrings(); i++)
-	{
-		auto ts = SchemaSystem()->m_TypeScopes[i];
+			counts.m_nMembers += ci->m_nFieldCount;
+			counts.m_nMetaTags += ci->m_nStaticMetadataCount;
 
-		FOR_EACH_MAP( ts->m_AtomicInfos.m_Map, iter )
+			for(int i = 0; i < ci->m_nFieldCount; i++)
+				counts.m_nMetaTags += ci->m_pFields[i].m_nStaticMetadataCount;
+		}
+
+		FOR_EACH_MAP( ts->m_DeclaredEnums.m_Map, iter )
 		{
-			ReadAtomicInfo( ts->m_AtomicInfos.m_Map.Element( iter ).Get() );
+			counts.m_nDefs++;
+
+			auto ei = ts->m_DeclaredEnums.m_Map.Element( iter )->m_pEnumInfo;
+			if(!ei)
+				continue;
+
+			counts.m_nEnumFields += ei->m_nEnumeratorCount;
+			counts.m_nMetaTags += ei->m_nStaticMetadataCount;
+
+			for(int i = 0; i < ei->m_nEnumeratorCount; i++)
+				counts.m_nMetaTags += ei->m_pEnumerators[i].m_nStaticMetadataCount;
 		}
-	}
+	};
+
+	count_scope( SchemaSystem()->GlobalTypeScope() );
+
+	for(int i = 0; i < SchemaSystem()->m_TypeScopes.GetNumStrings(); i++)
+		count_scope( SchemaSystem()->m_TypeScopes[i] );
 }
 
-void SchemaReader::ReadMemberSchemaType( KeyValues3 *root, CSchemaType *type, bool append_subtype )
+void SchemaReader::ReserveStorage( const SchemaTypeCounts &counts )
 {
-	if(append_subtype)
-		root = root->FindOrCreateMember( "subtype" );
+	m_ReservedCounts = counts;
 
-	switch(type->m_eTypeCategory)
+	// Every collected type is either a builtin or declared in one of the scopes, so def count is an upper bound
+	m_Types.reserve( counts.m_nDefs );
+	m_TypeMap.reserve( counts.m_nDefs );
+	m_Atomics.reserve( counts.m_nAtomics );
+	m_AtomicMap.reserve( counts.m_nAtomics );
+
+	// Every member references a type, most of them shared, so this is an upper bound for anything but nested atomics
+	m_TypeAttributes.Reserve( counts.m_nDefs + counts.m_nMembers );
+
+	// Metatag names and values make up most of the interned strings, the rest are scopes, projects and atomic names
+	m_nReservedStrings = counts.m_nMetaTags * 2 + counts.m_nAtomics + SchemaSystem()->m_TypeScopes.GetNumStrings() * 2;
+	m_Strings.Reserve( m_nReservedStrings );
+
+	m_nReservedTypeMapBuckets = m_TypeMap.bucket_count();
+	m_nReservedAtomicMapBuckets = m_AtomicMap.bucket_count();
+	m_nReservedTypeAttributesBuckets = m_TypeAttributes.BucketCount();
+	m_nReservedStringBuckets = m_Strings.BucketCount();
+}
+
+void SchemaReader::CountDumpedTypes( SchemaTypeCounts &counts ) const
+{
+	counts = SchemaTypeCounts();
+	counts.m_nDefs = (int)m_Types.size();
+	counts.m_nAtomics = (int)m_Atomics.size();
+
+	for(auto &node : m_Types)
 	{
-		case SCHEMA_TYPE_BUILTIN:
-		case SCHEMA_TYPE_DECLARED_CLASS:
-		case SCHEMA_TYPE_DECLARED_ENUM:
+		if(auto decl_class = node.m_pType->ReinterpretAs<CSchemaType_DeclaredClass>())
 		{
-			root->SetMemberString( "type", "ref" );
+			auto ci = decl_class->m_pClassInfo;
+			if(!ci)
+				continue;
 
-			if(type->IsA<CSchemaType_Builtin>())
-				root->SetMemberInt( "ref_idx", FindTypeMapEntry( type ) );
-			else if(type->IsA<CSchemaType_DeclaredClass>())
-				root->SetMemberInt( "ref_idx", ReadDeclClass( type->ReinterpretAs<CSchemaType_DeclaredClass>() ) );
-			else
-				root->SetMemberInt( "ref_idx", ReadDeclEnum( type->ReinterpretAs<CSchemaType_DeclaredEnum>() ) );
+			counts.m_nMembers += ci->m_nFieldCount;
+			counts.m_nMetaTags += ci->m_nStaticMetadataCount;
 
-			break;
+			for(int i = 0; i < ci->m_nFieldCount; i++)
+				counts.m_nMetaTags += ci->m_pFields[i].m_nStaticMetadataCount;
 		}
-		case SCHEMA_TYPE_POINTER:
+		else if(auto decl_enum = node.m_pType->ReinterpretAs<CSchemaType_DeclaredEnum>())
 		{
-			auto ptr = type->ReinterpretAs<CSchemaType_Ptr>();
+			auto ei = decl_enum->m_pEnumInfo;
+			if(!ei)
+				continue;
 
-			root->SetMemberString( "type", "ptr" );
-			ReadMemberSchemaType( root, ptr->GetInnerType().Get() );
+			counts.m_nEnumFields += ei->m_nEnumeratorCount;
+			counts.m_nMetaTags += ei->m_nStaticMetadataCount;
 
-			break;
+			for(int i = 0; i < ei->m_nEnumeratorCount; i++)
+				counts.m_nMetaTags += ei->m_pEnumerators[i].m_nStaticMetadataCount;
 		}
+	}
+}
 
-		case SCHEMA_TYPE_ATOMIC:
-		{
-			root->SetMemberString( "type", "atomic" );
-			root->SetMemberString( "name", SplitTemplatedName( type ).c_str() );
+void SchemaReader::ReportStorageUsage() const
+{
+	SchemaTypeCounts used;
+	CountDumpedTypes( used );
+
+	META_CONPRINTF( "Storage used/reserved: %d/%d defs, %d/%d members, %d/%d enum fields, %d/%d metatags, %d/%d atomics, %d/%d strings.\n",
+					used.m_nDefs, m_ReservedCounts.m_nDefs, used.m_nMembers, m_ReservedCounts.m_nMembers,
+					used.m_nEnumFields, m_ReservedCounts.m_nEnumFields, used.m_nMetaTags, m_ReservedCounts.m_nMetaTags,
+					used.m_nAtomics, m_ReservedCounts.m_nAtomics, m_Strings.Count(), m_nReservedStrings );
+
+	// Growing past the reserved bucket count means the counting pass underestimated
+	std::pair<const char *, bool> rehashes[] = {
+		{ "type map", m_TypeMap.bucket_count() != m_nReservedTypeMapBuckets },
+		{ "atomic map", m_AtomicMap.bucket_count() != m_nReservedAtomicMapBuckets },
+		{ "type attributes", m_TypeAttributes.BucketCount() != m_nReservedTypeAttributesBuckets },
+		{ "string table", m_Strings.BucketCount() != m_nReservedStringBuckets }
+	};
+
+	for(auto &[name, rehashed] : rehashes)
+	{
+		if(rehashed)
+			META_CONPRINTF( "Storage of %s was rehashed past its reserved size.\n", name );
+	}
+}
 
-			int size;
-			uint8 alignment;
-			type->GetSizeAndAlignment( size, alignment );
+void SchemaReader::CollectSchemaTypes()
+{
+	META_CONPRINTF( "Collecting types...\n" );
 
-			root->SetMemberInt( "size", size );
-			root->SetMemberUInt8( "alignment", alignment );
+	SchemaTypeCounts counts;
+	CountSchemaTypes( counts );
+	ReserveStorage( counts );
 
-			switch(type->m_eAtomicCategory)
-			{
-				case SCHEMA_ATOMIC_T:
-				{
-					auto atomic = type->ReinterpretAs<CSchemaType_Atomic_T>();
-					auto templ = root->FindOrCreateMember( "template" );
+	CollectBuiltins();
+	CollectDeclClasses();
+	CollectDeclEnums();
+	CollectAtomics();
 
-					ReadMemberSchemaType( templ->ArrayAddElementToTail(), atomic->m_pTemplateType, false );
+	// m_Types doubles as a breadth first work queue, any newly referenced type
+	// is appended to its tail and gets its index assigned right away
+	for(size_t i = 0; i < m_Types.size(); i++)
+	{
+		auto type = m_Types[i].m_pType;
 
-					break;
-				}
+		switch(type->m_eTypeCategory)
+		{
+			case SCHEMA_TYPE_DECLARED_CLASS:
+			{
+				auto decl_class = type->ReinterpretAs<CSchemaType_DeclaredClass>();
+				m_Types[i].m_ParentScopeIdx = CollectParentScope( type );
 
-				case SCHEMA_ATOMIC_TT:
-				{
-					auto atomic = type->ReinterpretAs<CSchemaType_Atomic_TT>();
-					auto templ = root->FindOrCreateMember( "template" );
+				auto ci = decl_class->m_pClassInfo;
+				if(!ci)
+					break;
 
-					ReadMemberSchemaType( templ->ArrayAddElementToTail(), atomic->m_pTemplateType, false );
-					ReadMemberSchemaType( templ->ArrayAddElementToTail(), atomic->m_pTemplateType2, false );
+				for(int k = 0; k < ci->m_nBaseClassCount; k++)
+					RequestTypeMapEntry( ci->m_pBaseClasses[k].m_pClass->m_pDeclaredClass );
 
-					break;
-				}
+				for(int k = 0; k < ci->m_nFieldCount; k++)
+					CollectMemberSchemaType( ci->m_pFields[k].m_pType );
 
-				case SCHEMA_ATOMIC_COLLECTION_OF_T:
+				if(IsApplyingNetVarOverrides() && ci->m_nBaseClassCount > 0)
 				{
-					auto atomic = type->ReinterpretAs<CSchemaType_Atomic_CollectionOfT>();
-					auto templ = root->FindOrCreateMember( "template" );
-
-					ReadMemberSchemaType( templ->ArrayAddElementToTail(), atomic->m_pTemplateType, false );
-					if(atomic->m_nFixedBufferCount > 0)
+					for(auto &meta : SchemaMetadataIterator( ci->m_pStaticMetadata, ci->m_nStaticMetadataCount ))
 					{
-						auto ii = templ->ArrayAddElementToTail();
-
-						ii->SetMemberString( "type", "literal" );
-						ii->SetMemberInt64( "value", atomic->m_nFixedBufferCount );
+						if(auto var_override = MNetworkVarTypeOverride::From( &meta ))
+						{
+							if(auto var_ci = FindSchemaTypeInTypeScopes( var_override->Value().m_TypeName ))
+								RequestTypeMapEntry( var_ci );
+						}
 					}
-
-					break;
 				}
 
-				case SCHEMA_ATOMIC_I:
-				{
-					auto atomic = type->ReinterpretAs<CSchemaType_Atomic_I>();
-					auto templ = root->FindOrCreateMember( "template" );
-
-					auto ii = templ->ArrayAddElementToTail();
-					ii->SetMemberString( "type", "literal" );
-					ii->SetMemberInt( "value", atomic->m_nInteger );
-
-					break;
-				}
+				break;
 			}
 
-			break;
+			case SCHEMA_TYPE_DECLARED_ENUM:
+			{
+				m_Types[i].m_ParentScopeIdx = CollectParentScope( type );
+				break;
+			}
 		}
+	}
+}
 
-		case SCHEMA_TYPE_BITFIELD:
+void SchemaReader::CollectMemberSchemaType( CSchemaType *type )
+{
+	// Types are nested only a few levels deep, but walk them with an explicit stack anyway
+	m_TypeStack.clear();
+	m_TypeStack.push_back( type );
+
+	while(!m_TypeStack.empty())
+	{
+		type = m_TypeStack.back();
+		m_TypeStack.pop_back();
+
+		switch(type->m_eTypeCategory)
 		{
-			auto bitfield = type->ReinterpretAs<CSchemaType_Bitfield>();
+			case SCHEMA_TYPE_BUILTIN:
+			case SCHEMA_TYPE_DECLARED_CLASS:
+			case SCHEMA_TYPE_DECLARED_ENUM:
+			{
+				RequestTypeMapEntry( type );
+				break;
+			}
 
-			root->SetMemberString( "type", "bitfield" );
-			root->SetMemberInt64( "count", bitfield->m_nBitfieldCount );
+			case SCHEMA_TYPE_POINTER:
+			{
+				m_TypeStack.push_back( type->ReinterpretAs<CSchemaType_Ptr>()->GetInnerType().Get() );
+				break;
+			}
 
-			break;
-		}
+			case SCHEMA_TYPE_FIXED_ARRAY:
+			{
+				m_TypeStack.push_back( type->ReinterpretAs<CSchemaType_FixedArray>()->GetInnerType().Get() );
+				break;
+			}
 
-		case SCHEMA_TYPE_FIXED_ARRAY:
-		{
-			auto fixed_array = type->ReinterpretAs<CSchemaType_FixedArray>();
+			case SCHEMA_TYPE_ATOMIC:
+			{
+				switch(type->m_eAtomicCategory)
+				{
+					case SCHEMA_ATOMIC_T:
+					case SCHEMA_ATOMIC_COLLECTION_OF_T:
+					{
+						m_TypeStack.push_back( type->ReinterpretAs<CSchemaType_Atomic_T>()->m_pTemplateType );
+						break;
+					}
 
-			root->SetMemberString( "type", "fixed_array" );
-			root->SetMemberInt64( "element_size", fixed_array->m_nElementSize );
-			root->SetMemberInt64( "count", fixed_array->m_nElementCount );
-			ReadMemberSchemaType( root, fixed_array->GetInnerType().Get() );
+					case SCHEMA_ATOMIC_TT:
+					{
+						auto atomic = type->ReinterpretAs<CSchemaType_Atomic_TT>();
 
-			break;
+						m_TypeStack.push_back( atomic->m_pTemplateType2 );
+						m_TypeStack.push_back( atomic->m_pTemplateType );
+						break;
+					}
+				}
+
+				break;
+			}
 		}
 	}
 }
 
-int SchemaReader::ReadDeclClass( CSchemaType_DeclaredClass *type )
+void SchemaReader::CollectAtomics()
 {
-	auto [def, idx] = CreateDefEntry( type );
+	if(!IsDumpingAtomics())
+		return;
 
-	if(!def)
-		return idx;
-	
-	auto traits = def->FindOrCreateMember( "traits" );
-	auto ci = type->m_pClassInfo;
+	auto gts = SchemaSystem()->GlobalTypeScope();
 
-	LinkChildParentScopeDecls( traits, type, idx );
-	ReadFlags( traits, type );
+	FOR_EACH_MAP( gts->m_AtomicInfos.m_Map, iter )
+	{
+		RequestAtomicEntry( gts->m_AtomicInfos.m_Map.Element( iter ).Get() );
+	}
 
-	if(ci)
+	for(int i = 0; i < SchemaSystem()->m_TypeScopes.GetNumStrings(); i++)
 	{
-		// Ugly hack to prevent stringifying corrupted kv3 getter in that class,
-		// otherwise it'll crash when attempted to be retrieved
-		if(std::strcmp( ci->m_pszName, "CastSphereSATParams_t" ) != 0 &&
-			std::strcmp( ci->m_pszName, "fogplayerparams_t" ) != 0 &&
-			// This one outputs corrupted string symbols (mostly just pure data bytes of something)
-			// which will trip json parsers later
-			std::strcmp( ci->m_pszName, "modifiedconvars_t" ) != 0)
-			ReadMetaTags( traits, ci->m_pStaticMetadata, ci->m_nStaticMetadataCount );
+		auto ts = SchemaSystem()->m_TypeScopes[i];
 
-		if(ci->m_nBaseClassCount > 0)
+		FOR_EACH_MAP( ts->m_AtomicInfos.m_Map, iter )
 		{
-			traits->SetMemberUShort( "multi_depth", ci->m_nMultipleInheritanceDepth );
-			traits->SetMemberUShort( "single_depth", ci->m_nSingleInheritanceDepth );
-
-			auto baseclasses = traits->FindOrCreateMember( "baseclasses" );
-			baseclasses->SetArrayElementCount( ci->m_nBaseClassCount );
-
-			for(int i = 0; i < ci->m_nBaseClassCount; i++)
-			{
-				auto &base_ci = ci->m_pBaseClasses[i];
-				auto baseclass = baseclasses->GetArrayElement( i );
-
-				baseclass->SetMemberUInt( "offset", base_ci.m_nOffset );
-				baseclass->SetMemberInt( "ref_idx", ReadDeclClass( base_ci.m_pClass->m_pDeclaredClass ) );
-			}
+			RequestAtomicEntry( ts->m_AtomicInfos.m_Map.Element( iter ).Get() );
 		}
 	}
+}
 
-	ApplyNetVarOverrides( type );
+int SchemaReader::RequestAtomicEntry( SchemaAtomicTypeInfo_t *info )
+{
+	auto [iter, inserted] = m_AtomicMap.emplace( info->m_nAtomicID, (int)m_Atomics.size() );
 
-	auto members = traits->FindOrCreateMember( "members" );
+	if(inserted)
+		m_Atomics.push_back( info );
 
-	if(ci)
-	{
-		members->SetArrayElementCount( ci->m_nFieldCount );
+	return iter->second;
+}
 
-		for(int i = 0; i < ci->m_nFieldCount; i++)
-		{
-			auto field = ci->m_pFields[i];
-			auto member = members->GetArrayElement( i );
+int SchemaReader::CollectParentScope( CSchemaType *type )
+{
+	if(!IsKeepingParentScopes())
+		return -1;
 
-			member->SetMemberString( "name", field.m_pszName );
-			member->SetMemberInt( "offset", field.m_nSingleInheritanceOffset );
-			auto member_traits = member->FindOrCreateMember( "traits" );
+	// Account for classes/structs defined within other classes/structs
+	CSplitString class_scoping( type->m_sTypeName.Get(), "::" );
+	if(class_scoping.Count() <= 1)
+		return -1;
 
-			ReadMetaTags( member_traits, field.m_pStaticMetadata, field.m_nStaticMetadataCount );
-			ReadMemberSchemaType( member_traits, field.m_pType );
-		}
-	}
-	else
+	auto parent_type = FindSchemaTypeInTypeScopes( class_scoping[class_scoping.Count() - 2] );
+
+	if(!parent_type)
 	{
-		members->SetArrayElementCount( 0 );
+		if(IsVerboseLogging())
+			META_CONPRINTF( "Failed to find parent scope class for \"%s\".\n", type->m_sTypeName.Get() );
+
+		return SR_MISSING_PARENT_SCOPE;
 	}
 
-	return idx;
+	return RequestTypeMapEntry( parent_type );
 }
 
-int SchemaReader::ReadDeclEnum( CSchemaType_DeclaredEnum *type )
+void SchemaReader::CollectTypeEdges( int idx, std::vector<SchemaTypeEdge> &edges )
 {
-	auto [def, idx] = CreateDefEntry( type );
+	auto &node = m_Types[idx];
 
-	if(!def)
-		return idx;
+	if(node.m_ParentScopeIdx >= 0)
+		edges.push_back( { node.m_ParentScopeIdx, SR_EDGE_PARENT_SCOPE } );
 
-	auto traits = def->FindOrCreateMember( "traits" );
-	auto ci = type->m_pEnumInfo;
+	auto decl_class = node.m_pType->ReinterpretAs<CSchemaType_DeclaredClass>();
+	if(!decl_class || !decl_class->m_pClassInfo)
+		return;
 
-	LinkChildParentScopeDecls( traits, type, idx );
-	ReadFlags( traits, type );
+	auto ci = decl_class->m_pClassInfo;
 
-	if(ci)
+	for(int i = 0; i < ci->m_nBaseClassCount; i++)
+		edges.push_back( { FindTypeMapEntry( ci->m_pBaseClasses[i].m_pClass->m_pDeclaredClass ), SR_EDGE_BASE } );
+
+	std::vector<std::pair<CSchemaType *, SchemaTypeEdgeKind>> stack;
+	for(int i = 0; i < ci->m_nFieldCount; i++)
 	{
-		ReadMetaTags( traits, ci->m_pStaticMetadata, ci->m_nStaticMetadataCount );
+		// Kind is decided by the outermost indirection, so pointers to atomics stay pointers
+		stack.push_back( { ci->m_pFields[i].m_pType, SR_EDGE_MEMBER_VALUE } );
 
-		auto fields = traits->FindOrCreateMember( "fields" );
-		fields->SetArrayElementCount( ci->m_nEnumeratorCount );
-		for(int i = 0; i < ci->m_nEnumeratorCount; i++)
+		while(!stack.empty())
 		{
-			auto enumf = ci->m_pEnumerators[i];
-			auto field = fields->GetArrayElement( i );
+			auto [type, kind] = stack.back();
+			stack.pop_back();
+
+			switch(type->m_eTypeCategory)
+			{
+				case SCHEMA_TYPE_DECLARED_CLASS:
+				case SCHEMA_TYPE_DECLARED_ENUM:
+				{
+					edges.push_back( { FindTypeMapEntry( type ), kind } );
+					break;
+				}
+
+				case SCHEMA_TYPE_POINTER:
+				{
+					stack.push_back( { type->ReinterpretAs<CSchemaType_Ptr>()->GetInnerType().Get(), kind == SR_EDGE_MEMBER_VALUE ? SR_EDGE_MEMBER_PTR : kind } );
+					break;
+				}
+
+				case SCHEMA_TYPE_FIXED_ARRAY:
+				{
+					stack.push_back( { type->ReinterpretAs<CSchemaType_FixedArray>()->GetInnerType().Get(), kind } );
+					break;
+				}
+
+				case SCHEMA_TYPE_ATOMIC:
+				{
+					auto arg_kind = kind == SR_EDGE_MEMBER_VALUE ? SR_EDGE_ATOMIC_ARG : kind;
+
+					if(type->m_eAtomicCategory == SCHEMA_ATOMIC_T || type->m_eAtomicCategory == SCHEMA_ATOMIC_COLLECTION_OF_T)
+					{
+						stack.push_back( { type->ReinterpretAs<CSchemaType_Atomic_T>()->m_pTemplateType, arg_kind } );
+					}
+					else if(type->m_eAtomicCategory == SCHEMA_ATOMIC_TT)
+					{
+						auto atomic = type->ReinterpretAs<CSchemaType_Atomic_TT>();
 
-			field->SetMemberString( "name", enumf.m_pszName );
-			field->SetMemberInt64( "value", enumf.m_nValue );
+						stack.push_back( { atomic->m_pTemplateType2, arg_kind } );
+						stack.push_back( { atomic->m_pTemplateType, arg_kind } );
+					}
 
-			ReadMetaTags( field, enumf.m_pStaticMetadata, enumf.m_nStaticMetadataCount, true );
+					break;
+				}
+			}
 		}
 	}
-	else
+
+	if(ci->m_nBaseClassCount <= 0)
+		return;
+
+	for(auto &meta : SchemaMetadataIterator( ci->m_pStaticMetadata, ci->m_nStaticMetadataCount ))
 	{
-		traits->FindOrCreateMember( "fields" )->SetArrayElementCount( 0 );
+		if(auto var_override = MNetworkVarTypeOverride::From( &meta ))
+		{
+			// Override targets are only collected when applying overrides, missing ones are skipped
+			if(auto var_ci = FindSchemaTypeInTypeScopes( var_override->Value().m_TypeName ))
+				edges.push_back( { FindTypeMapEntry( var_ci ), SR_EDGE_NETVAR_OVERRIDE } );
+		}
 	}
-
-	return idx;
 }
 
-void SchemaReader::ReadAtomicInfo( SchemaAtomicTypeInfo_t *info )
+void SchemaReader::DedupeProjectTypes()
 {
-	auto def = GetAtomicDefs()->ArrayAddElementToTail();
+	int count = (int)m_Types.size();
 
-	def->SetMemberString( "name", info->m_pszName );
-	def->SetMemberInt( "token", info->m_nAtomicID );
+	// Types start grouped by name and contents, builtins always stay on their own
+	std::map<std::pair<std::string_view, uint64>, int> content_groups;
+	std::vector<int> groups( count );
+	int group_count = 0;
 
-	ReadMetaTags( def, info->m_pStaticMetadata, info->m_nStaticMetadataCount, true );
-}
+	for(int i = 0; i < count; i++)
+	{
+		auto type = m_Types[i].m_pType;
 
-void SchemaReader::ReadMetaTags( KeyValues3 *root, SchemaMetadataEntryData_t *data, int count, bool append_traits )
-{
-	if(count <= 0 || !IsDumpingMetaTags())
-		return;
-	
-	if(append_traits)
-		root = root->FindOrCreateMember( "traits" );
+		if(type->m_eTypeCategory != SCHEMA_TYPE_DECLARED_CLASS && type->m_eTypeCategory != SCHEMA_TYPE_DECLARED_ENUM)
+		{
+			groups[i] = group_count++;
+			continue;
+		}
 
-	auto metatags = root->FindOrCreateMember( "metatags" );
-	metatags->SetArrayElementCount( count );
+		auto [iter, inserted] = content_groups.emplace( std::make_pair( std::string_view( type->m_sTypeName.Get() ), ComputeDedupeHash( type ) ), group_count );
+		if(inserted)
+			group_count++;
+
+		groups[i] = iter->second;
+	}
+
+	std::vector<int> edge_offsets( count + 1, 0 );
+	std::vector<SchemaTypeEdge> edges;
 
 	for(int i = 0; i < count; i++)
 	{
-		auto meta = data[i];
-		auto metatag = metatags->GetArrayElement( i );
+		CollectTypeEdges( i, edges );
+		edge_offsets[i + 1] = (int)edges.size();
+	}
 
-		metatag->SetMemberString( "name", meta.m_pszName );
+	// Merged defs share their references, so groups are split until every type of a group
+	// references the same groups, same named types of different projects can still differ
+	std::map<std::vector<int>, int> signatures;
+	std::vector<int> signature, next_groups( count );
 
-		std::string metavalue = SchemaMetadataToString::Eval( &meta );
-		if(!metavalue.empty())
-			metatag->SetMemberString( "value", metavalue.c_str() );
+	for(int prev_count = 0; prev_count != group_count;)
+	{
+		prev_count = group_count;
+		signatures.clear();
+
+		for(int i = 0; i < count; i++)
+		{
+			signature.clear();
+			signature.push_back( groups[i] );
+
+			for(int k = edge_offsets[i]; k < edge_offsets[i + 1]; k++)
+			{
+				int target = edges[k].m_TargetIdx;
+
+				signature.push_back( (int)edges[k].m_Kind );
+				signature.push_back( target >= 0 ? groups[target] : target );
+			}
+
+			auto [iter, inserted] = signatures.emplace( signature, (int)signatures.size() );
+			next_groups[i] = iter->second;
+		}
+
+		group_count = (int)signatures.size();
+		groups.swap( next_groups );
+	}
+
+	// First type of a group keeps its def, so the collection order is preserved
+	std::vector<int> group_defs( group_count, -1 ), new_idx( count );
+	std::vector<SchemaTypeNode> types;
+	types.reserve( group_count );
+
+	for(int i = 0; i < count; i++)
+	{
+		int &def_idx = group_defs[groups[i]];
+
+		if(def_idx < 0)
+		{
+			def_idx = (int)types.size();
+			types.push_back( std::move( m_Types[i] ) );
+		}
+		else
+		{
+			types[def_idx].m_MergedTypes.push_back( m_Types[i].m_pType );
+		}
+
+		new_idx[i] = def_idx;
 	}
+
+	for(auto &node : types)
+	{
+		if(node.m_ParentScopeIdx >= 0)
+			node.m_ParentScopeIdx = new_idx[node.m_ParentScopeIdx];
+	}
+
+	for(auto &[type, idx] : m_TypeMap)
+		idx = new_idx[idx];
+
+	m_Types = std::move( types );
+
+	META_CONPRINTF( "Merged %d types into defs of other projects.\n", count - (int)m_Types.size() );
 }
 
-void SchemaReader::ReadFlags( KeyValues3 *root, CSchemaType *type )
+void SchemaReader::SortSchemaTypesTopologically()
 {
-	if(auto class_decl = type->ReinterpretAs<CSchemaType_DeclaredClass>())
-	{
-		if(!class_decl->m_pClassInfo)
-			return;
+	int count = (int)m_Types.size();
 
-		auto class_flags = class_decl->m_pClassInfo->m_nFlags1;
+	// Dependencies and dependents of every type in a flat offset + list form
+	std::vector<int> dep_offsets( count + 1, 0 ), deps;
+	std::vector<int> in_degree( count, 0 );
+	std::vector<SchemaTypeEdge> edges;
 
-		if(class_flags == 0)
-			return;
+	for(int i = 0; i < count; i++)
+	{
+		size_t start = deps.size();
 
-		auto flags = root->FindOrCreateMember( "flags" );
-		static std::pair<uint32, const char *> s_FlagMap[] = {
-			{ SCHEMA_CF1_HAS_VIRTUAL_MEMBERS, "has_virtual_members" },
-			{ SCHEMA_CF1_IS_ABSTRACT, "is_abstract" },
-			{ SCHEMA_CF1_HAS_TRIVIAL_CONSTRUCTOR, "has_trivial_constructor" },
-			{ SCHEMA_CF1_HAS_TRIVIAL_DESTRUCTOR, "has_trivial_destructor" },
-			{ SCHEMA_CF1_LIMITED_METADATA, "limited_metadata" },
-			{ SCHEMA_CF1_INHERITANCE_DEPTH_CALCULATED, "inheritance_depth_calculated" },
-			{ SCHEMA_CF1_MODULE_LOCAL_TYPE_SCOPE, "local_type_scope" },
-			{ SCHEMA_CF1_GLOBAL_TYPE_SCOPE, "global_type_scope" },
-			{ SCHEMA_CF1_CONSTRUCT_ALLOWED, "construct_allowed" },
-			{ SCHEMA_CF1_CONSTRUCT_DISALLOWED, "construct_disallowed" },
-			{ SCHEMA_CF1_INFO_TAG_MNetworkAssumeNotNetworkable, "MNetworkAssumeNotNetworkable" },
-			{ SCHEMA_CF1_INFO_TAG_MNetworkNoBase, "MNetworkNoBase" },
-			{ SCHEMA_CF1_INFO_TAG_MIgnoreTypeScopeMetaChecks, "MIgnoreTypeScopeMetaChecks" },
-			{ SCHEMA_CF1_INFO_TAG_MDisableDataDescValidation, "MDisableDataDescValidation" },
-			{ SCHEMA_CF1_INFO_TAG_MClassHasEntityLimitedDataDesc, "MClassHasEntityLimitedDataDesc" },
-			{ SCHEMA_CF1_INFO_TAG_MClassHasCustomAlignedNewDelete, "MClassHasCustomAlignedNewDelete" },
-			{ SCHEMA_CF1_UNK016, "unk016" },
-			{ SCHEMA_CF1_INFO_TAG_MConstructibleClassBase, "MConstructibleClassBase" },
-			{ SCHEMA_CF1_INFO_TAG_MHasKV3TransferPolymorphicClassname, "MHasKV3TransferPolymorphicClassname" }
-		};
-
-		for(int i = 0; i < ARRAYSIZE( s_FlagMap ); i++)
-		{
-			if((class_flags & s_FlagMap[i].first) != 0)
-			{
-				flags->ArrayAddElementToTail()->SetString( s_FlagMap[i].second );
-				class_flags &= ~s_FlagMap[i].first;
-			}
+		// Only types that have to be complete at the point of use are dependencies
+		edges.clear();
+		CollectTypeEdges( i, edges );
+
+		for(auto &edge : edges)
+		{
+			if(edge.m_Kind == SR_EDGE_BASE || edge.m_Kind == SR_EDGE_MEMBER_VALUE)
+				deps.push_back( edge.m_TargetIdx );
 		}
 
-		char buf[64];
-		for(int i = 0; i < sizeof( class_flags ) * 8; i++)
+		std::sort( deps.begin() + start, deps.end() );
+		deps.erase( std::unique( deps.begin() + start, deps.end() ), deps.end() );
+		deps.erase( std::remove_if( deps.begin() + start, deps.end(), [i]( int dep ) { return dep == i || dep < 0; } ), deps.end() );
+
+		dep_offsets[i + 1] = (int)deps.size();
+		in_degree[i] = dep_offsets[i + 1] - dep_offsets[i];
+	}
+
+	std::vector<int> rev_offsets( count + 1, 0 ), rev_deps( deps.size() );
+
+	for(int dep : deps)
+		rev_offsets[dep + 1]++;
+
+	for(int i = 0; i < count; i++)
+		rev_offsets[i + 1] += rev_offsets[i];
+
+	std::vector<int> rev_fill( rev_offsets.begin(), rev_offsets.end() - 1 );
+	for(int i = 0; i < count; i++)
+	{
+		for(int k = dep_offsets[i]; k < dep_offsets[i + 1]; k++)
+			rev_deps[rev_fill[deps[k]]++] = i;
+	}
+
+	// Ready types are picked by their original index, so output stays close to the collection order
+	std::priority_queue<int, std::vector<int>, std::greater<int>> ready;
+	std::vector<int> order, cycle_breaks, walk_stamp( count, -1 );
+	std::vector<bool> placed( count, false );
+	order.reserve( count );
+
+	for(int i = 0; i < count; i++)
+	{
+		if(in_degree[i] == 0)
+			ready.push( i );
+	}
+
+	int unplaced_cursor = 0, walk_id = 0;
+	while((int)order.size() < count)
+	{
+		if(ready.empty())
 		{
-			if((class_flags & i) != 0)
+			// Everything left is either in a cycle or depends on one, walk unplaced
+			// dependencies from the lowest unplaced type until a type repeats, which lies on a cycle
+			while(placed[unplaced_cursor])
+				unplaced_cursor++;
+
+			int current = unplaced_cursor;
+			walk_id++;
+
+			while(walk_stamp[current] != walk_id)
 			{
-				std::snprintf( buf, sizeof( buf ), "UNKNOWN_BIT_%d", i );
-				flags->ArrayAddElementToTail()->SetString( buf );
+				walk_stamp[current] = walk_id;
 
-				if(IsVerboseLogging())
+				for(int k = dep_offsets[current]; k < dep_offsets[current + 1]; k++)
 				{
-					META_CONPRINTF( "Found unknown flag bit %d for class (%s)\n", i, type->m_sTypeName.Get() );
+					if(!placed[deps[k]])
+					{
+						current = deps[k];
+						break;
+					}
 				}
 			}
+
+			if(IsVerboseLogging())
+				META_CONPRINTF( "Breaking dependency cycle at \"%s\".\n", m_Types[current].m_pType->m_sTypeName.Get() );
+
+			cycle_breaks.push_back( current );
+			in_degree[current] = 0;
+			ready.push( current );
+		}
+
+		int idx = ready.top();
+		ready.pop();
+
+		if(placed[idx])
+			continue;
+
+		placed[idx] = true;
+		order.push_back( idx );
+
+		for(int k = rev_offsets[idx]; k < rev_offsets[idx + 1]; k++)
+		{
+			if(--in_degree[rev_deps[k]] == 0)
+				ready.push( rev_deps[k] );
 		}
 	}
-	else if(auto enum_decl = type->ReinterpretAs<CSchemaType_DeclaredEnum>())
+
+	std::vector<int> new_idx( count );
+	std::vector<SchemaTypeNode> types;
+	types.reserve( count );
+
+	for(int i = 0; i < count; i++)
 	{
-		if(!enum_decl->m_pEnumInfo)
-			return;
+		new_idx[order[i]] = i;
+		types.push_back( m_Types[order[i]] );
+	}
 
-		auto enum_flags = enum_decl->m_pEnumInfo->m_nFlags;
+	for(auto &node : types)
+	{
+		if(node.m_ParentScopeIdx >= 0)
+			node.m_ParentScopeIdx = new_idx[node.m_ParentScopeIdx];
+	}
 
-		if(enum_flags == 0)
-			return;
+	// Merged types aren't part of the nodes, so the whole map is remapped
+	for(auto &[type, idx] : m_TypeMap)
+		idx = new_idx[idx];
+
+	m_Types = std::move( types );
+
+	auto breaks = GetRoots().Where( SR_TOPO_ORDER ).FindOrCreateMember( "topo_cycle_breaks" );
+	breaks.SetToEmptyArray();
+
+	for(int idx : cycle_breaks)
+		breaks.ArrayAddElementToTail().SetInt( new_idx[idx] );
+
+	if(!cycle_breaks.empty())
+		META_CONPRINTF( "Broke %d dependency cycles while ordering types.\n", (int)cycle_breaks.size() );
+}
+
+void SchemaReader::ReadHierarchy()
+{
+	META_CONPRINTF( "Reading class hierarchy...\n" );
+
+	int count = (int)m_Types.size();
+
+	auto get_class_info = [this]( int idx ) -> SchemaClassInfoData_t * {
+		auto decl_class = m_Types[idx].m_pType->ReinterpretAs<CSchemaType_DeclaredClass>();
+		return decl_class ? decl_class->m_pClassInfo : nullptr;
+	};
+
+	// First base class is the primary one, primary bases make up the single inheritance tree
+	std::vector<int> parents( count, -1 ), child_offsets( count + 1, 0 ), children;
+
+	for(int i = 0; i < count; i++)
+	{
+		auto ci = get_class_info( i );
+		if(ci && ci->m_nBaseClassCount > 0)
+			parents[i] = FindTypeMapEntry( ci->m_pBaseClasses[0].m_pClass->m_pDeclaredClass );
+
+		if(parents[i] >= 0)
+			child_offsets[parents[i] + 1]++;
+	}
+
+	for(int i = 0; i < count; i++)
+		child_offsets[i + 1] += child_offsets[i];
+
+	children.resize( child_offsets[count] );
+	std::vector<int> child_fill( child_offsets.begin(), child_offsets.end() - 1 );
+
+	for(int i = 0; i < count; i++)
+	{
+		if(parents[i] >= 0)
+			children[child_fill[parents[i]]++] = i;
+	}
+
+	// Class b is a primary base of class a when pre[b] <= pre[a] <= post[b]
+	std::vector<int> pre( count, -1 ), post( count, -1 );
+	std::vector<std::pair<int, int>> stack;
+	int counter = 0;
+
+	for(int root = 0; root < count; root++)
+	{
+		if(parents[root] >= 0 || m_Types[root].m_pType->m_eTypeCategory != SCHEMA_TYPE_DECLARED_CLASS)
+			continue;
 
-		auto flags = root->FindOrCreateMember( "flags" );
-		static std::pair<uint32, const char *> s_FlagMap[] = {
-			{ SCHEMA_EF_IS_REGISTERED, "is_registered" },
-			{ SCHEMA_EF_MODULE_LOCAL_TYPE_SCOPE, "local_type_scope" },
-			{ SCHEMA_EF_GLOBAL_TYPE_SCOPE, "global_type_scope" }
-		};
+		pre[root] = counter++;
+		stack.push_back( { root, child_offsets[root] } );
 
-		for(int i = 0; i < ARRAYSIZE( s_FlagMap ); i++)
+		while(!stack.empty())
 		{
-			if((enum_flags & s_FlagMap[i].first) != 0)
+			auto &[idx, cursor] = stack.back();
+
+			if(cursor < child_offsets[idx + 1])
+			{
+				int child = children[cursor++];
+
+				pre[child] = counter++;
+				stack.push_back( { child, child_offsets[child] } );
+			}
+			else
 			{
-				flags->ArrayAddElementToTail()->SetString( s_FlagMap[i].second );
-				enum_flags &= ~s_FlagMap[i].first;
+				post[idx] = counter - 1;
+				stack.pop_back();
 			}
 		}
+	}
+
+	auto is_interval_base = [&pre, &post]( int idx, int base ) {
+		return pre[base] <= pre[idx] && pre[idx] <= post[base];
+	};
+
+	// Ancestors not covered by the interval, which are the ones reached through secondary bases,
+	// bases are resolved first as inheritance depth is small
+	std::vector<std::vector<int>> extra( count );
+	std::vector<bool> resolved( count, false );
+
+	auto resolve_extra = [&]( auto &self, int idx ) -> void {
+		if(resolved[idx])
+			return;
+
+		resolved[idx] = true;
+
+		auto ci = get_class_info( idx );
+		if(!ci || ci->m_nBaseClassCount <= 0)
+			return;
+
+		auto &result = extra[idx];
 
-		char buf[64];
-		for(int i = 0; i < sizeof( enum_flags ) * 8; i++)
+		for(int i = 0; i < ci->m_nBaseClassCount; i++)
 		{
-			if((enum_flags & i) != 0)
-			{
-				std::snprintf( buf, sizeof( buf ), "UNKNOWN_BIT_%d", i );
-				flags->ArrayAddElementToTail()->SetString( buf );
+			int base = FindTypeMapEntry( ci->m_pBaseClasses[i].m_pClass->m_pDeclaredClass );
+			if(base < 0)
+				continue;
 
-				if(IsVerboseLogging())
-				{
-					META_CONPRINTF( "Found unknown flag bit %d for enum (%s)\n", i, type->m_sTypeName.Get() );
-				}
-			}
+			self( self, base );
+			result.insert( result.end(), extra[base].begin(), extra[base].end() );
+
+			// Secondary base and its primary chain aren't covered by the interval either
+			for(int k = i > 0 ? base : -1; k >= 0; k = parents[k])
+				result.push_back( k );
 		}
+
+		std::sort( result.begin(), result.end() );
+		result.erase( std::unique( result.begin(), result.end() ), result.end() );
+		result.erase( std::remove_if( result.begin(), result.end(), [&]( int base ) { return is_interval_base( idx, base ); } ), result.end() );
+	};
+
+	std::vector<bool> needs_bit( count, false );
+	for(int i = 0; i < count; i++)
+	{
+		resolve_extra( resolve_extra, i );
+
+		for(int base : extra[i])
+			needs_bit[base] = true;
 	}
-}
 
-template<typename METATAG>
-inline void SchemaReader::ReadPulseDomains( KeyValues3 *root, std::map<std::string, KeyValues3 *> &domains )
-{
-	CUtlVector<const CSchemaClassInfo *> classes;
-	SchemaSystem()->FindClassesByMeta( METATAG::Tag(), SCHEMA_ITER_MULTI_PARENT, &classes );
+	// Bits are only given to classes some other class reaches through a secondary base
+	std::vector<int> bits( count, -1 );
+	int bit_count = 0;
 
-	for(int i = 0; i < classes.Count(); i++)
+	for(int i = 0; i < count; i++)
 	{
-		auto ci = classes[i];
+		if(needs_bit[i])
+			bits[i] = bit_count++;
+	}
 
-		if(auto metatag = SchemaMetadataIterator( ci->m_pStaticMetadata, ci->m_nStaticMetadataCount ).FindTag( METATAG::Tag() ))
-		{
-			if(auto meta_binding = METATAG::From( metatag ))
-			{
-				if(auto binding = meta_binding->Value())
-				{
-					auto iter = domains.find( binding->m_Name.Get() );
-					KeyValues3 *domain;
+	std::vector<int> words;
+	for(int i = 0; i < count; i++)
+	{
+		if(pre[i] < 0)
+			continue;
 
-					if(iter == domains.end())
-					{
-						domain = domains.emplace( binding->m_Name.Get(), root->ArrayAddElementToTail() ).first->second;
+		auto isa = FindDefEntry( i ).Where( SR_DUMP_HIERARCHY ).FindOrCreateMember( "isa" );
 
-						domain->SetMemberString( "name", binding->m_Name );
-					}
-					else
-						domain = iter->second;
-					
-					bool created = false;
-					auto cpp_scopes = domain->FindOrCreateMember( "cpp_scopes", &created );
+		isa.SetMemberInt( "pre", pre[i] );
+		isa.SetMemberInt( "post", post[i] );
 
-					if(created)
-						cpp_scopes->SetToEmptyArray();
+		if(bits[i] >= 0)
+			isa.SetMemberInt( "bit", bits[i] );
 
-					KeyValues3 *functions = nullptr;
-					for(int k = 0; k < cpp_scopes->GetArrayElementCount(); k++)
-					{
-						auto scope = cpp_scopes->GetArrayElement( k );
-						
-						if(std::strcmp( scope->GetMemberString( "name" ), ci->m_pszName ) == 0)
-						{
-							functions = scope->FindOrCreateMember( "functions" );
-							break;
-						}
-					}
+		if(extra[i].empty())
+			continue;
 
-					if(!functions)
-					{
-						auto scope = cpp_scopes->ArrayAddElementToTail();
-						scope->SetMemberString( "name", ci->m_pszName );
-						functions = scope->FindOrCreateMember( "functions" );
-						functions->SetToEmptyArray();
-					}
+		words.clear();
+		for(int base : extra[i])
+		{
+			if((int)words.size() <= bits[base] / 32)
+				words.resize( bits[base] / 32 + 1, 0 );
 
-					ReadPulseDomianFunctions( functions, binding->m_Functions, binding->m_FunctionCount );
-					ReadPulseDomianFunctions( functions, binding->m_EventFunctions, binding->m_EventFunctionCount );
-				}
-			}
+			words[bits[base] / 32] |= (int)(1u << (bits[base] % 32));
 		}
+
+		isa.FindOrCreateMember( "bits" ).SetIntArray( words.data(), (int)words.size() );
 	}
+
+	if(IsVerboseLogging())
+		META_CONPRINTF( "Labeled %d classes, %d of them are reachable through secondary bases.\n", counter, bit_count );
 }
 
-template <typename DOMAIN_FUNCTION>
-void SchemaReader::ReadPulseDomianFunctions( KeyValues3 *root, DOMAIN_FUNCTION *functions, int count )
+void SchemaReader::ReadTypeGraph()
 {
+	auto graph = GetRoots().Where( SR_DUMP_GRAPH ).FindOrCreateMember( "graph" );
+	if(graph.IsEmpty())
+		return;
+
+	META_CONPRINTF( "Reading type graph...\n" );
+
+	int count = (int)m_Types.size();
+
+	// Edges are stored as flat (target, kind) pairs with per type offsets
+	std::vector<int> out_offsets( count + 1, 0 ), out_edges;
+	std::vector<SchemaTypeEdge> edges;
+
 	for(int i = 0; i < count; i++)
 	{
-		auto func = root->ArrayAddElementToTail();
-		auto &func_binding = functions[i];
+		edges.clear();
+		CollectTypeEdges( i, edges );
 
-		func->SetMemberString( "name", func_binding.m_Name.Get() );
-		func->SetMemberString( "library_name", func_binding.m_LibraryName.Get() );
-		func->SetMemberString( "description", func_binding.m_Description.Get() );
+		std::sort( edges.begin(), edges.end(), []( const SchemaTypeEdge &a, const SchemaTypeEdge &b ) {
+			return a.m_TargetIdx != b.m_TargetIdx ? a.m_TargetIdx < b.m_TargetIdx : a.m_Kind < b.m_Kind;
+		} );
 
-		if constexpr (std::is_same_v<DOMAIN_FUNCTION, CPulseLibraryEventFunction>)
-			func->SetMemberString( "type", "event" );
-		else
-			func->SetMemberString( "type", "plain" );
+		for(size_t k = 0; k < edges.size(); k++)
+		{
+			if(edges[k].m_TargetIdx < 0 || (k > 0 && edges[k].m_TargetIdx == edges[k - 1].m_TargetIdx && edges[k].m_Kind == edges[k - 1].m_Kind))
+				continue;
 
-		auto params = func->FindOrCreateMember( "params" );
-		params->SetToEmptyArray();
+			out_edges.push_back( edges[k].m_TargetIdx );
+			out_edges.push_back( edges[k].m_Kind );
+		}
 
-		if(func_binding.m_Params)
-		{
-			auto binding_params = func_binding.m_Params();
-			for(int i = 0; i < func_binding.m_ParamCount; i++)
-			{
-				auto &binding_param = binding_params[i];
-				auto param = params->ArrayAddElementToTail();
+		out_offsets[i + 1] = (int)out_edges.size() / 2;
+	}
 
-				param->SetMemberString( "name", binding_param.m_Name.GetString() );
-				param->SetMemberString( "type", binding_param.m_TypeDesc.ToString().c_str() );
+	std::vector<int> in_offsets( count + 1, 0 ), in_edges( out_edges.size() );
 
-				if(binding_param.HasDefaultValue())
-					param->SetMemberString( "default_value", binding_param.DefaultValueToString().c_str() );
+	for(size_t k = 0; k < out_edges.size(); k += 2)
+		in_offsets[out_edges[k] + 1]++;
 
-				ReadMetaTags( param, binding_param.m_StaticMetadata, binding_param.m_StaticMetadataCount, true );
-			}
+	for(int i = 0; i < count; i++)
+		in_offsets[i + 1] += in_offsets[i];
+
+	std::vector<int> in_fill( in_offsets.begin(), in_offsets.end() - 1 );
+	for(int i = 0; i < count; i++)
+	{
+		for(int k = out_offsets[i]; k < out_offsets[i + 1]; k++)
+		{
+			int pos = in_fill[out_edges[k * 2]]++;
+
+			in_edges[pos * 2] = i;
+			in_edges[pos * 2 + 1] = out_edges[k * 2 + 1];
 		}
+	}
 
-		auto rets = func->FindOrCreateMember( "rets" );
-		rets->SetToEmptyArray();
+	// Iterative tarjan, every frame keeps the type and its next edge to visit
+	std::vector<int> tin( count, -1 ), low( count, 0 ), scc_stack, sccs_offsets( 1, 0 ), sccs;
+	std::vector<bool> on_stack( count, false );
+	std::vector<std::pair<int, int>> frames;
+	int timer = 0;
 
-		if(func_binding.m_Rets)
-		{
-			auto binding_rets = func_binding.m_Rets();
-			for(int i = 0; i < func_binding.m_RetCount; i++)
-			{
-				auto &binding_ret = binding_rets[i];
-				auto ret = rets->ArrayAddElementToTail();
+	for(int root = 0; root < count; root++)
+	{
+		if(tin[root] != -1)
+			continue;
 
-				ret->SetMemberString( "name", binding_ret.m_Name.GetString() );
-				ret->SetMemberString( "type", binding_ret.m_TypeDesc.ToString().c_str() );
+		frames.push_back( { root, out_offsets[root] } );
+		tin[root] = low[root] = timer++;
+		scc_stack.push_back( root );
+		on_stack[root] = true;
 
-				if(binding_ret.HasDefaultValue())
-					ret->SetMemberString( "default_value", binding_ret.DefaultValueToString().c_str() );
+		while(!frames.empty())
+		{
+			auto &[v, edge] = frames.back();
 
-				ReadMetaTags( ret, binding_ret.m_StaticMetadata, binding_ret.m_StaticMetadataCount, true );
-			}
-		}
+			if(edge < out_offsets[v + 1])
+			{
+				int to = out_edges[edge * 2];
+				edge++;
 
-		ReadMetaTags( func, func_binding.m_StaticMetadata, func_binding.m_StaticMetadataCount, true );
+				if(tin[to] == -1)
+				{
+					tin[to] = low[to] = timer++;
+					scc_stack.push_back( to );
+					on_stack[to] = true;
+					frames.push_back( { to, out_offsets[to] } );
+				}
+				else if(on_stack[to])
+				{
+					low[v] = (std::min)( low[v], tin[to] );
+				}
+
+				continue;
+			}
+
+			int done = v;
+			frames.pop_back();
+
+			if(!frames.empty())
+				low[frames.back().first] = (std::min)( low[frames.back().first], low[done] );
+
+			if(low[done] != tin[done])
+				continue;
+
+			size_t start = sccs.size();
+			int member;
+			do
+			{
+				member = scc_stack.back();
+				scc_stack.pop_back();
+				on_stack[member] = false;
+				sccs.push_back( member );
+			} while(member != done);
+
+			// Only components that actually form a cycle are of interest
+			if(sccs.size() - start > 1)
+			{
+				std::sort( sccs.begin() + start, sccs.end() );
+				sccs_offsets.push_back( (int)sccs.size() );
+			}
+			else
+			{
+				sccs.resize( start );
+			}
+		}
+	}
+
+	auto edge_kinds = graph.FindOrCreateMember( "edge_kinds" );
+	edge_kinds.SetToEmptyArray();
+	for(auto name : g_EdgeKindNames)
+		edge_kinds.ArrayAddElementToTail().SetString( name );
+
+	graph.FindOrCreateMember( "out_offsets" ).SetIntArray( out_offsets.data(), (int)out_offsets.size() );
+	graph.FindOrCreateMember( "out_edges" ).SetIntArray( out_edges.data(), (int)out_edges.size() );
+	graph.FindOrCreateMember( "in_offsets" ).SetIntArray( in_offsets.data(), (int)in_offsets.size() );
+	graph.FindOrCreateMember( "in_edges" ).SetIntArray( in_edges.data(), (int)in_edges.size() );
+	graph.FindOrCreateMember( "scc_offsets" ).SetIntArray( sccs_offsets.data(), (int)sccs_offsets.size() );
+	graph.FindOrCreateMember( "sccs" ).SetIntArray( sccs.data(), (int)sccs.size() );
+}
+
+void SchemaReader::BuildFlattenedLayout( int idx, std::vector<std::vector<FlattenedField>> &layouts )
+{
+	auto decl_class = m_Types[idx].m_pType->ReinterpretAs<CSchemaType_DeclaredClass>();
+	if(!decl_class || !decl_class->m_pClassInfo)
+		return;
+
+	auto ci = decl_class->m_pClassInfo;
+	auto &layout = layouts[idx];
+
+	for(int i = 0; i < ci->m_nBaseClassCount; i++)
+	{
+		int base_idx = FindTypeMapEntry( ci->m_pBaseClasses[i].m_pClass->m_pDeclaredClass );
+		if(base_idx == -1)
+			continue;
+
+		for(auto field : layouts[base_idx])
+		{
+			field.m_nOffset += ci->m_pBaseClasses[i].m_nOffset;
+			layout.push_back( field );
+		}
+	}
+
+	std::vector<SchemaBitfieldPlacement> bitfields;
+	ResolveBitfieldPlacements( ci, bitfields );
+
+	for(int i = 0; i < ci->m_nFieldCount; i++)
+	{
+		auto &field = ci->m_pFields[i];
+
+		if(field.m_pType->m_eTypeCategory != SCHEMA_TYPE_BITFIELD)
+		{
+			layout.push_back( { field.m_pszName, field.m_nSingleInheritanceOffset, idx, i } );
+			continue;
+		}
+
+		auto &placement = bitfields[i];
+		if(placement.m_nUnitSize > 0)
+			layout.push_back( { field.m_pszName, placement.m_nStorageOffset, idx, i, placement.m_nUnitSize, placement.m_nShift } );
+		else
+			layout.push_back( { field.m_pszName, 0, idx, i, SR_UNPLACED_BITFIELD } );
+	}
+}
+
+void SchemaReader::BuildFlattenedLayouts( std::vector<std::vector<FlattenedField>> &layouts )
+{
+	META_CONPRINTF( "Flattening class layouts...\n" );
+
+	int count = (int)m_Types.size();
+	layouts.assign( count, {} );
+	std::vector<bool> built( count, false );
+
+	// Post order walk over base classes, every frame is a type and whether its bases were pushed already
+	std::vector<std::pair<int, bool>> stack;
+
+	for(int i = 0; i < count; i++)
+	{
+		stack.push_back( { i, false } );
+
+		while(!stack.empty())
+		{
+			auto [idx, expanded] = stack.back();
+
+			if(built[idx])
+			{
+				stack.pop_back();
+				continue;
+			}
+
+			auto decl_class = m_Types[idx].m_pType->ReinterpretAs<CSchemaType_DeclaredClass>();
+
+			if(!expanded && decl_class && decl_class->m_pClassInfo)
+			{
+				stack.back().second = true;
+
+				auto ci = decl_class->m_pClassInfo;
+				for(int k = 0; k < ci->m_nBaseClassCount; k++)
+				{
+					int base_idx = FindTypeMapEntry( ci->m_pBaseClasses[k].m_pClass->m_pDeclaredClass );
+					if(base_idx != -1 && !built[base_idx])
+						stack.push_back( { base_idx, false } );
+				}
+
+				continue;
+			}
+
+			stack.pop_back();
+			BuildFlattenedLayout( idx, layouts );
+			built[idx] = true;
+		}
+	}
+}
+
+void SchemaReader::ReadFlattenedLayouts( const std::vector<std::vector<FlattenedField>> &layouts )
+{
+	auto flattened = GetRoots().Where( SR_DUMP_FLATTENED ).FindOrCreateMember( "flattened" );
+	if(flattened.IsEmpty())
+		return;
+
+	int count = (int)layouts.size();
+	flattened.SetArrayElementCount( count );
+
+	for(int i = 0; i < count; i++)
+	{
+		auto fields = flattened.GetArrayElement( i );
+		fields.SetArrayElementCount( (int)layouts[i].size() );
+
+		for(int k = 0; k < (int)layouts[i].size(); k++)
+		{
+			auto &field = layouts[i][k];
+			auto entry = fields.GetArrayElement( k );
+
+			entry.SetMemberString( "name", field.m_pszName );
+			entry.SetMemberInt( "origin_idx", field.m_OriginIdx );
+			entry.SetMemberInt( "member_idx", field.m_MemberIdx );
+
+			// Bitfields have no offset in schema, placed ones are located by their inferred storage unit instead
+			if(field.m_nBitfieldUnitSize == 0)
+			{
+				entry.SetMemberInt( "offset", field.m_nOffset );
+			}
+			else if(field.m_nBitfieldUnitSize != SR_UNPLACED_BITFIELD)
+			{
+				entry.SetMemberInt( "storage_offset", field.m_nOffset );
+				entry.SetMemberInt( "unit_size", field.m_nBitfieldUnitSize );
+				entry.SetMemberInt( "shift", field.m_nBitfieldShift );
+			}
+		}
+	}
+}
+
+static bool HasReadableClassMetadata( SchemaClassInfoData_t *ci )
+{
+	// Ugly hack to prevent stringifying corrupted kv3 getter in that class,
+	// otherwise it'll crash when attempted to be retrieved
+	return std::strcmp( ci->m_pszName, "CastSphereSATParams_t" ) != 0 &&
+		std::strcmp( ci->m_pszName, "fogplayerparams_t" ) != 0 &&
+		// This one outputs corrupted string symbols (mostly just pure data bytes of something)
+		// which will trip json parsers later
+		std::strcmp( ci->m_pszName, "modifiedconvars_t" ) != 0;
+}
+
+static int GetFieldStorageSize( SchemaClassFieldData_t *field )
+{
+	if(field->m_pType->m_eTypeCategory == SCHEMA_TYPE_BITFIELD)
+		return (field->m_pType->ReinterpretAs<CSchemaType_Bitfield>()->m_nBitfieldCount + 7) / 8;
+
+	int size;
+	uint8 alignment;
+	field->m_pType->GetSizeAndAlignment( size, alignment );
+
+	return size;
+}
+
+static bool IsNetworkedField( SchemaClassFieldData_t *field )
+{
+	SchemaMetadataIterator metadata( field->m_pStaticMetadata, field->m_nStaticMetadataCount );
+	return metadata.FindTag( MNetworkEnable::Tag() ) && !metadata.FindTag( MNetworkDisable::Tag() );
+}
+
+SchemaClassFieldData_t *SchemaReader::FindFlattenedFieldData( const FlattenedField &flat_field ) const
+{
+	auto origin = m_Types[flat_field.m_OriginIdx].m_pType->ReinterpretAs<CSchemaType_DeclaredClass>();
+	return &origin->m_pClassInfo->m_pFields[flat_field.m_MemberIdx];
+}
+
+void SchemaReader::ReadLayoutReports( const std::vector<std::vector<FlattenedField>> &layouts )
+{
+	META_CONPRINTF( "Analyzing class layouts...\n" );
+
+	std::vector<SchemaLayoutField> fields;
+
+	for(int i = 0; i < (int)layouts.size(); i++)
+	{
+		auto decl_class = m_Types[i].m_pType->ReinterpretAs<CSchemaType_DeclaredClass>();
+		if(!decl_class || !decl_class->m_pClassInfo || layouts[i].empty())
+			continue;
+
+		bool approximate = false;
+
+		fields.clear();
+		for(auto &flat_field : layouts[i])
+		{
+			auto field = FindFlattenedFieldData( flat_field );
+
+			// Bitfields occupy their whole storage unit, unknown units can't be accounted at all
+			if(flat_field.m_nBitfieldUnitSize == SR_UNPLACED_BITFIELD)
+				approximate = true;
+			else if(flat_field.m_nBitfieldUnitSize > 0)
+				AddSchemaBitfieldUnit( fields, flat_field.m_pszName, flat_field.m_nOffset, flat_field.m_nBitfieldUnitSize, IsNetworkedField( field ) );
+			else
+				fields.push_back( { flat_field.m_pszName, flat_field.m_nOffset, GetFieldStorageSize( field ), IsNetworkedField( field ) } );
+		}
+
+		int size;
+		uint8 alignment;
+		decl_class->GetSizeAndAlignment( size, alignment );
+
+		m_LayoutReports.push_back( { i, size, AnalyzeSchemaLayout( size, fields ), approximate } );
+	}
+
+	std::stable_sort( m_LayoutReports.begin(), m_LayoutReports.end(), []( const ClassLayoutReport &a, const ClassLayoutReport &b ) {
+		return a.m_Report.m_nWastedBytes > b.m_Report.m_nWastedBytes;
+	} );
+}
+
+// Network var overrides of a class and its base chain by field name, overrides of the most derived class win.
+// Type overrides map to the new type name, property overrides to the name of the class declaring the field
+static void CollectNetOverrides( SchemaClassInfoData_t *ci, std::unordered_map<std::string_view, const char *> &type_overrides,
+								 std::unordered_map<std::string_view, const char *> &property_overrides )
+{
+	for(; ci; ci = ci->m_nBaseClassCount > 0 ? ci->m_pBaseClasses[0].m_pClass : nullptr)
+	{
+		for(auto &meta : SchemaMetadataIterator( ci->m_pStaticMetadata, ci->m_nStaticMetadataCount ))
+		{
+			if(auto var_override = MNetworkVarTypeOverride::From( &meta ))
+			{
+				if(var_override->Value().m_FieldName && var_override->Value().m_TypeName)
+					type_overrides.try_emplace( var_override->Value().m_FieldName, var_override->Value().m_TypeName );
+			}
+			else if(auto net_override = MNetworkOverride::From( &meta ))
+			{
+				if(net_override->Value().m_FieldName)
+					property_overrides.try_emplace( net_override->Value().m_FieldName, net_override->Value().m_TypeName );
+			}
+		}
+	}
+}
+
+void SchemaReader::ReadNetReports( const std::vector<std::vector<FlattenedField>> &layouts )
+{
+	META_CONPRINTF( "Analyzing networked footprint...\n" );
+
+	std::unordered_map<std::string_view, const char *> type_overrides, property_overrides;
+	std::unordered_set<std::string_view> own_networked;
+
+	for(int i = 0; i < (int)layouts.size(); i++)
+	{
+		auto decl_class = m_Types[i].m_pType->ReinterpretAs<CSchemaType_DeclaredClass>();
+		if(!decl_class || !decl_class->m_pClassInfo)
+			continue;
+
+		auto ci = decl_class->m_pClassInfo;
+
+		type_overrides.clear();
+		property_overrides.clear();
+		own_networked.clear();
+		CollectNetOverrides( ci, type_overrides, property_overrides );
+
+		ClassNetReport report = { i };
+		auto &total = report.m_Total;
+
+		for(auto &flat_field : layouts[i])
+		{
+			auto field = FindFlattenedFieldData( flat_field );
+			if(!IsNetworkedField( field ))
+				continue;
+
+			// Own fields are accounted separately so aggregates don't count inherited fields per every subclass
+			bool inherited = flat_field.m_OriginIdx != i;
+			int size = GetFieldStorageSize( field );
+
+			if(!inherited)
+				own_networked.insert( field->m_pszName );
+
+			// Retyped fields are sent as the override type, so size them by it
+			auto type_override = type_overrides.find( field->m_pszName );
+			if(type_override != type_overrides.end())
+			{
+				if(auto override_type = FindSchemaTypeInTypeScopes( type_override->second ))
+				{
+					size = GetTypeAttributes( override_type ).m_nSize;
+					report.m_nTypeOverriddenFields++;
+				}
+				else if(IsVerboseLogging())
+				{
+					META_CONPRINTF( "Failed to find type override (%s) of field (%s) for net report of class (%s)\n", type_override->second, field->m_pszName, ci->m_pszName );
+				}
+			}
+
+			auto property_override = property_overrides.find( field->m_pszName );
+			if(inherited && property_override != property_overrides.end()
+			   && (!property_override->second || std::strcmp( property_override->second, m_Types[flat_field.m_OriginIdx].m_pType->m_sTypeName.Get() ) == 0))
+			{
+				report.m_nPropertyOverriddenFields++;
+			}
+
+			total.m_nFields++;
+			total.m_nBytes += size;
+
+			if(inherited)
+				report.m_nInheritedFields++;
+			else
+			{
+				report.m_Own.m_nFields++;
+				report.m_Own.m_nBytes += size;
+			}
+
+			for(auto &meta : SchemaMetadataIterator( field->m_pStaticMetadata, field->m_nStaticMetadataCount ))
+			{
+				if(MNetworkChangeCallback::From( &meta ))
+				{
+					total.m_nChangeCallbacks++;
+
+					if(!inherited)
+						report.m_Own.m_nChangeCallbacks++;
+				}
+				else if(auto encoder = MNetworkEncoder::From( &meta ))
+				{
+					total.m_Encoders[encoder->Value()]++;
+
+					if(!inherited)
+						report.m_Own.m_Encoders[encoder->Value()]++;
+				}
+			}
+		}
+
+		// Var names should all be backed by declared networked fields, the ones that aren't
+		// can't be sized and are listed instead
+		for(auto &meta : SchemaMetadataIterator( ci->m_pStaticMetadata, ci->m_nStaticMetadataCount ))
+		{
+			if(auto var_name = MNetworkVarNames::From( &meta ))
+			{
+				report.m_nVarNames++;
+
+				if(var_name->Value().m_FieldName && !own_networked.count( var_name->Value().m_FieldName ))
+					report.m_UnmatchedVarNames.emplace_back( var_name->Value().m_FieldName );
+			}
+		}
+
+		if(total.m_nFields == 0 && report.m_nVarNames == 0)
+			continue;
+
+		report.m_Own.m_nClasses = total.m_nClasses = 1;
+		m_NetReports.push_back( std::move( report ) );
+	}
+
+	std::stable_sort( m_NetReports.begin(), m_NetReports.end(), []( const ClassNetReport &a, const ClassNetReport &b ) {
+		return a.m_Total.m_nBytes > b.m_Total.m_nBytes;
+	} );
+}
+
+void SchemaReader::ReadSchemaTypes()
+{
+	META_CONPRINTF( "Reading %d types...\n", (int)m_Types.size() );
+
+	// Every index is known at this point, so contents are filled in index order
+	// and references never need to recurse into other types
+	GetDefs().SetArrayElementCount( (int)m_Types.size() );
+
+	// Kv3 arena has no reserve of its own, so arrays that get appended to are sized up front instead
+	for(auto &node : m_Types)
+	{
+		if(node.m_ParentScopeIdx >= 0)
+			m_Types[node.m_ParentScopeIdx].m_nChildScopeCount++;
+	}
+
+	for(int i = 0; i < (int)m_Types.size(); i++)
+	{
+		auto type = m_Types[i].m_pType;
+
+		switch(type->m_eTypeCategory)
+		{
+			case SCHEMA_TYPE_BUILTIN:
+				CreateDefEntry( type->ReinterpretAs<CSchemaType_Builtin>(), i );
+				break;
+
+			case SCHEMA_TYPE_DECLARED_CLASS:
+				ReadDeclClass( type->ReinterpretAs<CSchemaType_DeclaredClass>(), i );
+				break;
+
+			case SCHEMA_TYPE_DECLARED_ENUM:
+				ReadDeclEnum( type->ReinterpretAs<CSchemaType_DeclaredEnum>(), i );
+				break;
+		}
+	}
+
+	// Overrides patch members of base classes, so only apply them once every def is filled in
+	if(IsApplyingNetVarOverrides())
+	{
+		for(auto &node : m_Types)
+		{
+			if(auto decl_class = node.m_pType->ReinterpretAs<CSchemaType_DeclaredClass>())
+				ApplyNetVarOverrides( decl_class );
+		}
+	}
+}
+
+void SchemaReader::ReadAtomics()
+{
+	if(!IsDumpingAtomics())
+		return;
+
+	META_CONPRINTF( "Reading %d atomics...\n", (int)m_Atomics.size() );
+
+	auto atomics = GetAtomicDefs();
+	atomics.SetArrayElementCount( (int)m_Atomics.size() );
+
+	for(int i = 0; i < (int)m_Atomics.size(); i++)
+		ReadAtomicInfo( atomics.GetArrayElement( i ), m_Atomics[i] );
+}
+
+void SchemaReader::ReadMemberSchemaType( const KV3Fanout &parent, CSchemaType *type, bool append_subtype )
+{
+	KV3Fanout root = append_subtype ? parent.FindOrCreateMember( "subtype" ) : parent;
+
+	switch(type->m_eTypeCategory)
+	{
+		case SCHEMA_TYPE_BUILTIN:
+		case SCHEMA_TYPE_DECLARED_CLASS:
+		case SCHEMA_TYPE_DECLARED_ENUM:
+		{
+			root.SetMemberString( "type", "ref" );
+			root.SetMemberInt( "ref_idx", FindTypeMapEntry( type ) );
+
+			break;
+		}
+		case SCHEMA_TYPE_POINTER:
+		{
+			auto ptr = type->ReinterpretAs<CSchemaType_Ptr>();
+
+			root.SetMemberString( "type", "ptr" );
+			ReadMemberSchemaType( root, ptr->GetInnerType().Get() );
+
+			break;
+		}
+
+		case SCHEMA_TYPE_ATOMIC:
+		{
+			root.SetMemberString( "type", "atomic" );
+
+			auto atomic_info = type->ReinterpretAs<CSchemaType_Atomic>()->m_pAtomicInfo;
+			int atomic_idx = IsDumpingAtomics() && atomic_info ? RequestAtomicEntry( atomic_info ) : -1;
+
+			if(atomic_idx != -1)
+				root.Where( SR_DUMP_ATOMICS ).SetMemberInt( "atomic_idx", atomic_idx );
+
+			// Compact profiles with atomics omit names that match the referenced atomics table entry
+			auto write_name = [&]( const KV3Fanout &names, const char *name ) {
+				bool in_table = atomic_idx != -1 && std::strcmp( name, atomic_info->m_pszName ) == 0;
+				(in_table ? names.WhereNotAll( SR_COMPACT | SR_DUMP_ATOMICS ) : names).SetMemberInterned( "name", name, m_Strings );
+			};
+
+			auto &attributes = GetTypeAttributes( type );
+
+			auto split_names = root.Where( SR_SPLIT_ATOMIC_NAMES );
+			if(!split_names.IsEmpty())
+				write_name( split_names, attributes.m_SplitName.c_str() );
+
+			write_name( root.WhereNot( SR_SPLIT_ATOMIC_NAMES ), type->m_sTypeName.Get() );
+
+			root.SetMemberInt( "size", attributes.m_nSize );
+			root.SetMemberUInt8( "alignment", attributes.m_nAlignment );
+
+			switch(type->m_eAtomicCategory)
+			{
+				case SCHEMA_ATOMIC_T:
+				{
+					auto atomic = type->ReinterpretAs<CSchemaType_Atomic_T>();
+					auto templ = root.FindOrCreateMember( "template" );
+					templ.SetArrayElementCount( 1 );
+
+					ReadMemberSchemaType( templ.GetArrayElement( 0 ), atomic->m_pTemplateType, false );
+
+					break;
+				}
+
+				case SCHEMA_ATOMIC_TT:
+				{
+					auto atomic = type->ReinterpretAs<CSchemaType_Atomic_TT>();
+					auto templ = root.FindOrCreateMember( "template" );
+					templ.SetArrayElementCount( 2 );
+
+					ReadMemberSchemaType( templ.GetArrayElement( 0 ), atomic->m_pTemplateType, false );
+					ReadMemberSchemaType( templ.GetArrayElement( 1 ), atomic->m_pTemplateType2, false );
+
+					break;
+				}
+
+				case SCHEMA_ATOMIC_COLLECTION_OF_T:
+				{
+					auto atomic = type->ReinterpretAs<CSchemaType_Atomic_CollectionOfT>();
+					auto templ = root.FindOrCreateMember( "template" );
+					templ.SetArrayElementCount( atomic->m_nFixedBufferCount > 0 ? 2 : 1 );
+
+					ReadMemberSchemaType( templ.GetArrayElement( 0 ), atomic->m_pTemplateType, false );
+					if(atomic->m_nFixedBufferCount > 0)
+					{
+						auto ii = templ.GetArrayElement( 1 );
+
+						ii.SetMemberString( "type", "literal" );
+						ii.SetMemberInt64( "value", atomic->m_nFixedBufferCount );
+					}
+
+					break;
+				}
+
+				case SCHEMA_ATOMIC_I:
+				{
+					auto atomic = type->ReinterpretAs<CSchemaType_Atomic_I>();
+					auto templ = root.FindOrCreateMember( "template" );
+					templ.SetArrayElementCount( 1 );
+
+					auto ii = templ.GetArrayElement( 0 );
+					ii.SetMemberString( "type", "literal" );
+					ii.SetMemberInt( "value", atomic->m_nInteger );
+
+					break;
+				}
+			}
+
+			break;
+		}
+
+		case SCHEMA_TYPE_BITFIELD:
+		{
+			auto bitfield = type->ReinterpretAs<CSchemaType_Bitfield>();
+
+			root.SetMemberString( "type", "bitfield" );
+			root.SetMemberInt64( "count", bitfield->m_nBitfieldCount );
+
+			break;
+		}
+
+		case SCHEMA_TYPE_FIXED_ARRAY:
+		{
+			auto fixed_array = type->ReinterpretAs<CSchemaType_FixedArray>();
+
+			root.SetMemberString( "type", "fixed_array" );
+			root.SetMemberInt64( "element_size", fixed_array->m_nElementSize );
+			root.SetMemberInt64( "count", fixed_array->m_nElementCount );
+			ReadMemberSchemaType( root, fixed_array->GetInnerType().Get() );
+
+			break;
+		}
+	}
+}
+
+uint64 SchemaReader::ComputeDedupeHash( CSchemaType *type )
+{
+	uint64 hash = SCHEMADUMP_HASH_OFFSET;
+	std::vector<std::pair<SchemaMetadataEntryData_t *, int>> metadata;
+
+	if(auto decl_class = type->ReinterpretAs<CSchemaType_DeclaredClass>())
+	{
+		hash = ComputeLayoutHash( decl_class );
+
+		if(auto ci = decl_class->m_pClassInfo)
+		{
+			hash = SchemaDumpHashInt( ci->m_nFlags1, hash );
+
+			if(HasReadableClassMetadata( ci ))
+				metadata.push_back( { ci->m_pStaticMetadata, ci->m_nStaticMetadataCount } );
+
+			for(int i = 0; i < ci->m_nFieldCount; i++)
+				metadata.push_back( { ci->m_pFields[i].m_pStaticMetadata, ci->m_pFields[i].m_nStaticMetadataCount } );
+		}
+	}
+	else if(auto decl_enum = type->ReinterpretAs<CSchemaType_DeclaredEnum>())
+	{
+		int size;
+		uint8 alignment;
+		type->GetSizeAndAlignment( size, alignment );
+
+		hash = SchemaDumpHashString( "enum", hash );
+		hash = SchemaDumpHashString( type->m_sTypeName.Get(), hash );
+		hash = SchemaDumpHashInt( size, hash );
+		hash = SchemaDumpHashInt( alignment, hash );
+
+		if(auto ei = decl_enum->m_pEnumInfo)
+		{
+			hash = SchemaDumpHashInt( ei->m_nFlags, hash );
+			hash = SchemaDumpHashInt( ei->m_nEnumeratorCount, hash );
+			metadata.push_back( { ei->m_pStaticMetadata, ei->m_nStaticMetadataCount } );
+
+			for(int i = 0; i < ei->m_nEnumeratorCount; i++)
+			{
+				auto &field = ei->m_pEnumerators[i];
+
+				hash = SchemaDumpHashString( field.m_pszName, hash );
+				hash = SchemaDumpHashInt( field.m_nValue, hash );
+				metadata.push_back( { field.m_pStaticMetadata, field.m_nStaticMetadataCount } );
+			}
+		}
+	}
+
+	// Metatags end up in the merged def as well, so they have to match too
+	for(auto &[data, count] : metadata)
+	{
+		hash = SchemaDumpHashInt( count, hash );
+
+		for(auto &meta : SchemaMetadataIterator( data, count ))
+		{
+			hash = SchemaDumpHashString( meta.m_pszName, hash );
+			hash = SchemaDumpHashString( SchemaMetadataToString::Eval( &meta ).c_str(), hash );
+		}
+	}
+
+	return hash;
+}
+
+const char *SchemaReader::GetProjectName( CSchemaType *type )
+{
+	const char *project = nullptr;
+
+	if(auto decl_class = type->ReinterpretAs<CSchemaType_DeclaredClass>())
+		project = decl_class->m_pClassInfo ? decl_class->m_pClassInfo->m_pszProjectName : nullptr;
+	else if(auto decl_enum = type->ReinterpretAs<CSchemaType_DeclaredEnum>())
+		project = decl_enum->m_pEnumInfo ? decl_enum->m_pEnumInfo->m_pszProjectName : nullptr;
+
+	return project ? project : "!!NULL!!";
+}
+
+std::string SchemaReader::LayoutHashToString( uint64 hash )
+{
+	char buf[32];
+	std::snprintf( buf, sizeof( buf ), "%016llx", (unsigned long long)hash );
+	return buf;
+}
+
+uint64 SchemaReader::ComputeLayoutHash( CSchemaType_DeclaredClass *type )
+{
+	// Raw type names are used, so the hash doesn't depend on dump flags
+	int size;
+	uint8 alignment;
+	type->GetSizeAndAlignment( size, alignment );
+
+	uint64 hash = SchemaDumpHashString( type->m_sTypeName.Get() );
+	hash = SchemaDumpHashInt( size, hash );
+	hash = SchemaDumpHashInt( alignment, hash );
+
+	auto ci = type->m_pClassInfo;
+	if(!ci)
+		return hash;
+
+	hash = SchemaDumpHashInt( ci->m_nBaseClassCount, hash );
+	for(int i = 0; i < ci->m_nBaseClassCount; i++)
+	{
+		hash = SchemaDumpHashString( ci->m_pBaseClasses[i].m_pClass->m_pszName, hash );
+		hash = SchemaDumpHashInt( ci->m_pBaseClasses[i].m_nOffset, hash );
+	}
+
+	hash = SchemaDumpHashInt( ci->m_nFieldCount, hash );
+	for(int i = 0; i < ci->m_nFieldCount; i++)
+	{
+		auto &field = ci->m_pFields[i];
+
+		hash = SchemaDumpHashString( field.m_pszName, hash );
+		hash = SchemaDumpHashInt( field.m_nSingleInheritanceOffset, hash );
+		hash = SchemaDumpHashString( field.m_pType->m_sTypeName.Get(), hash );
+	}
+
+	return hash;
+}
+
+void SchemaReader::ReadScopeLayoutHashes()
+{
+	// Merged types share the layout hash of their def, but still count towards their own scope
+	std::vector<std::pair<CSchemaType *, uint64>> classes;
+	for(auto &node : m_Types)
+	{
+		if(node.m_pType->m_eTypeCategory != SCHEMA_TYPE_DECLARED_CLASS)
+			continue;
+
+		classes.push_back( { node.m_pType, node.m_LayoutHash } );
+
+		for(auto merged : node.m_MergedTypes)
+			classes.push_back( { merged, node.m_LayoutHash } );
+	}
+
+	// Def order could change with dump flags, so classes are combined in the name order instead
+	std::sort( classes.begin(), classes.end(), []( const std::pair<CSchemaType *, uint64> &a, const std::pair<CSchemaType *, uint64> &b ) {
+		auto type_a = a.first, type_b = b.first;
+
+		int result = std::strcmp( type_a->m_pTypeScope->GetScopeName(), type_b->m_pTypeScope->GetScopeName() );
+		if(result != 0)
+			return result < 0;
+
+		return std::strcmp( type_a->m_sTypeName.Get(), type_b->m_sTypeName.Get() ) < 0;
+	} );
+
+	std::map<std::string, uint64> scope_hashes;
+	for(auto &[type, layout_hash] : classes)
+	{
+		auto [iter, inserted] = scope_hashes.emplace( type->m_pTypeScope->GetScopeName(), SCHEMADUMP_HASH_OFFSET );
+
+		iter->second = SchemaDumpHashString( type->m_sTypeName.Get(), iter->second );
+		iter->second = SchemaDumpHashInt( (int64)layout_hash, iter->second );
+	}
+
+	auto root = GetRoots().FindOrCreateMember( "scope_layout_hashes" );
+	for(auto &[scope, hash] : scope_hashes)
+		root.SetMemberString( scope.c_str(), LayoutHashToString( hash ).c_str() );
+}
+
+void SchemaReader::ReadDeclClass( CSchemaType_DeclaredClass *type, int idx )
+{
+	auto def = CreateDefEntry( type, idx );
+	auto traits = def.FindOrCreateMember( "traits" );
+	auto ci = type->m_pClassInfo;
+
+	LinkChildParentScopeDecls( traits, idx );
+	ReadFlags( traits, type );
+
+	if(ci)
+	{
+		if(HasReadableClassMetadata( ci ))
+			ReadMetaTags( traits, ci->m_pStaticMetadata, ci->m_nStaticMetadataCount );
+
+		if(ci->m_nBaseClassCount > 0)
+		{
+			traits.SetMemberUShort( "multi_depth", ci->m_nMultipleInheritanceDepth );
+			traits.SetMemberUShort( "single_depth", ci->m_nSingleInheritanceDepth );
+
+			auto baseclasses = traits.FindOrCreateMember( "baseclasses" );
+			baseclasses.SetArrayElementCount( ci->m_nBaseClassCount );
+
+			for(int i = 0; i < ci->m_nBaseClassCount; i++)
+			{
+				auto &base_ci = ci->m_pBaseClasses[i];
+				auto baseclass = baseclasses.GetArrayElement( i );
+
+				baseclass.SetMemberUInt( "offset", base_ci.m_nOffset );
+				baseclass.SetMemberInt( "ref_idx", FindTypeMapEntry( base_ci.m_pClass->m_pDeclaredClass ) );
+			}
+		}
+	}
+
+	int field_count = ci ? ci->m_nFieldCount : 0;
+
+	std::vector<SchemaBitfieldPlacement> bitfields;
+	if(ci)
+		ResolveBitfieldPlacements( ci, bitfields );
+
+	// Compact profiles omit empty arrays
+	auto members = (field_count > 0 ? traits : traits.WhereNot( SR_COMPACT )).FindOrCreateMember( "members" );
+	members.SetArrayElementCount( field_count );
+
+	for(int i = 0; i < field_count; i++)
+	{
+		auto field = ci->m_pFields[i];
+		auto member = members.GetArrayElement( i );
+
+		member.SetMemberString( "name", field.m_pszName );
+		member.SetMemberInt( "offset", field.m_nSingleInheritanceOffset );
+		auto member_traits = member.FindOrCreateMember( "traits" );
+
+		ReadMetaTags( member_traits, field.m_pStaticMetadata, field.m_nStaticMetadataCount );
+		ReadMemberSchemaType( member_traits, field.m_pType );
+
+		if(field.m_pType->m_eTypeCategory == SCHEMA_TYPE_BITFIELD && bitfields[i].m_nUnitSize > 0)
+		{
+			auto &placement = bitfields[i];
+			auto subtype = member_traits.FindOrCreateMember( "subtype" );
+
+			// Declared unit types aren't in schema, so placement is inferred rather than read
+			subtype.SetMemberString( "placement", "heuristic" );
+			subtype.SetMemberInt( "storage_offset", placement.m_nStorageOffset );
+			subtype.SetMemberInt( "unit_size", placement.m_nUnitSize );
+			subtype.SetMemberInt( "shift", placement.m_nShift );
+			subtype.SetMemberUInt64( "mask", placement.m_nMask );
+		}
+	}
+
+	m_Types[idx].m_LayoutHash = ComputeLayoutHash( type );
+	def.SetMemberString( "layout_hash", LayoutHashToString( m_Types[idx].m_LayoutHash ).c_str() );
+}
+
+void SchemaReader::ResolveBitfieldPlacements( SchemaClassInfoData_t *ci, std::vector<SchemaBitfieldPlacement> &placements )
+{
+	placements.assign( ci->m_nFieldCount, {} );
+
+	// Bitfields have no offset in schema, so a run starts right after whatever precedes it,
+	// which is the previous member, the base classes or the vtable pointer
+	int end = (ci->m_nFlags1 & SCHEMA_CF1_HAS_VIRTUAL_MEMBERS) != 0 ? (int)sizeof( void * ) : 0;
+
+	if(ci->m_nBaseClassCount > 0)
+	{
+		end = 0;
+		for(int i = 0; i < ci->m_nBaseClassCount; i++)
+			end = (std::max)( end, (int)ci->m_pBaseClasses[i].m_nOffset + ci->m_pBaseClasses[i].m_pClass->m_nSize );
+	}
+
+	std::vector<int> bit_counts;
+	for(int i = 0; i < ci->m_nFieldCount;)
+	{
+		auto &field = ci->m_pFields[i];
+
+		if(field.m_pType->m_eTypeCategory != SCHEMA_TYPE_BITFIELD)
+		{
+			end = field.m_nSingleInheritanceOffset + GetTypeAttributes( field.m_pType ).m_nSize;
+			i++;
+			continue;
+		}
+
+		int run_start = i;
+
+		bit_counts.clear();
+		for(; i < ci->m_nFieldCount && ci->m_pFields[i].m_pType->m_eTypeCategory == SCHEMA_TYPE_BITFIELD; i++)
+			bit_counts.push_back( (int)ci->m_pFields[i].m_pType->ReinterpretAs<CSchemaType_Bitfield>()->m_nBitfieldCount );
+
+		end = PlaceSchemaBitfieldRun( end, bit_counts.data(), (int)bit_counts.size(), &placements[run_start] );
+
+		// Placement running into the next member (or past the class) is known to be wrong, so it's dropped
+		int limit = i < ci->m_nFieldCount ? ci->m_pFields[i].m_nSingleInheritanceOffset : ci->m_nSize;
+		if(end > limit)
+		{
+			for(int k = run_start; k < i; k++)
+				placements[k] = {};
+		}
+	}
+}
+
+void SchemaReader::ReadDeclEnum( CSchemaType_DeclaredEnum *type, int idx )
+{
+	auto def = CreateDefEntry( type, idx );
+	auto traits = def.FindOrCreateMember( "traits" );
+	auto ci = type->m_pEnumInfo;
+
+	LinkChildParentScopeDecls( traits, idx );
+	ReadFlags( traits, type );
+
+	if(ci)
+		ReadMetaTags( traits, ci->m_pStaticMetadata, ci->m_nStaticMetadataCount );
+
+	int enumerator_count = ci ? ci->m_nEnumeratorCount : 0;
+
+	// Compact profiles omit empty arrays
+	auto fields = (enumerator_count > 0 ? traits : traits.WhereNot( SR_COMPACT )).FindOrCreateMember( "fields" );
+	fields.SetArrayElementCount( enumerator_count );
+
+	for(int i = 0; i < enumerator_count; i++)
+	{
+		auto enumf = ci->m_pEnumerators[i];
+		auto field = fields.GetArrayElement( i );
+
+		field.SetMemberString( "name", enumf.m_pszName );
+		field.SetMemberInt64( "value", enumf.m_nValue );
+
+		ReadMetaTags( field, enumf.m_pStaticMetadata, enumf.m_nStaticMetadataCount, true );
+	}
+}
+
+void SchemaReader::ReadAtomicInfo( const KV3Fanout &def, SchemaAtomicTypeInfo_t *info )
+{
+	def.SetMemberInterned( "name", info->m_pszName, m_Strings );
+	def.SetMemberInt( "token", info->m_nAtomicID );
+
+	ReadMetaTags( def, info->m_pStaticMetadata, info->m_nStaticMetadataCount, true );
+}
+
+void SchemaReader::ReadMetaTags( const KV3Fanout &parent, SchemaMetadataEntryData_t *data, int count, bool append_traits )
+{
+	if(count <= 0 || !IsDumpingMetaTags())
+		return;
+
+	KV3Fanout root = parent.Where( SR_DUMP_METATAGS );
+	if(root.IsEmpty())
+		return;
+	
+	if(append_traits)
+		root = root.FindOrCreateMember( "traits" );
+
+	auto metatags = root.FindOrCreateMember( "metatags" );
+	metatags.SetArrayElementCount( count );
+
+	for(int i = 0; i < count; i++)
+	{
+		auto meta = data[i];
+		auto metatag = metatags.GetArrayElement( i );
+
+		metatag.SetMemberInterned( "name", meta.m_pszName, m_Strings );
+
+		// Compact profiles get numbers and objects for the tags that have a typed value
+		auto compact = metatag.Where( SR_COMPACT );
+		bool typed = !compact.IsEmpty();
+		for(int k = 0; typed && k < compact.Count(); k++)
+			typed = SchemaMetadataToString::WriteTyped( &meta, compact.Node( k ) );
+
+		auto stringified = typed ? metatag.WhereNot( SR_COMPACT ) : metatag;
+		if(stringified.IsEmpty())
+			continue;
+
+		// Stringified once and shared between all the profiles
+		std::string metavalue = SchemaMetadataToString::Eval( &meta );
+		if(!metavalue.empty())
+			stringified.SetMemberInterned( "value", metavalue.c_str(), m_Strings );
+	}
+}
+
+void SchemaReader::ReadFlags( const KV3Fanout &root, CSchemaType *type )
+{
+	uint32 type_flags = 0;
+	std::pair<uint32, const char *> *flag_map = nullptr;
+	int flag_map_size = 0;
+
+	if(auto class_decl = type->ReinterpretAs<CSchemaType_DeclaredClass>())
+	{
+		if(!class_decl->m_pClassInfo)
+			return;
+
+		type_flags = class_decl->m_pClassInfo->m_nFlags1;
+		flag_map = s_ClassFlagMap;
+		flag_map_size = ARRAYSIZE( s_ClassFlagMap );
+	}
+	else if(auto enum_decl = type->ReinterpretAs<CSchemaType_DeclaredEnum>())
+	{
+		if(!enum_decl->m_pEnumInfo)
+			return;
+
+		type_flags = enum_decl->m_pEnumInfo->m_nFlags;
+		flag_map = s_EnumFlagMap;
+		flag_map_size = ARRAYSIZE( s_EnumFlagMap );
+	}
+	else
+	{
+		return;
+	}
+
+	if(type_flags == 0)
+		return;
+
+	// Compact profiles get a raw bitmask, names of the bits are recorded once by RecordCompactInfo
+	root.Where( SR_COMPACT ).SetMemberUInt( "flags", type_flags );
+
+	auto flags = root.WhereNot( SR_COMPACT ).FindOrCreateMember( "flags" );
+
+	for(int i = 0; i < flag_map_size; i++)
+	{
+		if((type_flags & flag_map[i].first) != 0)
+		{
+			flags.ArrayAddElementToTail().SetString( flag_map[i].second );
+			type_flags &= ~flag_map[i].first;
+		}
+	}
+
+	char buf[64];
+	for(int i = 0; i < sizeof( type_flags ) * 8; i++)
+	{
+		if((type_flags & i) != 0)
+		{
+			std::snprintf( buf, sizeof( buf ), "UNKNOWN_BIT_%d", i );
+			flags.ArrayAddElementToTail().SetString( buf );
+
+			if(IsVerboseLogging())
+			{
+				META_CONPRINTF( "Found unknown flag bit %d for %s (%s)\n", i, type->m_eTypeCategory == SCHEMA_TYPE_DECLARED_CLASS ? "class" : "enum", type->m_sTypeName.Get() );
+			}
+		}
+	}
+}
+
+void SchemaReader::ReadPulseBinding( const KV3Fanout &root, PulseDomainMap &domains, const char *class_name, CPulseLibraryBinding *binding )
+{
+	auto [domain_iter, domain_created] = domains.try_emplace( binding->m_Name.Get() );
+	auto &domain = domain_iter->second;
+
+	if(domain_created)
+	{
+		domain.m_Domain = root.ArrayAddElementToTail();
+		domain.m_Domain.SetMemberString( "name", binding->m_Name.Get() );
+
+		domain.m_CppScopes = domain.m_Domain.FindOrCreateMember( "cpp_scopes" );
+		domain.m_CppScopes.SetToEmptyArray();
+	}
+
+	auto [scope_iter, scope_created] = domain.m_ScopeFunctions.try_emplace( class_name );
+	auto &functions = scope_iter->second;
+
+	if(scope_created)
+	{
+		auto scope = domain.m_CppScopes.ArrayAddElementToTail();
+		scope.SetMemberString( "name", class_name );
+
+		functions = scope.FindOrCreateMember( "functions" );
+		functions.SetToEmptyArray();
+	}
+
+	ReadPulseDomianFunctions( functions, binding->m_Functions, binding->m_FunctionCount );
+	ReadPulseDomianFunctions( functions, binding->m_EventFunctions, binding->m_EventFunctionCount );
+}
+
+template <typename DOMAIN_FUNCTION>
+void SchemaReader::ReadPulseDomianFunctions( const KV3Fanout &root, DOMAIN_FUNCTION *functions, int count )
+{
+	for(int i = 0; i < count; i++)
+	{
+		auto func = root.ArrayAddElementToTail();
+		auto &func_binding = functions[i];
+
+		func.SetMemberString( "name", func_binding.m_Name.Get() );
+		func.SetMemberString( "library_name", func_binding.m_LibraryName.Get() );
+		func.SetMemberString( "description", func_binding.m_Description.Get() );
+
+		if constexpr (std::is_same_v<DOMAIN_FUNCTION, CPulseLibraryEventFunction>)
+			func.SetMemberString( "type", "event" );
+		else
+			func.SetMemberString( "type", "plain" );
+
+		auto params = func.FindOrCreateMember( "params" );
+		params.SetToEmptyArray();
+
+		if(func_binding.m_Params)
+		{
+			auto binding_params = func_binding.m_Params();
+			for(int i = 0; i < func_binding.m_ParamCount; i++)
+			{
+				auto &binding_param = binding_params[i];
+				auto param = params.ArrayAddElementToTail();
+
+				param.SetMemberString( "name", binding_param.m_Name.GetString() );
+				param.SetMemberInt( "type_idx", RequestPulseTypeEntry( binding_param.m_TypeDesc ) );
+
+				if(binding_param.HasDefaultValue())
+					param.SetMemberString( "default_value", binding_param.DefaultValueToString().c_str() );
+
+				ReadMetaTags( param, binding_param.m_StaticMetadata, binding_param.m_StaticMetadataCount, true );
+			}
+		}
+
+		auto rets = func.FindOrCreateMember( "rets" );
+		rets.SetToEmptyArray();
+
+		if(func_binding.m_Rets)
+		{
+			auto binding_rets = func_binding.m_Rets();
+			for(int i = 0; i < func_binding.m_RetCount; i++)
+			{
+				auto &binding_ret = binding_rets[i];
+				auto ret = rets.ArrayAddElementToTail();
+
+				ret.SetMemberString( "name", binding_ret.m_Name.GetString() );
+				ret.SetMemberInt( "type_idx", RequestPulseTypeEntry( binding_ret.m_TypeDesc ) );
+
+				if(binding_ret.HasDefaultValue())
+					ret.SetMemberString( "default_value", binding_ret.DefaultValueToString().c_str() );
+
+				ReadMetaTags( ret, binding_ret.m_StaticMetadata, binding_ret.m_StaticMetadataCount, true );
+			}
+		}
+
+		ReadMetaTags( func, func_binding.m_StaticMetadata, func_binding.m_StaticMetadataCount, true );
+	}
+}
+
+int SchemaReader::RequestPulseTypeEntry( const PulseParamType &type )
+{
+	// Subtypes are only formatted for arrays
+	int subtype_idx = -1;
+	if(type.m_Type == PVAL_ARRAY && type.m_SubType && type.m_SubType->IsValid())
+		subtype_idx = RequestPulseTypeEntry( *type.m_SubType );
+
+	auto key = std::make_tuple( (int)type.m_Type, std::string_view( type.m_LibraryClass ? type.m_LibraryClass : "" ), subtype_idx );
+
+	auto iter = m_PulseTypeMap.find( key );
+	if(iter != m_PulseTypeMap.end())
+		return iter->second;
+
+	PulseTypeEntry entry;
+	entry.m_nType = type.m_Type;
+	entry.m_pszLibraryClass = type.m_LibraryClass;
+	entry.m_SubTypeIdx = subtype_idx;
+	entry.m_Name = PulseParamType::Format( type.m_Type, type.m_LibraryClass, subtype_idx != -1 ? m_PulseTypes[subtype_idx].m_Name.c_str() : nullptr );
+
+	int idx = (int)m_PulseTypes.size();
+	m_PulseTypes.push_back( std::move( entry ) );
+	m_PulseTypeMap.emplace( key, idx );
+
+	return idx;
+}
+
+void SchemaReader::ReadPulseTypes()
+{
+	auto pulse_types = GetRoots().Where( SR_DUMP_PULSE_BINDINGS ).FindOrCreateMember( "pulse_types" );
+	pulse_types.SetArrayElementCount( (int)m_PulseTypes.size() );
+
+	for(int i = 0; i < (int)m_PulseTypes.size(); i++)
+	{
+		auto &entry = m_PulseTypes[i];
+		auto pulse_type = pulse_types.GetArrayElement( i );
+
+		pulse_type.SetMemberString( "kind", PulseParamType::KindToString( (PulseValueType_t)entry.m_nType ) );
+		pulse_type.SetMemberString( "name", entry.m_Name.c_str() );
+
+		if(entry.m_pszLibraryClass)
+			pulse_type.SetMemberString( "library_class", entry.m_pszLibraryClass );
+
+		if(entry.m_SubTypeIdx != -1)
+			pulse_type.SetMemberInt( "subtype_idx", entry.m_SubTypeIdx );
+	}
+}
+
+void SchemaReader::ReadPulseDomainInfo( PulseDomainMap &domains, CPulseDomainInfo *domain_info )
+{
+	auto iter = domains.find( domain_info->m_Name.Get() );
+	if(iter == domains.end())
+		return;
+
+	auto &domain = iter->second.m_Domain;
+
+	domain.SetMemberString( "description", domain_info->m_Description.Get() );
+	domain.SetMemberString( "friendly_name", domain_info->m_FriendlyName.Get() );
+	domain.SetMemberString( "cursor", domain_info->m_CursorName.Get() );
+}
+
+void SchemaReader::ReadPulseBindings()
+{
+	if(!IsDumpingPulseBindings())
+		return;
+
+	META_CONPRINTF( "Reading pulse_bindings...\n" );
+
+	auto pulse_bindings = GetRoots().Where( SR_DUMP_PULSE_BINDINGS ).FindOrCreateMember( "pulse_bindings" );
+	pulse_bindings.SetArrayElementCount( 0 );
+
+	enum PulseTagKind
+	{
+		PULSE_TAG_LIBRARY_BINDINGS,
+		PULSE_TAG_CELL_METHOD_BINDINGS,
+		PULSE_TAG_DOMAIN_INFO,
+
+		PULSE_TAG_COUNT
+	};
+
+	static const std::unordered_map<std::string_view, PulseTagKind> s_PulseTags = {
+		{ MPulseLibraryBindings::Tag(), PULSE_TAG_LIBRARY_BINDINGS },
+		{ MPulseCellMethodBindings::Tag(), PULSE_TAG_CELL_METHOD_BINDINGS },
+		{ MPulseInstanceDomainInfo::Tag(), PULSE_TAG_DOMAIN_INFO }
+	};
+
+	// All pulse tags are dispatched in a single pass over class metadata, hits are bucketed per tag
+	// so domains are still created from library bindings first, then cell methods, then get their info
+	std::vector<std::pair<const char *, SchemaMetadataEntryData_t *>> hits[PULSE_TAG_COUNT];
+
+	auto collect_hits = [&hits]( CSchemaType *type ) {
+		auto decl_class = type->ReinterpretAs<CSchemaType_DeclaredClass>();
+		if(!decl_class || !decl_class->m_pClassInfo)
+			return;
+
+		auto ci = decl_class->m_pClassInfo;
+		for(auto &metadata : SchemaMetadataIterator( ci->m_pStaticMetadata, ci->m_nStaticMetadataCount ))
+		{
+			auto iter = s_PulseTags.find( metadata.m_pszName );
+			if(iter != s_PulseTags.end())
+				hits[iter->second].emplace_back( ci->m_pszName, &metadata );
+		}
+	};
+
+	// Classes folded by SR_DEDUPE_PROJECTS still carry their own project's bindings
+	for(auto &node : m_Types)
+	{
+		collect_hits( node.m_pType );
+
+		for(auto merged : node.m_MergedTypes)
+			collect_hits( merged );
+	}
+
+	PulseDomainMap domains;
+	domains.reserve( hits[PULSE_TAG_LIBRARY_BINDINGS].size() + hits[PULSE_TAG_CELL_METHOD_BINDINGS].size() );
+
+	for(auto kind : { PULSE_TAG_LIBRARY_BINDINGS, PULSE_TAG_CELL_METHOD_BINDINGS })
+	{
+		for(auto &[class_name, metadata] : hits[kind])
+		{
+			// Both binding tags share the same payload type
+			if(auto binding = reinterpret_cast<MPulseLibraryBindings *>(metadata)->Value())
+				ReadPulseBinding( pulse_bindings, domains, class_name, binding );
+		}
+	}
+
+	for(auto &[class_name, metadata] : hits[PULSE_TAG_DOMAIN_INFO])
+	{
+		if(auto domain_info = reinterpret_cast<MPulseInstanceDomainInfo *>(metadata)->Value())
+			ReadPulseDomainInfo( domains, domain_info );
+	}
+	ReadPulseTypes();
+}
+
+static void WriteModuleMetadataEntry( const KV3Fanout &modules_metadata, KeyValues3 *metadata, const char *module_name, const char *additional_info )
+{
+	auto entry = modules_metadata.ArrayAddElementToTail();
+
+	for(int k = 0; k < entry.Count(); k++)
+		*entry.Node( k ) = *metadata;
+
+	entry.SetMemberString( "module_name", module_name );
+
+	if(additional_info && additional_info[0])
+		entry.SetMemberString( "additional_info", additional_info );
+}
+
+SchemaModuleCache SchemaReader::GetModuleMetadataCache()
+{
+	return SchemaModuleCache( std::filesystem::path( g_SMAPI->GetBaseDir() ) / "addons" / PLUGIN_NAME / "cache" / "module_metadata" );
+}
+
+bool SchemaReader::SaveModuleMetadataCache( const std::filesystem::path &path, KeyValues3 *cached )
+{
+	CUtlString err, out;
+	if(!SaveKV3Text_ToString( g_KV3Encoding_Text, cached, &err, &out ))
+	{
+		META_CONPRINTF( "Failed to serialize module metadata cache %s! Reason: \"%s\"\n", path.string().c_str(), err.Get() );
+		return false;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories( path.parent_path(), ec );
+
+	return WriteFileAtomic( path, out.Get(), out.Length() );
+}
+
+#if PLATFORM_LINUX
+static bool LoadModuleMetadataCache( const SchemaModuleCache &cache, const std::string &build_id, KeyValues3 *cached )
+{
+	std::string content;
+	if(!cache.Load( build_id, content ))
+		return false;
+
+	CUtlString err;
+	if(!LoadKV3( cached, &err, content.c_str() ) || !cached->FindMember( "has_metadata" ))
+	{
+		if(SchemaReader::IsVerboseLogging())
+			META_CONPRINTF( "Ignoring invalid module metadata cache %s (%s)\n", cache.GetPath( build_id ).string().c_str(), err.Get() );
+
+		return false;
+	}
+
+	return true;
+}
+#endif
+
+void SchemaReader::ReadModuleMetadata()
+{
+	if(!IsDumpingModuleMetadata())
+		return;
+
+#if PLATFORM_WINDOWS
+	META_CONPRINTF( "Reading module metadata...\n" );
+
+	auto modules_metadata = GetRoots().Where( SR_DUMP_MODULE_METADATA ).FindOrCreateMember( "modules_metadata" );
+	modules_metadata.SetArrayElementCount( 0 );
+
+	HANDLE snapshot = CreateToolhelp32Snapshot( TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, GetCurrentProcessId() );
+
+	if(snapshot != INVALID_HANDLE_VALUE)
+	{
+		MODULEENTRY32 module_entry = { sizeof( module_entry ) };
+		if(Module32First( snapshot, &module_entry ))
+		{
+			do
+			{
+				if(module_entry.hModule)
+				{
+					auto func = (KeyValues3 * (*)(CUtlString *))GetProcAddress( module_entry.hModule, "ExtractModuleMetadata" );
+					if(func)
+					{
+						CUtlString additional_info;
+						auto metadata = func( &additional_info );
+
+						if(metadata->IsNull())
+							continue;
+
+						WriteModuleMetadataEntry( modules_metadata, metadata, module_entry.szModule, additional_info.Get() );
+					}
+					
+				}
+
+			} while(Module32Next( snapshot, &module_entry ));
+		}
+
+		CloseHandle( snapshot );
+	}
+#elif PLATFORM_LINUX
+	META_CONPRINTF( "Reading module metadata...\n" );
+
+	auto modules_metadata = GetRoots().Where( SR_DUMP_MODULE_METADATA ).FindOrCreateMember( "modules_metadata" );
+	modules_metadata.SetArrayElementCount( 0 );
+
+	auto modules = EnumerateLoadedModules();
+	auto cache = GetModuleMetadataCache();
+
+	int cache_hits = 0, extracted = 0;
+
+	for(auto &module : modules)
+	{
+		auto cache_path = cache.GetPath( module.m_BuildId );
+
+		CKV3Arena cache_context( false );
+		auto cached = cache_context.Root();
+
+		// Modules without metadata are cached too, so repeated dumps don't touch them at all
+		if(LoadModuleMetadataCache( cache, module.m_BuildId, cached ))
+		{
+			cache_hits++;
+		}
+		else
+		{
+			// Modules are already loaded, RTLD_NOLOAD only takes another reference to them
+			void *handle = dlopen( module.m_Path.c_str(), RTLD_NOW | RTLD_NOLOAD );
+			if(!handle)
+				continue;
+
+			cached->SetMemberBool( "has_metadata", false );
+
+			if(auto func = (KeyValues3 * (*)(CUtlString *))dlsym( handle, "ExtractModuleMetadata" ))
+			{
+				CUtlString additional_info;
+				auto metadata = func( &additional_info );
+
+				if(metadata && !metadata->IsNull())
+				{
+					cached->SetMemberBool( "has_metadata", true );
+					*cached->FindOrCreateMember( "metadata" ) = *metadata;
+
+					if(!additional_info.IsEmpty())
+						cached->SetMemberString( "additional_info", additional_info.Get() );
+				}
+
+				extracted++;
+			}
+
+			dlclose( handle );
+
+			if(!cache_path.empty())
+				SaveModuleMetadataCache( cache_path, cached );
+		}
+
+		auto has_metadata = cached->FindMember( "has_metadata" );
+		if(!has_metadata || !has_metadata->GetBool())
+			continue;
+
+		auto module_name = std::filesystem::path( module.m_Path ).filename().string();
+		WriteModuleMetadataEntry( modules_metadata, cached->FindMember( "metadata" ), module_name.c_str(), cached->GetMemberString( "additional_info", "" ) );
+	}
+
+	META_CONPRINTF( "Scanned %d modules, %d served from cache, %d extracted\n", (int)modules.size(), cache_hits, extracted );
+#else
+	META_CONPRINTF( "Reading module metadata is not supported on this platform, skipping...\n" );
+#endif
+}
+
+void SchemaReader::ReadStringTable()
+{
+	auto roots = GetRoots().Where( SR_INTERN_STRINGS );
+	if(roots.IsEmpty())
+		return;
+
+	auto strings = roots.FindOrCreateMember( "strings" );
+	strings.SetArrayElementCount( m_Strings.Count() );
+
+	for(int i = 0; i < m_Strings.Count(); i++)
+		strings.GetArrayElement( i ).SetStringExternal( m_Strings.Get( i ) );
+
+	if(IsVerboseLogging())
+		META_CONPRINTF( "Interned %d strings\n", m_Strings.Count() );
+}
+
+CSchemaType_DeclaredClass *SchemaReader::FindSchemaTypeInTypeScopes( const char *name )
+{
+	auto ci = SchemaSystem()->FindClassByScopedName( name ).Get();
+
+	if(ci)
+		return ci->m_pDeclaredClass;
+	
+	for(int i = 0; i < SchemaSystem()->m_TypeScopes.GetNumStrings(); i++)
+	{
+		auto ts = SchemaSystem()->m_TypeScopes[i];
+		ci = ts->FindDeclaredClass( name ).Get();
+		
+		if(ci)
+			return ci->m_pDeclaredClass;
+	}
+
+	return nullptr;
+}
+
+bool SchemaReader::ApplyNetVarOverrides( CSchemaType_DeclaredClass *type )
+{
+	if(!IsApplyingNetVarOverrides())
+		return true;
+	
+	auto ci = type->m_pClassInfo;
+
+	if(!ci || ci->m_nBaseClassCount <= 0)
+		return true;
+
+	for(auto &meta : SchemaMetadataIterator( ci->m_pStaticMetadata, ci->m_nStaticMetadataCount ))
+	{
+		if(auto var_override = MNetworkVarTypeOverride::From( &meta ))
+		{
+			auto var_ci = FindSchemaTypeInTypeScopes( var_override->Value().m_TypeName );
+
+			if(!var_ci)
+			{
+				if(IsVerboseLogging())
+				{
+					META_CONPRINTF( "Failed to find type override (%s) for class (%s)\n", var_override->Value().m_TypeName, ci->m_pszName );
+				}
+
+				continue;
+			}
+
+			auto idx = FindTypeMapEntry( var_ci );
+
+			if(idx == -1)
+			{
+				if(IsVerboseLogging())
+				{
+					META_CONPRINTF( "Failed to find type override (%s) for class (%s) not initialized\n", var_override->Value().m_TypeName, ci->m_pszName );
+				}
+
+				continue;
+			}
+
+			ApplyNetVarOverrides( type, var_override->Value().m_FieldName, idx );
+		}
+	}
+
+	return true;
+}
+
+bool SchemaReader::ApplyNetVarOverrides( CSchemaType_DeclaredClass *root, const char *field_to_overwrite, int type_override_idx )
+{
+	auto ci = root->m_pClassInfo;
+
+	if(!ci)
+		return true;
+
+	for(int i = 0; i < ci->m_nFieldCount; i++)
+	{
+		auto &field = ci->m_pFields[i];
+
+		if(std::strcmp( field.m_pszName, field_to_overwrite ) == 0)
+		{
+			auto def = FindDefEntry( root );
+
+			if(def.IsEmpty())
+			{
+				if(IsVerboseLogging())
+				{
+					META_CONPRINTF( "Failed to apply netvar override (%s) due to type (%s) being not yet initialized.\n", field_to_overwrite, ci->m_pszName );
+				}
+
+				return true;
+			}
+
+			auto overriden_defs = def.Where( SR_APPLY_NETVAR_OVERRIDES );
+			for(int k = 0; k < overriden_defs.Count(); k++)
+				ApplyNetVarOverride( overriden_defs.Node( k ), field_to_overwrite, type_override_idx );
+
+			return true;
+		}
+	}
+
+	for(int i = 0; i < ci->m_nBaseClassCount; i++)
+	{
+		auto &baseclass = ci->m_pBaseClasses[i];
+
+		if(ApplyNetVarOverrides( baseclass.m_pClass->m_pDeclaredClass, field_to_overwrite, type_override_idx ))
+			return true;
+	}
+
+	return true;
+}
+
+void SchemaReader::ApplyNetVarOverride( KeyValues3 *def, const char *field_to_overwrite, int type_override_idx )
+{
+	auto traits = def->FindMember( "traits" );
+
+	if(!traits)
+		return;
+	
+	auto members = traits->FindMember( "members" );
+
+	if(!members)
+		return;
+
+	for(int k = 0; k < members->GetArrayElementCount(); k++)
+	{
+		auto member = members->GetArrayElement( k );
+
+		if(std::strcmp( member->GetMemberString( "name" ), field_to_overwrite ) == 0)
+		{
+			auto mem_traits = member->FindMember( "traits" );
+			if(!mem_traits)
+				return;
+			
+			auto subtype = mem_traits->FindMember( "subtype" );
+			do
+			{
+				if(std::strcmp( subtype->GetMemberString( "type" ), "ref" ) == 0)
+				{
+					subtype->SetMemberInt( "ref_idx", type_override_idx );
+					return;
+				}
+
+				subtype = subtype->FindMember( "subtype" );
+
+			} while(subtype);
+
+			return;
+		}
+	}
+
+	if(IsVerboseLogging())
+	{
+		META_CONPRINTF( "Failed to apply netvar override (%s) due to missing member field in kv.\n", field_to_overwrite );
+	}
+}
+
+void SchemaReader::LinkChildParentScopeDecls( const KV3Fanout &traits, int child_idx )
+{
+	auto child_traits = traits.WhereNot( SR_IGNORE_PARENT_SCOPE );
+	int parent_idx = m_Types[child_idx].m_ParentScopeIdx;
+
+	if(child_traits.IsEmpty() || parent_idx == -1)
+		return;
+
+	if(parent_idx == SR_MISSING_PARENT_SCOPE)
+	{
+		// Let child class to know that parent decl is unavailable
+		child_traits.FindOrCreateMember( "parent_class_idx" ).SetInt( -1 );
+		return;
+	}
+
+	auto parent_def = FindDefEntry( parent_idx ).WhereNot( SR_IGNORE_PARENT_SCOPE );
+	auto parent_traits = parent_def.FindOrCreateMember( "traits" );
+
+	// Add a ref of child class decl to parent decl, children are linked in index order
+	auto &parent_node = m_Types[parent_idx];
+	auto child_class_decls = parent_traits.FindOrCreateMember( "child_class_idx" );
+
+	if(parent_node.m_nLinkedChildScopes == 0)
+		child_class_decls.SetArrayElementCount( parent_node.m_nChildScopeCount );
+
+	child_class_decls.GetArrayElement( parent_node.m_nLinkedChildScopes++ ).SetInt( child_idx );
+
+	// Add a ref of parent class decl to child decl
+	child_traits.FindOrCreateMember( "parent_class_idx" ).SetInt( parent_idx );
+}
+
+bool SchemaReader::WriteToOutDir()
+{
+	bool success = true;
+	bool captured = false;
+
+	for(auto &profile : m_Profiles)
+	{
+		if(profile->HasFlag( SR_DUMP_AS_KV3 ))
+			success &= WriteToKV3( profile.get() );
+
+		if(profile->HasFlag( SR_DUMP_AS_JSON ))
+			success &= WriteToJSON( profile.get() );
+
+		if(profile->HasFlag( SR_LAYOUT_REPORT ))
+			success &= WriteLayoutReport( profile.get() );
+
+		if(profile->HasFlag( SR_NET_REPORT ))
+			success &= WriteNetReport( profile.get() );
+
+		// Capture doesn't depend on profile flags, so it's only written for the first profile asking for it
+		if(profile->HasFlag( SR_CAPTURE ) && !captured)
+		{
+			success &= WriteCapture( profile.get() );
+			captured = true;
+		}
+	}
+
+	// Snapshot doesn't depend on profile flags, so it's published only once
+	if(m_Flags & SR_SHM_SNAPSHOT)
+	{
+		auto index = SchemaIndex::Get();
+		success &= index && PublishSchemaSnapshot( *index );
+	}
+
+	return success;
+}
+
+std::string SchemaReader::GetOutFileName( SchemaDumpProfile *profile, const char *ext ) const
+{
+	auto t = std::time( nullptr );
+	auto tm = *std::localtime( &t );
+	std::ostringstream ss;
+
+	ss << std::put_time( &tm, "%d%m%y" );
+
+	// Keep plain names for a single profile dumps, otherwise profiles would overwrite each other
+	if(m_Profiles.size() > 1)
+		ss << "_" << profile->m_Name;
+
+	ss << ext;
+
+	return ss.str();
+}
+
+bool SchemaReader::WriteToKV3( SchemaDumpProfile *profile )
+{
+	CUtlString err, out;
+	SaveKV3Text_ToString( g_KV3Encoding_Text, profile->GetRoot(), &err, &out );
+
+	if(!err.IsEmpty())
+	{
+		META_CONPRINTF( "Failed to save kv3 to file! Reason: \"%s\"\n", err.Get() );
+		return false;
+	}
+
+	return WriteToFile( GetOutFileName( profile, ".kv3" ), out.Get(), out.Length() );
+}
+
+bool SchemaReader::WriteToJSON( SchemaDumpProfile *profile )
+{
+	CUtlString err, out;
+	SaveKV3AsJSON( profile->GetRoot(), &err, &out );
+
+	if(!err.IsEmpty())
+	{
+		META_CONPRINTF( "Failed to save kv3 as json! Reason: \"%s\"\n", err.Get() );
+		return false;
+	}
+
+	return WriteToFile( GetOutFileName( profile, ".json" ), out.Get(), out.Length() );
+}
+
+bool SchemaReader::WriteLayoutReport( SchemaDumpProfile *profile )
+{
+	CKV3Arena context( false );
+	auto root = context.Root();
+
+	root->SetMemberInt( "cache_line_size", SR_CACHE_LINE_SIZE );
+
+	auto classes = root->FindOrCreateMember( "classes" );
+	classes->SetArrayElementCount( (int)m_LayoutReports.size() );
+
+	for(int i = 0; i < (int)m_LayoutReports.size(); i++)
+	{
+		auto &entry = m_LayoutReports[i];
+		auto &report = entry.m_Report;
+		auto type = m_Types[entry.m_TypeIdx].m_pType;
+		auto kv = classes->GetArrayElement( i );
+
+		kv->SetMemberString( "name", type->m_sTypeName.Get() );
+		kv->SetMemberString( "scope", type->m_pTypeScope->GetScopeName() );
+		kv->SetMemberInt( "size", entry.m_nSize );
+		kv->SetMemberInt( "wasted_bytes", report.m_nWastedBytes );
+		kv->SetMemberInt( "tail_padding", report.m_nTailPadding );
+		kv->SetMemberInt( "cache_lines", report.m_nCacheLines );
+		kv->SetMemberBool( "approximate", entry.m_bApproximate );
+
+		auto holes = kv->FindOrCreateMember( "holes" );
+		holes->SetArrayElementCount( (int)report.m_Holes.size() );
+
+		for(int k = 0; k < (int)report.m_Holes.size(); k++)
+		{
+			auto hole = holes->GetArrayElement( k );
+
+			hole->SetMemberInt( "offset", report.m_Holes[k].m_nOffset );
+			hole->SetMemberInt( "size", report.m_Holes[k].m_nSize );
+		}
+
+		auto shared_lines = kv->FindOrCreateMember( "shared_network_lines" );
+		shared_lines->SetArrayElementCount( (int)report.m_SharedNetworkLines.size() );
+
+		for(int k = 0; k < (int)report.m_SharedNetworkLines.size(); k++)
+		{
+			auto &shared = report.m_SharedNetworkLines[k];
+			auto line = shared_lines->GetArrayElement( k );
+
+			line->SetMemberInt( "line", shared.m_nLine );
+
+			auto fields = line->FindOrCreateMember( "fields" );
+			fields->SetArrayElementCount( (int)shared.m_Fields.size() );
+
+			for(int j = 0; j < (int)shared.m_Fields.size(); j++)
+				fields->GetArrayElement( j )->SetString( shared.m_Fields[j] );
+		}
+	}
+
+	CUtlString err, out;
+	SaveKV3AsJSON( root, &err, &out );
+
+	if(!err.IsEmpty())
+	{
+		META_CONPRINTF( "Failed to save layout report as json! Reason: \"%s\"\n", err.Get() );
+		return false;
+	}
+
+	return WriteToFile( GetOutFileName( profile, "_layout.json" ), out.Get(), out.Length() );
+}
+
+void SchemaReader::NetFootprint::Merge( const NetFootprint &other )
+{
+	m_nClasses += other.m_nClasses;
+	m_nFields += other.m_nFields;
+	m_nBytes += other.m_nBytes;
+	m_nChangeCallbacks += other.m_nChangeCallbacks;
+
+	for(auto &[name, count] : other.m_Encoders)
+		m_Encoders[name] += count;
+}
+
+void SchemaReader::NetFootprint::Write( KeyValues3 *root ) const
+{
+	root->SetMemberInt( "fields", m_nFields );
+	root->SetMemberInt( "bytes", m_nBytes );
+	root->SetMemberInt( "change_callbacks", m_nChangeCallbacks );
+
+	auto encoders = root->FindOrCreateMember( "encoders" );
+	encoders->SetToEmptyTable();
+
+	for(auto &[name, count] : m_Encoders)
+		encoders->SetMemberInt( name.c_str(), count );
+}
+
+bool SchemaReader::WriteNetReport( SchemaDumpProfile *profile )
+{
+	CKV3Arena context( false );
+	auto root = context.Root();
+
+	std::map<std::string, NetFootprint> projects, scopes;
+
+	auto classes = root->FindOrCreateMember( "classes" );
+	classes->SetArrayElementCount( (int)m_NetReports.size() );
+
+	for(int i = 0; i < (int)m_NetReports.size(); i++)
+	{
+		auto &report = m_NetReports[i];
+		auto decl_class = m_Types[report.m_TypeIdx].m_pType->ReinterpretAs<CSchemaType_DeclaredClass>();
+		auto kv = classes->GetArrayElement( i );
+
+		kv->SetMemberString( "name", decl_class->m_sTypeName.Get() );
+		kv->SetMemberString( "scope", decl_class->m_pTypeScope->GetScopeName() );
+		kv->SetMemberString( "project", decl_class->m_pClassInfo->m_pszProjectName );
+		kv->SetMemberInt( "inherited_fields", report.m_nInheritedFields );
+		kv->SetMemberInt( "type_overridden_fields", report.m_nTypeOverriddenFields );
+		kv->SetMemberInt( "property_overridden_fields", report.m_nPropertyOverriddenFields );
+		kv->SetMemberInt( "var_names", report.m_nVarNames );
+
+		auto unmatched = kv->FindOrCreateMember( "unmatched_var_names" );
+		unmatched->SetArrayElementCount( (int)report.m_UnmatchedVarNames.size() );
+
+		for(int k = 0; k < (int)report.m_UnmatchedVarNames.size(); k++)
+			unmatched->GetArrayElement( k )->SetString( report.m_UnmatchedVarNames[k].c_str() );
+
+		report.m_Total.Write( kv->FindOrCreateMember( "total" ) );
+		report.m_Own.Write( kv->FindOrCreateMember( "own" ) );
+
+		projects[decl_class->m_pClassInfo->m_pszProjectName].Merge( report.m_Own );
+		scopes[decl_class->m_pTypeScope->GetScopeName()].Merge( report.m_Own );
+	}
+
+	// Aggregates only sum declared fields, so inherited ones aren't counted multiple times
+	for(auto &[member_name, aggregates] : { std::make_pair( "projects", &projects ), std::make_pair( "scopes", &scopes ) })
+	{
+		auto kv = root->FindOrCreateMember( member_name );
+		kv->SetToEmptyTable();
+
+		for(auto &[name, footprint] : *aggregates)
+		{
+			auto entry = kv->FindOrCreateMember( name.c_str() );
+
+			entry->SetMemberInt( "classes", footprint.m_nClasses );
+			footprint.Write( entry );
+		}
+	}
+
+	CUtlString err, out;
+	SaveKV3AsJSON( root, &err, &out );
+
+	if(!err.IsEmpty())
+	{
+		META_CONPRINTF( "Failed to save net report as json! Reason: \"%s\"\n", err.Get() );
+		return false;
+	}
+
+	return WriteToFile( GetOutFileName( profile, "_net.json" ), out.Get(), out.Length() );
+}
+
+static void WriteCaptureMetaTags( KeyValues3 *root, SchemaMetadataEntryData_t *data, int count )
+{
+	if(count <= 0)
+		return;
+
+	auto metatags = root->FindOrCreateMember( "metatags" );
+	metatags->SetArrayElementCount( count );
+
+	// Payloads are opaque pointers into module data, so only their stringified form is captured,
+	// along with the payload kind a replay needs to rebuild it
+	for(int i = 0; i < count; i++)
+	{
+		auto metatag = metatags->GetArrayElement( i );
+
+		metatag->SetMemberString( "name", data[i].m_pszName );
+		metatag->SetMemberString( "kind", SchemaMetadataToString::GetPayloadKind( &data[i] ) );
+		metatag->SetMemberString( "value", SchemaMetadataToString::Eval( &data[i] ).c_str() );
 	}
 }
 
-void SchemaReader::ReadPulseDomainsInfo( KeyValues3 *root, std::map<std::string, KeyValues3 *> &domains )
-{
-	CUtlVector<const CSchemaClassInfo *> classes;
-	SchemaSystem()->FindClassesByMeta( MPulseInstanceDomainInfo::Tag(), SCHEMA_ITER_MULTI_PARENT, &classes );
+static void WriteCaptureType( KeyValues3 *root, CSchemaType *type )
+{
+	int size = 0;
+	uint8 alignment = 0;
+
+	if(type->m_eTypeCategory != SCHEMA_TYPE_BITFIELD)
+		type->GetSizeAndAlignment( size, alignment );
+
+	root->SetMemberString( "name", type->m_sTypeName.Get() );
+	root->SetMemberInt( "category", type->m_eTypeCategory );
+	root->SetMemberInt( "size", size );
+	root->SetMemberInt( "alignment", alignment );
+
+	switch(type->m_eTypeCategory)
+	{
+		case SCHEMA_TYPE_BUILTIN:
+		{
+			root->SetMemberInt( "builtin", type->ReinterpretAs<CSchemaType_Builtin>()->m_eBuiltinType );
+			break;
+		}
+
+		// Declared types are referenced by name within their scope, their contents are captured with the scope
+		case SCHEMA_TYPE_DECLARED_CLASS:
+		case SCHEMA_TYPE_DECLARED_ENUM:
+		{
+			root->SetMemberString( "scope", type->m_pTypeScope->GetScopeName() );
+			break;
+		}
+
+		case SCHEMA_TYPE_POINTER:
+		{
+			WriteCaptureType( root->FindOrCreateMember( "inner" ), type->ReinterpretAs<CSchemaType_Ptr>()->GetInnerType().Get() );
+			break;
+		}
+
+		case SCHEMA_TYPE_FIXED_ARRAY:
+		{
+			auto fixed_array = type->ReinterpretAs<CSchemaType_FixedArray>();
+
+			root->SetMemberInt( "count", fixed_array->m_nElementCount );
+			root->SetMemberInt( "element_size", fixed_array->m_nElementSize );
+			root->SetMemberInt( "element_alignment", fixed_array->m_nElementAlignment );
+			WriteCaptureType( root->FindOrCreateMember( "inner" ), fixed_array->GetInnerType().Get() );
+			break;
+		}
+
+		case SCHEMA_TYPE_BITFIELD:
+		{
+			root->SetMemberInt( "count", type->ReinterpretAs<CSchemaType_Bitfield>()->m_nBitfieldCount );
+			break;
+		}
+
+		case SCHEMA_TYPE_ATOMIC:
+		{
+			auto atomic_info = type->ReinterpretAs<CSchemaType_Atomic>()->m_pAtomicInfo;
+
+			root->SetMemberInt( "atomic_category", type->m_eAtomicCategory );
+			root->SetMemberInt( "atomic_token", atomic_info ? atomic_info->m_nAtomicID : -1 );
 
-	for(int i = 0; i < classes.Count(); i++)
-	{
-		auto ci = classes[i];
+			auto templ = root->FindOrCreateMember( "template" );
+			templ->SetToEmptyArray();
 
-		if(auto metatag = SchemaMetadataIterator( ci->m_pStaticMetadata, ci->m_nStaticMetadataCount ).FindTag( MPulseInstanceDomainInfo::Tag() ))
-		{
-			if(auto meta_binding = MPulseInstanceDomainInfo::From( metatag ))
+			switch(type->m_eAtomicCategory)
 			{
-				if(auto domain_info = meta_binding->Value())
+				case SCHEMA_ATOMIC_T:
 				{
-					auto iter = domains.find( domain_info->m_Name.Get() );
-					KeyValues3 *domain;
-					
-					if(iter != domains.end())
-					{
-						domain = iter->second;
+					WriteCaptureType( templ->ArrayAddElementToTail(), type->ReinterpretAs<CSchemaType_Atomic_T>()->m_pTemplateType );
+					break;
+				}
 
-						domain->SetMemberString( "description", domain_info->m_Description.Get() );
-						domain->SetMemberString( "friendly_name", domain_info->m_FriendlyName.Get() );
-						domain->SetMemberString( "cursor", domain_info->m_CursorName.Get() );
-					}
+				case SCHEMA_ATOMIC_COLLECTION_OF_T:
+				{
+					auto atomic = type->ReinterpretAs<CSchemaType_Atomic_CollectionOfT>();
+
+					root->SetMemberInt( "element_size", atomic->m_nElementSize );
+					root->SetMemberUInt64( "fixed_buffer_count", atomic->m_nFixedBufferCount );
+					WriteCaptureType( templ->ArrayAddElementToTail(), atomic->m_pTemplateType );
+					break;
+				}
+
+				case SCHEMA_ATOMIC_TT:
+				{
+					auto atomic = type->ReinterpretAs<CSchemaType_Atomic_TT>();
+
+					WriteCaptureType( templ->ArrayAddElementToTail(), atomic->m_pTemplateType );
+					WriteCaptureType( templ->ArrayAddElementToTail(), atomic->m_pTemplateType2 );
+					break;
+				}
+
+				case SCHEMA_ATOMIC_I:
+				{
+					root->SetMemberInt( "integer", type->ReinterpretAs<CSchemaType_Atomic_I>()->m_nInteger );
+					break;
 				}
 			}
+
+			break;
 		}
 	}
 }
 
-void SchemaReader::ReadPulseBindings()
+static void WriteCaptureClass( KeyValues3 *root, CSchemaType_DeclaredClass *type )
 {
-	if(!IsDumpingPulseBindings())
+	root->SetMemberString( "name", type->m_sTypeName.Get() );
+
+	auto ci = type->m_pClassInfo;
+	if(!ci)
 		return;
 
-	META_CONPRINTF( "Reading pulse_bindings...\n" );
+	root->SetMemberString( "project", ci->m_pszProjectName );
+	root->SetMemberInt( "size", ci->m_nSize );
+	root->SetMemberInt( "alignment", ci->m_nAlignment );
+	root->SetMemberUInt( "flags1", ci->m_nFlags1 );
+	root->SetMemberUInt( "flags2", ci->m_nFlags2 );
+	root->SetMemberUShort( "multi_depth", ci->m_nMultipleInheritanceDepth );
+	root->SetMemberUShort( "single_depth", ci->m_nSingleInheritanceDepth );
 
-	auto pulse_bindings = GetRoot()->FindOrCreateMember( "pulse_bindings" );
-	pulse_bindings->SetArrayElementCount( 0 );
+	if(HasReadableClassMetadata( ci ))
+		WriteCaptureMetaTags( root, ci->m_pStaticMetadata, ci->m_nStaticMetadataCount );
 
-	std::map<std::string, KeyValues3 *> domains;
-	ReadPulseDomains<MPulseLibraryBindings>( pulse_bindings, domains );
-	ReadPulseDomains<MPulseCellMethodBindings>( pulse_bindings, domains );
+	auto bases = root->FindOrCreateMember( "bases" );
+	bases->SetArrayElementCount( ci->m_nBaseClassCount );
 
-	ReadPulseDomainsInfo( pulse_bindings, domains );
-}
+	for(int i = 0; i < ci->m_nBaseClassCount; i++)
+	{
+		auto base = bases->GetArrayElement( i );
+		auto base_type = ci->m_pBaseClasses[i].m_pClass->m_pDeclaredClass;
 
-void SchemaReader::ReadModuleMetadata()
-{
-	if(!IsDumpingModuleMetadata())
-		return;
+		base->SetMemberString( "name", base_type->m_sTypeName.Get() );
+		base->SetMemberString( "scope", base_type->m_pTypeScope->GetScopeName() );
+		base->SetMemberUInt( "offset", ci->m_pBaseClasses[i].m_nOffset );
+	}
 
-#ifndef PLATFORM_WINDOWS
-	META_CONPRINTF( "Reading module metadata is only supported on windows, skipping...\n" );
-#else
-	META_CONPRINTF( "Reading module metadata...\n" );
+	auto fields = root->FindOrCreateMember( "fields" );
+	fields->SetArrayElementCount( ci->m_nFieldCount );
 
-	auto modules_metadata = GetRoot()->FindOrCreateMember( "modules_metadata" );
-	modules_metadata->SetArrayElementCount( 0 );
+	for(int i = 0; i < ci->m_nFieldCount; i++)
+	{
+		auto &field = ci->m_pFields[i];
+		auto kv = fields->GetArrayElement( i );
 
-	HANDLE snapshot = CreateToolhelp32Snapshot( TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, GetCurrentProcessId() );
+		kv->SetMemberString( "name", field.m_pszName );
+		kv->SetMemberInt( "offset", field.m_nSingleInheritanceOffset );
+		WriteCaptureMetaTags( kv, field.m_pStaticMetadata, field.m_nStaticMetadataCount );
+		WriteCaptureType( kv->FindOrCreateMember( "type" ), field.m_pType );
+	}
+}
 
-	if(snapshot != INVALID_HANDLE_VALUE)
-	{
-		MODULEENTRY32 module_entry = { sizeof( module_entry ) };
-		if(Module32First( snapshot, &module_entry ))
-		{
-			do
-			{
-				if(module_entry.hModule)
-				{
-					auto func = (KeyValues3 * (*)(CUtlString *))GetProcAddress( module_entry.hModule, "ExtractModuleMetadata" );
-					if(func)
-					{
-						CUtlString additional_info;
-						auto metadata = func( &additional_info );
+static void WriteCaptureEnum( KeyValues3 *root, CSchemaType_DeclaredEnum *type )
+{
+	root->SetMemberString( "name", type->m_sTypeName.Get() );
 
-						if(metadata->IsNull())
-							continue;
+	auto ei = type->m_pEnumInfo;
+	if(!ei)
+		return;
 
-						auto entry = modules_metadata->ArrayAddElementToTail();
+	root->SetMemberString( "project", ei->m_pszProjectName );
+	root->SetMemberInt( "size", ei->m_nSize );
+	root->SetMemberInt( "alignment", ei->m_nAlignment );
+	root->SetMemberUInt( "flags", ei->m_nFlags );
+	root->SetMemberInt64( "min_value", ei->m_nMinEnumeratorValue );
+	root->SetMemberInt64( "max_value", ei->m_nMaxEnumeratorValue );
 
-						*entry = *metadata;
-						entry->SetMemberString( "module_name", module_entry.szModule );
+	WriteCaptureMetaTags( root, ei->m_pStaticMetadata, ei->m_nStaticMetadataCount );
 
-						if(!additional_info.IsEmpty())
-							entry->SetMemberString( "additional_info", additional_info );
-					}
-					
-				}
+	auto enumerators = root->FindOrCreateMember( "enumerators" );
+	enumerators->SetArrayElementCount( ei->m_nEnumeratorCount );
 
-			} while(Module32Next( snapshot, &module_entry ));
-		}
+	for(int i = 0; i < ei->m_nEnumeratorCount; i++)
+	{
+		auto &enumerator = ei->m_pEnumerators[i];
+		auto kv = enumerators->GetArrayElement( i );
 
-		CloseHandle( snapshot );
+		kv->SetMemberString( "name", enumerator.m_pszName );
+		kv->SetMemberInt64( "value", enumerator.m_nValue );
+		WriteCaptureMetaTags( kv, enumerator.m_pStaticMetadata, enumerator.m_nStaticMetadataCount );
 	}
-#endif
 }
 
-CSchemaType_DeclaredClass *SchemaReader::FindSchemaTypeInTypeScopes( const char *name )
+static void WriteCaptureScope( KeyValues3 *root, CSchemaSystemTypeScope *ts )
 {
-	auto ci = SchemaSystem()->FindClassByScopedName( name ).Get();
+	root->SetMemberString( "name", ts->GetScopeName() );
 
-	if(ci)
-		return ci->m_pDeclaredClass;
-	
-	for(int i = 0; i < SchemaSystem()->m_TypeScopes.GetNumStrings(); i++)
+	std::vector<CSchemaType_DeclaredClass *> classes;
+	FOR_EACH_MAP( ts->m_DeclaredClasses.m_Map, iter )
 	{
-		auto ts = SchemaSystem()->m_TypeScopes[i];
-		ci = ts->FindDeclaredClass( name ).Get();
-		
-		if(ci)
-			return ci->m_pDeclaredClass;
+		classes.push_back( ts->m_DeclaredClasses.m_Map.Element( iter ) );
 	}
 
-	return nullptr;
-}
-
-bool SchemaReader::ApplyNetVarOverrides( CSchemaType_DeclaredClass *type )
-{
-	if(!IsApplyingNetVarOverrides())
-		return true;
-	
-	auto ci = type->m_pClassInfo;
+	std::vector<CSchemaType_DeclaredEnum *> enums;
+	FOR_EACH_MAP( ts->m_DeclaredEnums.m_Map, iter )
+	{
+		enums.push_back( ts->m_DeclaredEnums.m_Map.Element( iter ) );
+	}
 
-	if(!ci || ci->m_nBaseClassCount <= 0)
-		return true;
+	SortSchemaTypes( classes );
+	SortSchemaTypes( enums );
 
-	for(auto &meta : SchemaMetadataIterator( ci->m_pStaticMetadata, ci->m_nStaticMetadataCount ))
-	{
-		if(auto var_override = MNetworkVarTypeOverride::From( &meta ))
-		{
-			auto var_ci = FindSchemaTypeInTypeScopes( var_override->Value().m_TypeName );
+	auto classes_kv = root->FindOrCreateMember( "classes" );
+	classes_kv->SetArrayElementCount( (int)classes.size() );
 
-			if(!var_ci)
-			{
-				if(IsVerboseLogging())
-				{
-					META_CONPRINTF( "Failed to find type override (%s) for class (%s)\n", var_override->Value().m_TypeName, ci->m_pszName );
-				}
+	for(int i = 0; i < (int)classes.size(); i++)
+		WriteCaptureClass( classes_kv->GetArrayElement( i ), classes[i] );
 
-				continue;
-			}
+	auto enums_kv = root->FindOrCreateMember( "enums" );
+	enums_kv->SetArrayElementCount( (int)enums.size() );
 
-			auto idx = ReadDeclClass( var_ci->ReinterpretAs<CSchemaType_DeclaredClass>() );
+	for(int i = 0; i < (int)enums.size(); i++)
+		WriteCaptureEnum( enums_kv->GetArrayElement( i ), enums[i] );
 
-			if(idx == -1)
-			{
-				if(IsVerboseLogging())
-				{
-					META_CONPRINTF( "Failed to find type override (%s) for class (%s) not initialized\n", var_override->Value().m_TypeName, ci->m_pszName );
-				}
+	auto atomics_kv = root->FindOrCreateMember( "atomics" );
+	atomics_kv->SetToEmptyArray();
 
-				continue;
-			}
+	FOR_EACH_MAP( ts->m_AtomicInfos.m_Map, iter )
+	{
+		auto info = ts->m_AtomicInfos.m_Map.Element( iter ).Get();
+		auto atomic = atomics_kv->ArrayAddElementToTail();
 
-			ApplyNetVarOverrides( type, var_override->Value().m_FieldName, idx );
-		}
+		atomic->SetMemberString( "name", info->m_pszName );
+		atomic->SetMemberInt( "token", info->m_nAtomicID );
+		WriteCaptureMetaTags( atomic, info->m_pStaticMetadata, info->m_nStaticMetadataCount );
 	}
-
-	return true;
 }
 
-bool SchemaReader::ApplyNetVarOverrides( CSchemaType_DeclaredClass *root, const char *field_to_overwrite, int type_override_idx )
+bool SchemaReader::WriteCapture( SchemaDumpProfile *profile )
 {
-	auto ci = root->m_pClassInfo;
+	META_CONPRINTF( "Capturing schema...\n" );
 
-	if(!ci)
-		return true;
+	CKV3Arena context( false );
+	auto root = context.Root();
 
-	for(int i = 0; i < ci->m_nFieldCount; i++)
-	{
-		auto &field = ci->m_pFields[i];
+	root->SetMemberInt( "capture_version", SR_CAPTURE_FORMAT_VERSION );
 
-		if(std::strcmp( field.m_pszName, field_to_overwrite ) == 0)
-		{
-			auto def = FindDefEntry( root );
+	auto scopes = root->FindOrCreateMember( "scopes" );
+	scopes->SetArrayElementCount( SchemaSystem()->m_TypeScopes.GetNumStrings() + 1 );
 
-			if(!def)
-			{
-				if(IsVerboseLogging())
-				{
-					META_CONPRINTF( "Failed to apply netvar override (%s) due to type (%s) being not yet initialized.\n", field_to_overwrite, ci->m_pszName );
-				}
+	WriteCaptureScope( scopes->GetArrayElement( 0 ), SchemaSystem()->GlobalTypeScope() );
 
-				return true;
-			}
+	for(int i = 0; i < SchemaSystem()->m_TypeScopes.GetNumStrings(); i++)
+		WriteCaptureScope( scopes->GetArrayElement( i + 1 ), SchemaSystem()->m_TypeScopes[i] );
 
-			auto traits = def->FindMember( "traits" );
+	// Json, so offline tools (see generator_scripts/capture_stats.py) can load it without a kv3 parser
+	CUtlString err, out;
+	SaveKV3AsJSON( root, &err, &out );
 
-			if(!traits)
-				return true;
-			
-			auto members = traits->FindMember( "members" );
+	if(!err.IsEmpty())
+	{
+		META_CONPRINTF( "Failed to save capture as json! Reason: \"%s\"\n", err.Get() );
+		return false;
+	}
 
-			if(!members)
-				return true;
+	return WriteToFile( GetOutFileName( profile, "_capture.json" ), out.Get(), out.Length() );
+}
 
-			for(int k = 0; k < members->GetArrayElementCount(); k++)
-			{
-				auto member = members->GetArrayElement( k );
+// Max amount of bytes passed to a single write call, large enough to not be syscall bound
+// while still fitting into a DWORD for WriteFile
+static constexpr size_t s_MaxWriteChunk = 64 * 1024 * 1024;
 
-				if(std::strcmp( member->GetMemberString( "name" ), field_to_overwrite ) == 0)
-				{
-					auto mem_traits = member->FindMember( "traits" );
-					if(!mem_traits)
-						break;
-					
-					auto subtype = mem_traits->FindMember( "subtype" );
-					do
-					{
-						if(std::strcmp( subtype->GetMemberString( "type" ), "ref" ) == 0)
-						{
-							subtype->SetMemberInt( "ref_idx", type_override_idx );
-							return true;
-						}
+#if PLATFORM_WINDOWS
+static std::string LastErrorToString( const char *op )
+{
+	char buf[256];
+	std::snprintf( buf, sizeof( buf ), "%s failed (error %lu)", op, GetLastError() );
+	return buf;
+}
 
-						subtype = subtype->FindMember( "subtype" );
+static bool WriteFileDurable( const std::filesystem::path &path, const char *content, size_t size, std::string &err )
+{
+	HANDLE file = CreateFileW( path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		err = LastErrorToString( "CreateFile" );
+		return false;
+	}
 
-					} while(subtype);
+	// Preallocate the whole file upfront so the filesystem can lay it out in one go
+	LARGE_INTEGER file_size, file_start = {};
+	file_size.QuadPart = (LONGLONG)size;
+	if(!SetFilePointerEx( file, file_size, nullptr, FILE_BEGIN ) || !SetEndOfFile( file ) || !SetFilePointerEx( file, file_start, nullptr, FILE_BEGIN ))
+	{
+		err = LastErrorToString( "Preallocation" );
+		CloseHandle( file );
+		return false;
+	}
 
-					return true;
-				}
-			}
+	size_t written = 0;
+	while(written < size)
+	{
+		DWORD chunk = (DWORD)(std::min)( size - written, s_MaxWriteChunk );
+		DWORD chunk_written = 0;
 
-			if(IsVerboseLogging())
-			{
-				META_CONPRINTF( "Failed to apply netvar override (%s) due to missing member field in kv.\n", field_to_overwrite );
-			}
+		if(!WriteFile( file, content + written, chunk, &chunk_written, nullptr ))
+		{
+			err = LastErrorToString( "WriteFile" );
+			CloseHandle( file );
+			return false;
+		}
 
-			return true;
+		// No progress without an error would otherwise loop forever
+		if(chunk_written == 0)
+		{
+			err = "WriteFile failed (no bytes written)";
+			CloseHandle( file );
+			return false;
 		}
+
+		written += chunk_written;
 	}
 
-	for(int i = 0; i < ci->m_nBaseClassCount; i++)
+	if(!FlushFileBuffers( file ))
 	{
-		auto &baseclass = ci->m_pBaseClasses[i];
+		err = LastErrorToString( "FlushFileBuffers" );
+		CloseHandle( file );
+		return false;
+	}
 
-		if(ApplyNetVarOverrides( baseclass.m_pClass->m_pDeclaredClass, field_to_overwrite, type_override_idx ))
-			return true;
+	if(!CloseHandle( file ))
+	{
+		err = LastErrorToString( "CloseHandle" );
+		return false;
 	}
 
 	return true;
 }
 
-void SchemaReader::LinkChildParentScopeDecls( KeyValues3 *child_traits, CSchemaType *child, int child_idx )
+static bool PublishFile( const std::filesystem::path &from, const std::filesystem::path &to, std::string &err )
 {
-	if(IsIgnoringParentScopes())
-		return;
+	if(!MoveFileExW( from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ))
+	{
+		err = LastErrorToString( "MoveFileEx" );
+		return false;
+	}
 
-	// Account for classes/structs defined within other classes/structs
-	CSplitString class_scoping( child->m_sTypeName.Get(), "::" );
-	if(class_scoping.Count() > 1)
+	return true;
+}
+#else
+static std::string ErrnoToString( const char *op, int error = errno )
+{
+	return std::string( op ) + " failed (" + std::strerror( error ) + ")";
+}
+
+static bool WriteFileDurable( const std::filesystem::path &path, const char *content, size_t size, std::string &err )
+{
+	int fd = open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+	if(fd == -1)
 	{
-		auto parent_type = FindSchemaTypeInTypeScopes( class_scoping[class_scoping.Count() - 2] );
+		err = ErrnoToString( "open" );
+		return false;
+	}
 
-		if(!parent_type)
+	// Preallocate the whole file upfront so the filesystem can lay it out in one go,
+	// not every filesystem supports it so only treat running out of space as an error
+	if(size > 0)
+	{
+		int result = posix_fallocate( fd, 0, (off_t)size );
+		if(result == ENOSPC || result == EFBIG)
 		{
-			if(IsVerboseLogging())
-				META_CONPRINTF( "Failed to find parent scope class for \"%s\".\n", child->m_sTypeName.Get() );
-
-			// Let child class to know that parent decl is unavailable
-			child_traits->FindOrCreateMember( "parent_class_idx" )->SetInt( -1 );
-			return;
+			err = ErrnoToString( "posix_fallocate", result );
+			close( fd );
+			return false;
 		}
+	}
 
-		auto parent_idx = ReadDeclClass( parent_type );
-		auto parent_def = FindDefEntry( parent_idx );
-		auto parent_traits = parent_def->FindOrCreateMember( "traits" );
+	size_t written = 0;
+	while(written < size)
+	{
+		ssize_t result = write( fd, content + written, (std::min)( size - written, s_MaxWriteChunk ) );
 
-		// Add a ref of child class decl to parent decl
-		auto child_class_decls = parent_traits->FindOrCreateMember( "child_class_idx" );
-		child_class_decls->ArrayAddElementToTail()->SetInt( child_idx );
+		if(result < 0)
+		{
+			if(errno == EINTR)
+				continue;
 
-		// Add a ref of parent class decl to child decl
-		child_traits->FindOrCreateMember( "parent_class_idx" )->SetInt( parent_idx );
-	}
-}
+			err = ErrnoToString( "write" );
+			close( fd );
+			return false;
+		}
 
-bool SchemaReader::WriteToOutDir()
-{
-	bool success = WriteToKV3();
-	success |= WriteToJSON();
+		// No progress without an error would otherwise loop forever
+		if(result == 0)
+		{
+			err = "write failed (no bytes written)";
+			close( fd );
+			return false;
+		}
 
-	return success;
-}
+		written += (size_t)result;
+	}
 
-bool SchemaReader::WriteToKV3()
-{
-	if(!IsDumpingToKV3())
+	if(fsync( fd ) != 0)
+	{
+		err = ErrnoToString( "fsync" );
+		close( fd );
 		return false;
+	}
 
-	CUtlString err, out;
-	SaveKV3Text_ToString( g_KV3Encoding_Text, GetRoot(), &err, &out );
-
-	if(!err.IsEmpty())
+	if(close( fd ) != 0)
 	{
-		META_CONPRINTF( "Failed to save kv3 to file! Reason: \"%s\"\n", err.Get() );
+		err = ErrnoToString( "close" );
 		return false;
 	}
 
-	auto t = std::time( nullptr );
-	auto tm = *std::localtime( &t );
-	std::ostringstream ss;
-
-	ss << std::put_time( &tm, "%d%m%y" ) << ".kv3";
-
-	return WriteToFile( ss.str(), out.Get() );
+	return true;
 }
 
-bool SchemaReader::WriteToJSON()
+static bool PublishFile( const std::filesystem::path &from, const std::filesystem::path &to, std::string &err )
 {
-	if(!IsDumpingToJSON())
+	if(std::rename( from.c_str(), to.c_str() ) != 0)
+	{
+		err = ErrnoToString( "rename" );
 		return false;
+	}
 
-	CUtlString err, out;
-	SaveKV3AsJSON( GetRoot(), &err, &out );
-
-	if(!err.IsEmpty())
+	// Persist the directory entry as well, otherwise rename itself might not survive a crash
+	int dir_fd = open( to.parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+	if(dir_fd != -1)
 	{
-		META_CONPRINTF( "Failed to save kv3 as json! Reason: \"%s\"\n", err.Get() );
-		return false;
+		fsync( dir_fd );
+		close( dir_fd );
 	}
 
-	auto t = std::time( nullptr );
-	auto tm = *std::localtime( &t );
-	std::ostringstream ss;
+	return true;
+}
+#endif
 
-	ss << std::put_time( &tm, "%d%m%y" ) << ".json";
+bool SchemaReader::WriteToFile( const std::string &filename, const char *content, size_t size )
+{
+	ValidateOutDir();
 
-	return WriteToFile( ss.str(), out.Get() );
+	return WriteFileAtomic( m_OutPath / filename, content, size );
 }
 
-bool SchemaReader::WriteToFile( const std::string &filename, const char *content )
+bool SchemaReader::WriteFileAtomic( const std::filesystem::path &file_path, const char *content, size_t size )
 {
-	ValidateOutDir();
+	// Write everything to a temp file first and only then move it in place,
+	// so readers never observe a partially written dump
+	auto tmp_path = file_path;
+	tmp_path += ".tmp";
+
+	auto start = std::chrono::steady_clock::now();
 
-	auto file_path = m_OutPath / filename;
-	std::ofstream fs( file_path );
+	std::string err;
+	if(!WriteFileDurable( tmp_path, content, size, err ) || !PublishFile( tmp_path, file_path, err ))
+	{
+		META_CONPRINTF( "Failed to write file output to %s! Reason: \"%s\"\n", file_path.string().c_str(), err.c_str() );
+
+		std::error_code ec;
+		std::filesystem::remove( tmp_path, ec );
 
-	fs << content;
+		return false;
+	}
 
-	fs.close();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	double size_mb = (double)size / (1024.0 * 1024.0);
 
-	META_CONPRINTF( "Wrote file output to %s\n", file_path.string().c_str() );
+	META_CONPRINTF( "Wrote file output to %s (%.2f MB in %.3fs, %.2f MB/s)\n", file_path.string().c_str(), size_mb, elapsed.count(),
+					elapsed.count() > 0.0 ? size_mb / elapsed.count() : 0.0 );
 
 	return true;
 }
@@ -4,14 +4,26 @@
 #include "schemasystem/schematypes.h"
 
 #include "keyvalues3.h"
+#include "schemalayout.h"
+#include "schemamodules.h"
+#include "schematypememo.h"
 
+#include <algorithm>
 #include <map>
+#include <unordered_map>
+#include <deque>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include <memory>
+#include <type_traits>
 #include <filesystem>
 #include <fstream>
 #include <string>
 #include <cstring>
 
-#define DUMPER_FILE_FORMAT_VERSION 1
+#define DUMPER_FILE_FORMAT_VERSION 2
+#define SR_CAPTURE_FORMAT_VERSION 2
 
 template <typename T>
 constexpr const char *SchemaTypeToString() = delete;
@@ -28,92 +40,505 @@ template <> constexpr const char *SchemaTypeToString<CSchemaType_DeclaredEnum>()
 template <> constexpr const char *SchemaTypeToString<CSchemaType_FixedArray>()		{ return "array"; }
 // template <> constexpr const char *SchemaTypeToString<CSchemaType_Bitfield>()		{ return "bitfield"; }
 
-class SchemaReader
+#define SR_MAX_DUMP_PROFILES 4
+#define SR_MISSING_PARENT_SCOPE -2
+#define SR_UNPLACED_BITFIELD -1
+
+// Kinds of type graph edges, the order matches g_EdgeKindNames
+enum SchemaTypeEdgeKind
+{
+	SR_EDGE_BASE = 0,
+	SR_EDGE_MEMBER_VALUE,
+	SR_EDGE_MEMBER_PTR,
+	SR_EDGE_ATOMIC_ARG,
+	SR_EDGE_NETVAR_OVERRIDE,
+	SR_EDGE_PARENT_SCOPE,
+
+	SR_EDGE_COUNT
+};
+
+inline const char *g_EdgeKindNames[SR_EDGE_COUNT] = {
+	"base", "member_value", "member_ptr", "atomic_arg", "netvar_override", "parent_scope"
+};
+
+class CPulseLibraryBinding;
+class CPulseDomainInfo;
+struct PulseParamType;
+
+// A single output profile of a dump, every profile gets its own kv3 tree and output file
+// while the schema traversal itself is shared between all of them
+struct SchemaDumpProfile
+{
+	SchemaDumpProfile( uint32 flags, const std::string &name ) : m_KV3Context( false ), m_Flags( flags ), m_Name( name ) {}
+
+	bool HasFlag( uint32 flag ) const { return (m_Flags & flag) != 0; }
+	bool HasAllFlags( uint32 flags ) const { return (m_Flags & flags) == flags; }
+	KeyValues3 *GetRoot() { return m_KV3Context.Root(); }
+
+	CKV3Arena m_KV3Context;
+	uint32 m_Flags;
+
+	// Used as an output file name suffix when dumping multiple profiles at once
+	std::string m_Name;
+};
+
+// Deduplicated storage of strings written to a dump, every distinct string is stored once
+// and is referenced either as an external kv3 string or by its index in the root strings table
+class SchemaStringTable
+{
+public:
+	int Intern( const char *str );
+
+	const char *Get( int idx ) const { return m_Strings[idx].c_str(); }
+	int Count() const { return (int)m_Strings.size(); }
+
+	void Reserve( int count ) { m_Lookup.reserve( count ); }
+	size_t BucketCount() const { return m_Lookup.bucket_count(); }
+
+private:
+	// Deque never relocates its elements, so views used as lookup keys stay valid
+	std::deque<std::string> m_Strings;
+	std::unordered_map<std::string_view, int> m_Lookup;
+};
+
+inline int SchemaStringTable::Intern( const char *str )
+{
+	if(!str)
+		str = "";
+
+	auto iter = m_Lookup.find( str );
+	if(iter != m_Lookup.end())
+		return iter->second;
+
+	int idx = (int)m_Strings.size();
+	m_Lookup.emplace( m_Strings.emplace_back( str ), idx );
+
+	return idx;
+}
+
+// Mirrors the same logical kv3 node across multiple dump profiles,
+// so that a single schema traversal writes to every profile at once
+class KV3Fanout
 {
 public:
-	SchemaReader() : m_KV3Context( false ) {}
+	int Count() const { return m_Count; }
+	bool IsEmpty() const { return m_Count == 0; }
+
+	KeyValues3 *Node( int i ) const { return m_Nodes[i]; }
+	SchemaDumpProfile *Profile( int i ) const { return m_Profiles[i]; }
+
+	void Add( KeyValues3 *node, SchemaDumpProfile *profile )
+	{
+		m_Nodes[m_Count] = node;
+		m_Profiles[m_Count] = profile;
+		m_Count++;
+	}
 
-	void ReadSchema( uint32 flags = SR_NONE );
+	// Returns nodes of profiles that have (or don't have) the flag set
+	KV3Fanout Where( uint32 flag ) const { return Filter( flag, true ); }
+	KV3Fanout WhereNot( uint32 flag ) const { return Filter( flag, false ); }
+
+	// Returns nodes of profiles that have all of the flags set (or miss any of them)
+	KV3Fanout WhereAll( uint32 flags ) const { return FilterAll( flags, true ); }
+	KV3Fanout WhereNotAll( uint32 flags ) const { return FilterAll( flags, false ); }
+
+	// Nodes are expected to be structurally identical, so created state is reported from the first one
+	KV3Fanout FindOrCreateMember( const char *name, bool *created = nullptr ) const
+	{
+		KV3Fanout result;
+		for(int i = 0; i < m_Count; i++)
+			result.Add( m_Nodes[i]->FindOrCreateMember( name, i == 0 ? created : nullptr ), m_Profiles[i] );
+		return result;
+	}
+
+	KV3Fanout ArrayAddElementToTail() const
+	{
+		KV3Fanout result;
+		for(int i = 0; i < m_Count; i++)
+			result.Add( m_Nodes[i]->ArrayAddElementToTail(), m_Profiles[i] );
+		return result;
+	}
+
+	KV3Fanout GetArrayElement( int idx ) const
+	{
+		KV3Fanout result;
+		for(int i = 0; i < m_Count; i++)
+			result.Add( m_Nodes[i]->GetArrayElement( idx ), m_Profiles[i] );
+		return result;
+	}
+
+	void SetArrayElementCount( int count ) const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetArrayElementCount( count ); }
+	void SetToEmptyArray() const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetToEmptyArray(); }
+	void SetString( const char *value ) const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetString( value ); }
+	void SetStringExternal( const char *value ) const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetStringExternal( value ); }
+	void SetInt( int value ) const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetInt( value ); }
+
+	void SetIntArray( const int *values, int count ) const
+	{
+		for(int i = 0; i < m_Count; i++)
+		{
+			m_Nodes[i]->SetArrayElementCount( count );
+
+			for(int k = 0; k < count; k++)
+				m_Nodes[i]->GetArrayElement( k )->SetInt( values[k] );
+		}
+	}
+
+	void SetMemberString( const char *name, const char *value ) const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetMemberString( name, value ); }
+	void SetMemberInt( const char *name, int value ) const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetMemberInt( name, value ); }
+	void SetMemberUInt( const char *name, uint32 value ) const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetMemberUInt( name, value ); }
+	void SetMemberInt64( const char *name, int64 value ) const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetMemberInt64( name, value ); }
+	void SetMemberUInt64( const char *name, uint64 value ) const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetMemberUInt64( name, value ); }
+	void SetMemberUInt8( const char *name, uint8 value ) const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetMemberUInt8( name, value ); }
+	void SetMemberUShort( const char *name, uint16 value ) const { for(int i = 0; i < m_Count; i++) m_Nodes[i]->SetMemberUShort( name, value ); }
+
+	// Profiles with interned strings get an index into the root strings table,
+	// others reference the table storage directly, so the string isn't copied into every arena
+	void SetMemberInterned( const char *name, const char *value, SchemaStringTable &table ) const { FindOrCreateMember( name ).SetInterned( value, table ); }
+	void SetInterned( const char *value, SchemaStringTable &table ) const;
+
+private:
+	KV3Fanout Filter( uint32 flag, bool state ) const
+	{
+		KV3Fanout result;
+		for(int i = 0; i < m_Count; i++)
+		{
+			if(m_Profiles[i]->HasFlag( flag ) == state)
+				result.Add( m_Nodes[i], m_Profiles[i] );
+		}
+		return result;
+	}
+
+	KV3Fanout FilterAll( uint32 flags, bool state ) const
+	{
+		KV3Fanout result;
+		for(int i = 0; i < m_Count; i++)
+		{
+			if(m_Profiles[i]->HasAllFlags( flags ) == state)
+				result.Add( m_Nodes[i], m_Profiles[i] );
+		}
+		return result;
+	}
+
+	KeyValues3 *m_Nodes[SR_MAX_DUMP_PROFILES];
+	SchemaDumpProfile *m_Profiles[SR_MAX_DUMP_PROFILES];
+	int m_Count = 0;
+};
+
+class SchemaReader
+{
+public:
+	// Reads schema once and produces an output for every profile flags entry provided,
+	// returns false if the profiles can't be dumped together
+	bool ReadSchema( const std::vector<uint32> &profiles );
 
 	// Outdir is relative to plugin folder
 	void SetOutDir( const std::filesystem::path &out_dir );
 	const std::filesystem::path &GetOutDir() const { return m_OutPath; }
 
 	bool WriteToOutDir();
-	bool WriteToKV3();
-	bool WriteToJSON();
+	bool WriteToKV3( SchemaDumpProfile *profile );
+	bool WriteToJSON( SchemaDumpProfile *profile );
+	bool WriteLayoutReport( SchemaDumpProfile *profile );
+	bool WriteNetReport( SchemaDumpProfile *profile );
+
+	// Writes raw schema data the reader consumes to a separate file, independent of the profile flags
+	bool WriteCapture( SchemaDumpProfile *profile );
 
 	static uint32 ParseDumpFlags( const char *flags );
 
-	static bool IsVerboseLogging() { return (s_Flags & SR_VERBOSE_LOGGING) != 0; }
-	static bool IsDumpingToJSON() { return (s_Flags & SR_DUMP_AS_JSON) != 0; }
-	static bool IsDumpingToKV3() { return (s_Flags & SR_DUMP_AS_KV3) != 0; }
-	static bool IsDumpingMetaTags() { return (s_Flags & SR_DUMP_METATAGS) != 0; }
-	static bool IsDumpingAtomics() { return (s_Flags & SR_DUMP_ATOMICS) != 0; }
-	static bool IsDumpingPulseBindings() { return (s_Flags & SR_DUMP_PULSE_BINDINGS) != 0; }
-	static bool IsDumpingModuleMetadata() { return (s_Flags & SR_DUMP_MODULE_METADATA) != 0; }
-	static bool IsSplittingAtomicNames() { return (s_Flags & SR_SPLIT_ATOMIC_NAMES) != 0; }
-	static bool IsIgnoringParentScopes() { return (s_Flags & SR_IGNORE_PARENT_SCOPE) != 0; }
-	static bool IsApplyingNetVarOverrides() { return (s_Flags & SR_APPLY_NETVAR_OVERRIDES) != 0; }
+	// Profiles are separated by '|', e.g. "all | all for_cpp" would produce two dumps out of a single read
+	static std::vector<uint32> ParseDumpProfiles( const char *profiles );
 
-private:
+	// Verbose logging is process wide as metadata stringifiers have no reader context
+	static bool IsVerboseLogging() { return s_VerboseLogging; }
+
+	// These are true if any of the profiles requested it
+	bool IsDumpingMetaTags() const { return (m_Flags & SR_DUMP_METATAGS) != 0; }
+	bool IsDumpingAtomics() const { return (m_Flags & SR_DUMP_ATOMICS) != 0; }
+	bool IsDumpingPulseBindings() const { return (m_Flags & SR_DUMP_PULSE_BINDINGS) != 0; }
+	bool IsDumpingModuleMetadata() const { return (m_Flags & SR_DUMP_MODULE_METADATA) != 0; }
+	bool IsApplyingNetVarOverrides() const { return (m_Flags & SR_APPLY_NETVAR_OVERRIDES) != 0; }
+
+	// True if any of the profiles keeps parent scope decls
+	bool IsKeepingParentScopes() const { return !GetRoots().WhereNot( SR_IGNORE_PARENT_SCOPE ).IsEmpty(); }
+
+	// Returns nullptr if schema system isn't ready yet
 	static CSchemaSystem *SchemaSystem();
 
+	// Hash of class name, size, alignment, base classes and ordered members (name, offset, type name)
+	static uint64 ComputeLayoutHash( CSchemaType_DeclaredClass *type );
+	static std::string LayoutHashToString( uint64 hash );
+
+private:
 	void ValidateOutDir();
 
-	void ReadBuiltins();
-	void ReadDeclClasses();
-	void ReadDeclEnums();
+	// Totals of everything the type scopes expose, or of what was actually dumped
+	struct SchemaTypeCounts
+	{
+		int m_nDefs = 0;
+		int m_nMembers = 0;
+		int m_nEnumFields = 0;
+		int m_nMetaTags = 0;
+		int m_nAtomics = 0;
+	};
+
+	// Counting pass over the type scopes, storage is reserved from its totals once up front,
+	// so collecting and reading never has to reallocate or rehash
+	void CountSchemaTypes( SchemaTypeCounts &counts ) const;
+	void ReserveStorage( const SchemaTypeCounts &counts );
+	void CountDumpedTypes( SchemaTypeCounts &counts ) const;
+	void ReportStorageUsage() const;
+
+	// Collects every type that would be dumped and assigns def indices to them,
+	// contents are then filled in by ReadSchemaTypes in the index order
+	void CollectSchemaTypes();
+	void CollectBuiltins();
+	void CollectDeclClasses();
+	void CollectDeclEnums();
+	void CollectMemberSchemaType( CSchemaType *type );
+	int CollectParentScope( CSchemaType *type );
+	int RequestTypeMapEntry( CSchemaType *type );
+
+	// Atomics are deduplicated by their token, as the same atomic is registered in multiple type scopes
+	void CollectAtomics();
+	int RequestAtomicEntry( SchemaAtomicTypeInfo_t *info );
+
+	// Folds types with identical contents that also reference identical types into the lowest indexed one,
+	// merged types are kept in the type map and resolve to the index of the def they were folded into
+	void DedupeProjectTypes();
+
+	// Hash of the type contents that end up in its def, layout hash for classes plus flags and metatags
+	static uint64 ComputeDedupeHash( CSchemaType *type );
+	static const char *GetProjectName( CSchemaType *type );
+
+	// Reorders collected types so dependencies are placed first, cycles are broken and reported
+	void SortSchemaTypesTopologically();
+
+	struct SchemaTypeEdge
+	{
+		int m_TargetIdx;
+		SchemaTypeEdgeKind m_Kind;
+	};
+
+	// Collects outgoing edges of a type, edges to builtins aren't included
+	void CollectTypeEdges( int idx, std::vector<SchemaTypeEdge> &edges );
+	void ReadTypeGraph();
+
+	// Labels classes with pre order intervals of the single inheritance tree, ancestors reached
+	// through secondary base classes are covered by a per class bitset instead
+	void ReadHierarchy();
+
+	struct FlattenedField
+	{
+		const char *m_pszName;
+
+		// Absolute offset, for bitfields the one of their storage unit (see ResolveBitfieldPlacements)
+		int m_nOffset;
+		int m_OriginIdx;
+		int m_MemberIdx;
+
+		// Unit size is 0 for non bitfields and SR_UNPLACED_BITFIELD for bitfields which placement was dropped,
+		// offset is meaningless for these
+		int m_nBitfieldUnitSize = 0;
+		int m_nBitfieldShift = 0;
+	};
+
+	// Layouts are built from already flattened bases, so every class is only computed once
+	void BuildFlattenedLayout( int idx, std::vector<std::vector<FlattenedField>> &layouts );
+	void BuildFlattenedLayouts( std::vector<std::vector<FlattenedField>> &layouts );
+	void ReadFlattenedLayouts( const std::vector<std::vector<FlattenedField>> &layouts );
+	void ReadLayoutReports( const std::vector<std::vector<FlattenedField>> &layouts );
+	void ReadNetReports( const std::vector<std::vector<FlattenedField>> &layouts );
+	SchemaClassFieldData_t *FindFlattenedFieldData( const FlattenedField &flat_field ) const;
+
+	void ReadSchemaTypes();
 	void ReadAtomics();
-	void ReadMemberSchemaType( KeyValues3 *root, CSchemaType *type, bool append_subtype = true );
-	int ReadDeclClass( CSchemaType_DeclaredClass *type );
-	int ReadDeclEnum( CSchemaType_DeclaredEnum *type );
-	void ReadAtomicInfo( SchemaAtomicTypeInfo_t *info );
-	void ReadMetaTags( KeyValues3 *root, SchemaMetadataEntryData_t *data, int count, bool append_traits = false );
-	void ReadFlags( KeyValues3 *root, CSchemaType *type );
+	void ReadMemberSchemaType( const KV3Fanout &root, CSchemaType *type, bool append_subtype = true );
+	void ReadDeclClass( CSchemaType_DeclaredClass *type, int idx );
+
+	// Resolves runs of consecutive bitfield members into their storage units, indexed by field index
+	void ResolveBitfieldPlacements( SchemaClassInfoData_t *ci, std::vector<SchemaBitfieldPlacement> &placements );
+	void ReadDeclEnum( CSchemaType_DeclaredEnum *type, int idx );
+
+	void ReadScopeLayoutHashes();
+	void ReadAtomicInfo( const KV3Fanout &def, SchemaAtomicTypeInfo_t *info );
+	void ReadMetaTags( const KV3Fanout &root, SchemaMetadataEntryData_t *data, int count, bool append_traits = false );
+	void ReadFlags( const KV3Fanout &root, CSchemaType *type );
 	void ReadPulseBindings();
 	void ReadModuleMetadata();
 
-	template <typename METATAG>
-	void ReadPulseDomains( KeyValues3 *root, std::map<std::string, KeyValues3 *> &domains );
+	struct PulseDomainEntry
+	{
+		KV3Fanout m_Domain;
+		KV3Fanout m_CppScopes;
+
+		// Functions arrays of the domain cpp scopes, keyed by class name
+		std::unordered_map<std::string_view, KV3Fanout> m_ScopeFunctions;
+	};
+
+	// Keyed by domain name, names are owned by the static binding data so views stay valid
+	using PulseDomainMap = std::unordered_map<std::string_view, PulseDomainEntry>;
+
+	void ReadPulseBinding( const KV3Fanout &root, PulseDomainMap &domains, const char *class_name, CPulseLibraryBinding *binding );
 	template <typename DOMAIN_FUNCTION>
-	void ReadPulseDomianFunctions( KeyValues3 *root, DOMAIN_FUNCTION *functions, int count );
-	void ReadPulseDomainsInfo( KeyValues3 *root, std::map<std::string, KeyValues3 *> &domains );
+	void ReadPulseDomianFunctions( const KV3Fanout &root, DOMAIN_FUNCTION *functions, int count );
+	void ReadPulseDomainInfo( PulseDomainMap &domains, CPulseDomainInfo *domain_info );
+
+	// Returns index of the type descriptor in the pulse_types table, array subtypes are added first
+	int RequestPulseTypeEntry( const PulseParamType &type );
+	void ReadPulseTypes();
 
 	bool ApplyNetVarOverrides( CSchemaType_DeclaredClass *type );
 	bool ApplyNetVarOverrides( CSchemaType_DeclaredClass *root, const char *field_to_overwrite, int type_override_idx );
-	void LinkChildParentScopeDecls( KeyValues3 *child_traits, CSchemaType *child, int child_idx );
+	void ApplyNetVarOverride( KeyValues3 *def, const char *field_to_overwrite, int type_override_idx );
+	void LinkChildParentScopeDecls( const KV3Fanout &child_traits, int child_idx );
+
+	// Atomically publishes content to a file in the out dir, returns false on any io failure
+	bool WriteToFile( const std::string &filename, const char *content, size_t size );
+	bool WriteFileAtomic( const std::filesystem::path &file_path, const char *content, size_t size );
 
-	bool WriteToFile( const std::string &filename, const char *content );
+	// Extracted module metadata is cached on disk by the module build id, as it only changes with the module itself
+	static SchemaModuleCache GetModuleMetadataCache();
+	bool SaveModuleMetadataCache( const std::filesystem::path &path, KeyValues3 *cached );
+	std::string GetOutFileName( SchemaDumpProfile *profile, const char *ext ) const;
 
 	CSchemaType_DeclaredClass *FindSchemaTypeInTypeScopes( const char *name );
 
-	KeyValues3 *GetRoot() { return m_KV3Context.Root(); }
-	KeyValues3 *GetDefs() { return GetRoot()->FindOrCreateMember( "defs" ); }
-	KeyValues3 *GetAtomicDefs() { return GetRoot()->FindOrCreateMember( "atomics" ); }
+	void ReadStringTable();
+
+	const KV3Fanout &GetRoots() const { return m_Roots; }
+	KV3Fanout GetDefs() const { return GetRoots().FindOrCreateMember( "defs" ); }
+	KV3Fanout GetAtomicDefs() const { return GetRoots().Where( SR_DUMP_ATOMICS ).FindOrCreateMember( "atomics" ); }
 
 	void RecordGameInfo();
 	void RecordDumperInfo();
 	void RecordDumpFlags();
+	void RecordCompactInfo();
 
-	// Returns nullptr if entry already exists
 	template <typename T>
-	std::pair<KeyValues3 *, int> CreateDefEntry( T *type );
+	KV3Fanout CreateDefEntry( T *type, int idx );
 	
-	KeyValues3 *FindDefEntry( int idx ) { return GetDefs()->GetArrayElement( idx ); }
-	KeyValues3 *FindDefEntry( CSchemaType *type );
+	KV3Fanout FindDefEntry( int idx ) const { return GetDefs().GetArrayElement( idx ); }
+	KV3Fanout FindDefEntry( CSchemaType *type ) const;
 
 	int FindTypeMapEntry( CSchemaType *type ) const;
 
-	std::string SplitTemplatedName( CSchemaType *type ) const;
+	// Attributes of a type that are written for every reference to it, computed once per dump
+	const SchemaTypeAttributes &GetTypeAttributes( CSchemaType *type ) { return m_TypeAttributes.Get( type ); }
 
 private:
-	CKV3Arena m_KV3Context;
+	// Declared before the profiles, as their arenas reference its storage
+	SchemaStringTable m_Strings;
+
+	std::vector<std::unique_ptr<SchemaDumpProfile>> m_Profiles;
+	KV3Fanout m_Roots;
+
+	// Union of all profiles flags, drives what gets traversed
+	uint32 m_Flags = 0;
+
+	struct SchemaTypeNode
+	{
+		CSchemaType *m_pType;
+
+		// Def index of the parent scope class, -1 if there's none
+		// or SR_MISSING_PARENT_SCOPE if it's absent from schema
+		int m_ParentScopeIdx = -1;
+
+		// Child scope classes linking to this def, its child_class_idx array is sized by the first of them
+		int m_nChildScopeCount = 0;
+		int m_nLinkedChildScopes = 0;
+
+		uint64 m_LayoutHash = 0;
+
+		// Types of other projects folded into this def by DedupeProjectTypes
+		std::vector<CSchemaType *> m_MergedTypes;
+	};
+
+	// Collected types in their def index order
+	std::vector<SchemaTypeNode> m_Types;
+	std::unordered_map<CSchemaType *, int> m_TypeMap;
+	std::vector<CSchemaType *> m_TypeStack;
+
+	SchemaTypeMemo<CSchemaType> m_TypeAttributes;
+
+	// Counts storage was reserved for and bucket counts right after reserving, reported against the used ones
+	SchemaTypeCounts m_ReservedCounts;
+	int m_nReservedStrings = 0;
+	size_t m_nReservedTypeMapBuckets = 0;
+	size_t m_nReservedAtomicMapBuckets = 0;
+	size_t m_nReservedTypeAttributesBuckets = 0;
+	size_t m_nReservedStringBuckets = 0;
+
+	// Collected atomics in their atomics table index order, keyed by token
+	std::vector<SchemaAtomicTypeInfo_t *> m_Atomics;
+	std::unordered_map<int, int> m_AtomicMap;
+
+	struct ClassLayoutReport
+	{
+		int m_TypeIdx;
+		int m_nSize;
+		SchemaLayoutReport m_Report;
 
-	std::map<CSchemaType *, int> m_TypeMap;
+		// Has bitfields which placement was dropped, these are left out of the analyzed layout
+		bool m_bApproximate;
+	};
+
+	// Sorted by wasted bytes, largest first
+	std::vector<ClassLayoutReport> m_LayoutReports;
+
+	struct PulseTypeEntry
+	{
+		int m_nType;
+		const char *m_pszLibraryClass;
+		int m_SubTypeIdx;
+
+		// Formatted once and shared by every param and ret referencing this entry
+		std::string m_Name;
+	};
+
+	// Deduplicated pulse param types, keyed by value type, library class and subtype index
+	std::vector<PulseTypeEntry> m_PulseTypes;
+	std::map<std::tuple<int, std::string_view, int>, int> m_PulseTypeMap;
+
+	struct NetFootprint
+	{
+		int m_nClasses = 0;
+		int m_nFields = 0;
+		int m_nBytes = 0;
+		int m_nChangeCallbacks = 0;
+		std::map<std::string, int> m_Encoders;
+
+		void Merge( const NetFootprint &other );
+		void Write( KeyValues3 *root ) const;
+	};
+
+	struct ClassNetReport
+	{
+		int m_TypeIdx;
+		int m_nInheritedFields = 0;
+
+		// Networked fields retyped by MNetworkVarTypeOverride of the class or its bases, sized by the override type
+		int m_nTypeOverriddenFields = 0;
+
+		// Inherited networked fields MNetworkOverride of the class or its bases changes send properties of,
+		// their encoders and callbacks are still the declared ones, as the metatag doesn't carry the new ones
+		int m_nPropertyOverriddenFields = 0;
+
+		// MNetworkVarNames of the class, and the ones that have no declared networked field to account for
+		int m_nVarNames = 0;
+		std::vector<std::string> m_UnmatchedVarNames;
+
+		// Including inherited fields and declared fields only
+		NetFootprint m_Total;
+		NetFootprint m_Own;
+	};
+
+	// Sorted by total networked bytes, largest first
+	std::vector<ClassNetReport> m_NetReports;
 	std::filesystem::path m_OutPath;
 
-	inline static uint32 s_Flags = 0;
+	inline static bool s_VerboseLogging = false;
 
 public:
 	enum 
@@ -143,9 +568,46 @@ public:
 		SR_IGNORE_PARENT_SCOPE = (1 << 8),
 
 		// Applies netvar overrides to types (MNetworkVarTypeOverride metatags)
-		SR_APPLY_NETVAR_OVERRIDES = (1 << 9)
+		SR_APPLY_NETVAR_OVERRIDES = (1 << 9),
+
+		// Orders defs so that types are placed after their base classes
+		// and by value members, must be set on every profile or none
+		SR_TOPO_ORDER = (1 << 10),
+
+		// Dumps type dependency graph with reverse edges and strongly connected components
+		SR_DUMP_GRAPH = (1 << 11),
+
+		// Dumps complete field lists of classes with absolute offsets
+		SR_DUMP_FLATTENED = (1 << 12),
+
+		// Writes padding and cache line report of class layouts to a separate file
+		SR_LAYOUT_REPORT = (1 << 13),
+
+		// Writes networked fields footprint report to a separate file
+		SR_NET_REPORT = (1 << 14),
+
+		// Publishes binary snapshot of classes into a shared memory object (Linux only)
+		SR_SHM_SNAPSHOT = (1 << 15),
+
+		// Writes scopes, projects, metatags and atomic names as indices into a root strings table
+		SR_INTERN_STRINGS = (1 << 16),
+
+		// Writes flags as bitmasks and metatag values with their json types,
+		// omits empty arrays and values matching the root compact defaults
+		SR_COMPACT = (1 << 17),
+
+		// Merges layout identical classes and enums of different projects into a single def,
+		// must be set on every profile or none
+		SR_DEDUPE_PROJECTS = (1 << 18),
+
+		// Dumps inheritance interval labels of classes, so is-a checks don't need to walk base classes
+		SR_DUMP_HIERARCHY = (1 << 19),
+
+		// Writes raw schema inputs of the reader (type scopes, class/enum/atomic infos and stringified metatags) to a separate file
+		SR_CAPTURE = (1 << 20)
 	};
 
+
 	struct DumpFlags_t
 	{
 		uint32 m_Flag;
@@ -165,6 +627,17 @@ public:
 		{ SR_SPLIT_ATOMIC_NAMES, "split_atomics", "atomic_names_split", "Splits templated atomic names and leaves only base name leaving templated stuff" },
 		{ SR_IGNORE_PARENT_SCOPE, "ignore_parents", "no_parent_scope", "Ignores parent scope decls and removes inlined structs/classes converting them from A::B to A__B" },
 		{ SR_APPLY_NETVAR_OVERRIDES, "apply_netvar_overrides", "netvars_overriden", "Applies netvar overrides to types (MNetworkVarTypeOverride metatags)" },
+		{ SR_TOPO_ORDER, "topo_order", "topo_ordered", "Orders defs so that every type comes after its base classes and by value members" },
+		{ SR_DUMP_GRAPH, "graph", "has_graph", "Dump type dependency graph" },
+		{ SR_DUMP_FLATTENED, "flattened", "has_flattened", "Dump flattened class layouts with absolute field offsets" },
+		{ SR_LAYOUT_REPORT, "layout_report", nullptr, "Writes class padding and cache line usage report to a separate file" },
+		{ SR_NET_REPORT, "net_report", nullptr, "Writes networked fields footprint report to a separate file" },
+		{ SR_SHM_SNAPSHOT, "shm_snapshot", nullptr, "Publishes binary classes snapshot into a shared memory object (Linux only)" },
+		{ SR_INTERN_STRINGS, "intern_strings", "strings_interned", "Writes scopes, projects, metatags and atomic names as indices into a shared strings table" },
+		{ SR_COMPACT, "compact", "compact", "Writes flags as bitmasks, typed metatag values and omits empty and default values" },
+		{ SR_DEDUPE_PROJECTS, "dedupe_projects", "projects_deduped", "Merges layout identical classes and enums of different projects into a single def with a projects list" },
+		{ SR_DUMP_HIERARCHY, "hierarchy", "has_hierarchy", "Dump inheritance interval labels of classes for constant time is-a checks" },
+		{ SR_CAPTURE, "capture", nullptr, "Writes raw schema data consumed by the reader to a separate capture file" },
 
 		// Supplementary definitions
 		{ SR_DUMP_METATAGS | SR_DUMP_ATOMICS | SR_DUMP_PULSE_BINDINGS | SR_DUMP_MODULE_METADATA, "all", nullptr, "Dumps everything" },
@@ -172,47 +645,60 @@ public:
 	};
 };
 
-// Short convenience helper method to replace all occurrences in a string with other
-inline std::string ReplaceString( std::string subject, const std::string &search, const std::string &replace )
+inline void KV3Fanout::SetInterned( const char *value, SchemaStringTable &table ) const
 {
-	size_t pos = 0;
-	while((pos = subject.find( search, pos )) != std::string::npos)
+	int idx = table.Intern( value );
+
+	for(int i = 0; i < m_Count; i++)
 	{
-		subject.replace( pos, search.length(), replace );
-		pos += replace.length();
+		if(m_Profiles[i]->HasFlag( SchemaReader::SR_INTERN_STRINGS ))
+			m_Nodes[i]->SetInt( idx );
+		else
+			m_Nodes[i]->SetStringExternal( table.Get( idx ) );
 	}
-	return subject;
 }
 
 template <typename T>
-inline std::pair<KeyValues3 *, int> SchemaReader::CreateDefEntry( T *type )
+inline KV3Fanout SchemaReader::CreateDefEntry( T *type, int idx )
 {
-	int map_type_idx = FindTypeMapEntry( type );
-	if(map_type_idx != -1)
-		return std::make_pair( nullptr, map_type_idx );
+	auto def = FindDefEntry( idx );
 
-	map_type_idx = GetDefs()->GetArrayElementCount();
-	m_TypeMap[type] = map_type_idx;
-	auto def = GetDefs()->ArrayAddElementToTail();
+	// Compact profiles omit values matching the defaults recorded by RecordCompactInfo
+	(std::is_same_v<T, CSchemaType_DeclaredClass> ? def.WhereNot( SR_COMPACT ) : def).SetMemberString( "type", SchemaTypeToString<T>() );
 
-	def->SetMemberString( "type", SchemaTypeToString<T>() );
+	auto &attributes = GetTypeAttributes( type );
 
-	if(IsIgnoringParentScopes())
-		def->SetMemberString( "name", ReplaceString( type->m_sTypeName.Get(), "::", "__" ).c_str() );
-	else
-		def->SetMemberString( "name", type->m_sTypeName.Get() );
+	def.Where( SR_IGNORE_PARENT_SCOPE ).SetMemberString( "name", attributes.m_DisplayName.c_str() );
 
-	def->SetMemberString( "scope", type->m_pTypeScope->GetScopeName() );
+	def.WhereNot( SR_IGNORE_PARENT_SCOPE ).SetMemberString( "name", type->m_sTypeName.Get() );
+
+	(type->m_pTypeScope == SchemaSystem()->GlobalTypeScope() ? def.WhereNot( SR_COMPACT ) : def).SetMemberInterned( "scope", type->m_pTypeScope->GetScopeName(), m_Strings );
 
 	if(auto decl_class = type->template ReinterpretAs<CSchemaType_DeclaredClass>())
-		def->SetMemberString( "project", decl_class->m_pClassInfo ? decl_class->m_pClassInfo->m_pszProjectName : "!!NULL!!" );
+		def.SetMemberInterned( "project", decl_class->m_pClassInfo ? decl_class->m_pClassInfo->m_pszProjectName : "!!NULL!!", m_Strings );
 
-	int size;
-	uint8 alignment;
-	type->GetSizeAndAlignment( size, alignment );
+	// Merged defs are shared by every profile, so all of them get to know the projects they cover
+	if(!m_Types[idx].m_MergedTypes.empty())
+	{
+		std::vector<std::string_view> projects;
+		projects.push_back( GetProjectName( type ) );
+
+		for(auto merged : m_Types[idx].m_MergedTypes)
+		{
+			std::string_view project = GetProjectName( merged );
+			if(std::find( projects.begin(), projects.end(), project ) == projects.end())
+				projects.push_back( project );
+		}
+
+		auto projects_kv = def.FindOrCreateMember( "projects" );
+		projects_kv.SetToEmptyArray();
+
+		for(auto project : projects)
+			projects_kv.ArrayAddElementToTail().SetInterned( project.data(), m_Strings );
+	}
 
-	def->SetMemberInt( "size", size );
-	def->SetMemberInt( "alignment", alignment );
+	def.SetMemberInt( "size", attributes.m_nSize );
+	def.SetMemberInt( "alignment", attributes.m_nAlignment );
 
-	return std::make_pair( def, map_type_idx );
+	return def;
 }
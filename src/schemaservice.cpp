@@ -0,0 +1,176 @@
+#include "schemaservice.h"
+#include "schemaindex.h"
+#include "schemareader.h"
+#include "plugin.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// Index the published snapshot was built from, only touched on the game thread
+static std::shared_ptr<const SchemaIndex> s_SnapshotIndex;
+static std::chrono::steady_clock::time_point s_LastRefreshCheck;
+
+static std::vector<std::string> CopyMetaTagNames( SchemaMetadataEntryData_t *data, int count )
+{
+	std::vector<std::string> result;
+	result.reserve( count );
+
+	for(int i = 0; i < count; i++)
+		result.emplace_back( data[i].m_pszName );
+
+	return result;
+}
+
+// Copies everything requests could touch out of schema memory, which the service thread can't read
+static std::shared_ptr<const SchemaServiceSnapshot> BuildServiceSnapshot( const SchemaIndex &index )
+{
+	std::vector<SchemaClassInfoData_t *> infos;
+	infos.reserve( index.GetClassCount() );
+
+	for(auto &[name, entries] : index.GetClasses())
+		infos.insert( infos.end(), entries.begin(), entries.end() );
+
+	// Same order as SchemaIndex::ComputeLayoutHash, so the combined layout hashes match
+	std::sort( infos.begin(), infos.end(), []( SchemaClassInfoData_t *a, SchemaClassInfoData_t *b ) {
+		int result = std::strcmp( a->m_pszName, b->m_pszName );
+		if(result != 0)
+			return result < 0;
+
+		return std::strcmp( a->m_pDeclaredClass->m_pTypeScope->GetScopeName(), b->m_pDeclaredClass->m_pTypeScope->GetScopeName() ) < 0;
+	} );
+
+	std::unordered_map<SchemaClassInfoData_t *, int> class_indices;
+	class_indices.reserve( infos.size() );
+
+	for(int i = 0; i < (int)infos.size(); i++)
+		class_indices[infos[i]] = i;
+
+	std::vector<SchemaServiceClass> classes( infos.size() );
+
+	for(size_t i = 0; i < infos.size(); i++)
+	{
+		auto ci = infos[i];
+		auto &cls = classes[i];
+
+		cls.m_Name = ci->m_pszName;
+		cls.m_Scope = ci->m_pDeclaredClass->m_pTypeScope->GetScopeName();
+		cls.m_Project = ci->m_pszProjectName ? ci->m_pszProjectName : "";
+		cls.m_nSize = ci->m_nSize;
+		cls.m_nAlignment = ci->m_nAlignment;
+		cls.m_LayoutHash = SchemaReader::ComputeLayoutHash( ci->m_pDeclaredClass );
+		cls.m_MetaTags = CopyMetaTagNames( ci->m_pStaticMetadata, ci->m_nStaticMetadataCount );
+
+		cls.m_Bases.reserve( ci->m_nBaseClassCount );
+		for(int k = 0; k < ci->m_nBaseClassCount; k++)
+		{
+			auto &base = ci->m_pBaseClasses[k];
+			auto iter = class_indices.find( base.m_pClass );
+
+			cls.m_Bases.push_back( { base.m_pClass->m_pszName, (int)base.m_nOffset, iter != class_indices.end() ? iter->second : -1 } );
+		}
+
+		cls.m_Fields.reserve( ci->m_nFieldCount );
+		for(int k = 0; k < ci->m_nFieldCount; k++)
+		{
+			auto &field = ci->m_pFields[k];
+
+			cls.m_Fields.push_back( { field.m_pszName, field.m_pType->m_sTypeName.Get(), field.m_nSingleInheritanceOffset,
+									  CopyMetaTagNames( field.m_pStaticMetadata, field.m_nStaticMetadataCount ) } );
+		}
+	}
+
+	std::vector<SchemaServiceEnum> enums;
+	enums.reserve( index.GetEnumCount() );
+
+	for(auto &[name, entries] : index.GetEnums())
+	{
+		for(auto ei : entries)
+		{
+			auto &en = enums.emplace_back();
+
+			en.m_Name = ei->m_pszName;
+			en.m_Scope = ei->m_pTypeScope->GetScopeName();
+			en.m_nSize = ei->m_nSize;
+			en.m_MetaTags = CopyMetaTagNames( ei->m_pStaticMetadata, ei->m_nStaticMetadataCount );
+
+			en.m_Values.reserve( ei->m_nEnumeratorCount );
+			for(int k = 0; k < ei->m_nEnumeratorCount; k++)
+				en.m_Values.push_back( { ei->m_pEnumerators[k].m_pszName, ei->m_pEnumerators[k].m_nValue } );
+		}
+	}
+
+	return std::make_shared<SchemaServiceSnapshot>( std::move( classes ), std::move( enums ) );
+}
+
+static bool RefreshServiceSnapshot()
+{
+	auto index = SchemaIndex::Get();
+	if(!index)
+		return false;
+
+	if(index != s_SnapshotIndex)
+	{
+		PublishSchemaServiceSnapshot( BuildServiceSnapshot( *index ) );
+		s_SnapshotIndex = std::move( index );
+	}
+
+	return true;
+}
+
+bool StartSchemaService( const char *path )
+{
+	if(IsSchemaServiceServerRunning())
+	{
+		META_CONPRINTF( "Schema service is already running at \"%s\".\n", GetSchemaServiceServerPath().c_str() );
+		return false;
+	}
+
+	// Service thread never touches schema system itself, so make sure there's a snapshot to serve
+	if(!RefreshServiceSnapshot())
+		return false;
+
+	std::string err;
+	if(!StartSchemaServiceServer( path, err ))
+	{
+		META_CONPRINTF( "Failed to start schema service on \"%s\": %s\n", path, err.c_str() );
+		return false;
+	}
+
+	s_LastRefreshCheck = std::chrono::steady_clock::now();
+
+	META_CONPRINTF( "Schema service is listening on \"%s\".\n", path );
+	return true;
+}
+
+void StopSchemaService()
+{
+	if(!IsSchemaServiceServerRunning())
+		return;
+
+	StopSchemaServiceServer();
+
+	PublishSchemaServiceSnapshot( nullptr );
+	s_SnapshotIndex.reset();
+
+	META_CONPRINTF( "Schema service stopped.\n" );
+}
+
+bool IsSchemaServiceRunning()
+{
+	return IsSchemaServiceServerRunning();
+}
+
+void UpdateSchemaService()
+{
+	if(!IsSchemaServiceServerRunning())
+		return;
+
+	// Scopes signature is cheap, but still not worth computing every frame
+	auto now = std::chrono::steady_clock::now();
+	if(now - s_LastRefreshCheck < std::chrono::milliseconds( SCHEMADUMP_SERVICE_REFRESH_INTERVAL_MS ))
+		return;
+
+	s_LastRefreshCheck = now;
+	RefreshServiceSnapshot();
+}
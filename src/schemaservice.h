@@ -0,0 +1,29 @@
+#pragma once
+
+#include "schemaservicecore.h"
+
+// Local schema query service hosted on a unix domain socket, served from a background thread
+// out of a snapshot of the resident SchemaIndex. Linux only.
+//
+// Every request and response is a frame of a 4 byte little endian payload length followed by the payload.
+// Request payload is a space separated command, response payload is a json object:
+//	class <name>: Class layouts with the matching name
+//	field <class> <field>: Absolute offset of a field, searching base classes as well
+//	def <name>: Full class or enum definition, including metatag names
+//	changed <hash>: Whether the combined layout hash of all classes differs from <hash>
+//	changed <class> <hash>: Whether layout hash of the class differs from <hash>
+
+#define SCHEMADUMP_SERVICE_DEFAULT_PATH "/tmp/schemadump.sock"
+
+// Max size of a single request payload, larger requests close the connection
+#define SCHEMADUMP_SERVICE_MAX_REQUEST 4096
+
+// Interval at which the game thread checks type scopes for changes while the service is running
+#define SCHEMADUMP_SERVICE_REFRESH_INTERVAL_MS 1000
+
+bool StartSchemaService( const char *path = SCHEMADUMP_SERVICE_DEFAULT_PATH );
+void StopSchemaService();
+bool IsSchemaServiceRunning();
+
+// Republishes the served snapshot if type scopes changed, has to be called from the game thread
+void UpdateSchemaService();
@@ -0,0 +1,614 @@
+#include "schemaservicecore.h"
+#include "schemaservice.h"
+#include "schemadump_hash.h"
+
+#include <atomic>
+#include <thread>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#if defined( __linux__ )
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+static void WriteJSONString( std::ostringstream &out, const std::string &str )
+{
+	out << '"';
+
+	for(char c : str)
+	{
+		switch(c)
+		{
+			case '"': out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\n': out << "\\n"; break;
+			case '\r': out << "\\r"; break;
+			case '\t': out << "\\t"; break;
+			default:
+			{
+				if((unsigned char)c < 0x20)
+				{
+					char buf[8];
+					std::snprintf( buf, sizeof( buf ), "\\u%04x", c );
+					out << buf;
+				}
+				else
+				{
+					out << c;
+				}
+			}
+		}
+	}
+
+	out << '"';
+}
+
+static void WriteMetaTagNames( std::ostringstream &out, const std::vector<std::string> &metatags )
+{
+	out << "\"metatags\":[";
+
+	for(size_t i = 0; i < metatags.size(); i++)
+	{
+		if(i > 0)
+			out << ',';
+
+		WriteJSONString( out, metatags[i] );
+	}
+
+	out << ']';
+}
+
+static std::string LayoutHashToString( uint64_t hash )
+{
+	char buf[32];
+	std::snprintf( buf, sizeof( buf ), "%016llx", (unsigned long long)hash );
+	return buf;
+}
+
+static void WriteClass( std::ostringstream &out, const SchemaServiceClass &cls, bool full )
+{
+	out << "{\"name\":";
+	WriteJSONString( out, cls.m_Name );
+	out << ",\"scope\":";
+	WriteJSONString( out, cls.m_Scope );
+	out << ",\"project\":";
+	WriteJSONString( out, cls.m_Project );
+	out << ",\"size\":" << cls.m_nSize << ",\"alignment\":" << cls.m_nAlignment;
+	out << ",\"layout_hash\":\"" << LayoutHashToString( cls.m_LayoutHash ) << '"';
+
+	if(full)
+	{
+		out << ',';
+		WriteMetaTagNames( out, cls.m_MetaTags );
+	}
+
+	out << ",\"bases\":[";
+	for(size_t i = 0; i < cls.m_Bases.size(); i++)
+	{
+		if(i > 0)
+			out << ',';
+
+		out << "{\"name\":";
+		WriteJSONString( out, cls.m_Bases[i].m_Name );
+		out << ",\"offset\":" << cls.m_Bases[i].m_nOffset << '}';
+	}
+
+	out << "],\"fields\":[";
+	for(size_t i = 0; i < cls.m_Fields.size(); i++)
+	{
+		auto &field = cls.m_Fields[i];
+
+		if(i > 0)
+			out << ',';
+
+		out << "{\"name\":";
+		WriteJSONString( out, field.m_Name );
+		out << ",\"offset\":" << field.m_nOffset << ",\"type\":";
+		WriteJSONString( out, field.m_TypeName );
+
+		if(full)
+		{
+			out << ',';
+			WriteMetaTagNames( out, field.m_MetaTags );
+		}
+
+		out << '}';
+	}
+
+	out << "]}";
+}
+
+static void WriteEnum( std::ostringstream &out, const SchemaServiceEnum &en )
+{
+	out << "{\"name\":";
+	WriteJSONString( out, en.m_Name );
+	out << ",\"scope\":";
+	WriteJSONString( out, en.m_Scope );
+	out << ",\"size\":" << en.m_nSize << ',';
+	WriteMetaTagNames( out, en.m_MetaTags );
+
+	out << ",\"values\":[";
+	for(size_t i = 0; i < en.m_Values.size(); i++)
+	{
+		if(i > 0)
+			out << ',';
+
+		out << "{\"name\":";
+		WriteJSONString( out, en.m_Values[i].m_Name );
+		out << ",\"value\":" << en.m_Values[i].m_nValue << '}';
+	}
+
+	out << "]}";
+}
+
+static std::string ServiceError( const char *message )
+{
+	std::ostringstream out;
+
+	out << "{\"error\":";
+	WriteJSONString( out, message );
+	out << '}';
+
+	return out.str();
+}
+
+SchemaServiceSnapshot::SchemaServiceSnapshot( std::vector<SchemaServiceClass> classes, std::vector<SchemaServiceEnum> enums ) :
+	m_Classes( std::move( classes ) ), m_Enums( std::move( enums ) ), m_LayoutHash( SCHEMADUMP_HASH_OFFSET )
+{
+	m_ClassesByName.reserve( m_Classes.size() );
+	m_EnumsByName.reserve( m_Enums.size() );
+
+	for(int i = 0; i < (int)m_Classes.size(); i++)
+	{
+		m_ClassesByName[m_Classes[i].m_Name].push_back( i );
+		m_LayoutHash = SchemaDumpHashInt( (int64_t)m_Classes[i].m_LayoutHash, m_LayoutHash );
+	}
+
+	for(int i = 0; i < (int)m_Enums.size(); i++)
+		m_EnumsByName[m_Enums[i].m_Name].push_back( i );
+}
+
+const std::vector<int> *SchemaServiceSnapshot::FindClasses( std::string_view name ) const
+{
+	auto iter = m_ClassesByName.find( name );
+	return iter != m_ClassesByName.end() ? &iter->second : nullptr;
+}
+
+const std::vector<int> *SchemaServiceSnapshot::FindEnums( std::string_view name ) const
+{
+	auto iter = m_EnumsByName.find( name );
+	return iter != m_EnumsByName.end() ? &iter->second : nullptr;
+}
+
+bool SchemaServiceSnapshot::FindField( int class_idx, std::string_view field_name, FieldLocation &location ) const
+{
+	// Pairs of a class index and its offset within the queried class
+	std::vector<std::pair<int, int>> stack;
+	stack.push_back( { class_idx, 0 } );
+
+	while(!stack.empty())
+	{
+		auto [idx, base_offset] = stack.back();
+		stack.pop_back();
+
+		auto &cls = m_Classes[idx];
+		for(auto &field : cls.m_Fields)
+		{
+			if(field_name == field.m_Name)
+			{
+				location = { &cls, &field, base_offset + field.m_nOffset };
+				return true;
+			}
+		}
+
+		for(int i = (int)cls.m_Bases.size() - 1; i >= 0; i--)
+		{
+			if(cls.m_Bases[i].m_nClassIdx >= 0)
+				stack.push_back( { cls.m_Bases[i].m_nClassIdx, base_offset + cls.m_Bases[i].m_nOffset } );
+		}
+	}
+
+	return false;
+}
+
+std::string SchemaServiceSnapshot::HandleRequest( const std::string &request ) const
+{
+	std::vector<std::string> args;
+	std::istringstream tokens( request );
+
+	for(std::string token; tokens >> token;)
+		args.push_back( token );
+
+	std::ostringstream out;
+
+	if(args.size() == 2 && (args[0] == "class" || args[0] == "def"))
+	{
+		auto classes = FindClasses( args[1] );
+		auto enums = args[0] == "def" ? FindEnums( args[1] ) : nullptr;
+
+		if(!classes && !enums)
+			return ServiceError( "Type not found" );
+
+		out << "{\"classes\":[";
+		for(size_t i = 0; classes && i < classes->size(); i++)
+		{
+			if(i > 0)
+				out << ',';
+
+			WriteClass( out, m_Classes[(*classes)[i]], args[0] == "def" );
+		}
+
+		out << "],\"enums\":[";
+		for(size_t i = 0; enums && i < enums->size(); i++)
+		{
+			if(i > 0)
+				out << ',';
+
+			WriteEnum( out, m_Enums[(*enums)[i]] );
+		}
+
+		out << "]}";
+	}
+	else if(args.size() == 3 && args[0] == "field")
+	{
+		auto classes = FindClasses( args[1] );
+		if(!classes)
+			return ServiceError( "Class not found" );
+
+		out << "{\"fields\":[";
+
+		bool first = true;
+		for(auto idx : *classes)
+		{
+			FieldLocation location;
+			if(!FindField( idx, args[2], location ))
+				continue;
+
+			if(!first)
+				out << ',';
+
+			first = false;
+
+			out << "{\"scope\":";
+			WriteJSONString( out, m_Classes[idx].m_Scope );
+			out << ",\"offset\":" << location.m_nAbsoluteOffset << ",\"type\":";
+			WriteJSONString( out, location.m_pField->m_TypeName );
+			out << ",\"declared_in\":";
+			WriteJSONString( out, location.m_pClass->m_Name );
+			out << '}';
+		}
+
+		out << "]}";
+	}
+	else if((args.size() == 2 || args.size() == 3) && args[0] == "changed")
+	{
+		uint64_t hash = std::strtoull( args.back().c_str(), nullptr, 16 );
+		uint64_t current_hash = m_LayoutHash;
+		bool changed = false;
+
+		if(args.size() == 3)
+		{
+			auto classes = FindClasses( args[1] );
+			if(!classes)
+				return ServiceError( "Class not found" );
+
+			// Any scope having a different layout counts as a change
+			current_hash = m_Classes[(*classes)[0]].m_LayoutHash;
+			for(auto idx : *classes)
+				changed |= m_Classes[idx].m_LayoutHash != hash;
+		}
+		else
+		{
+			changed = current_hash != hash;
+		}
+
+		out << "{\"changed\":" << (changed ? "true" : "false") << ",\"layout_hash\":\"" << LayoutHashToString( current_hash ) << "\"}";
+	}
+	else
+	{
+		return ServiceError( "Unknown request" );
+	}
+
+	return out.str();
+}
+
+static std::shared_ptr<const SchemaServiceSnapshot> s_CurrentSnapshot;
+
+void PublishSchemaServiceSnapshot( std::shared_ptr<const SchemaServiceSnapshot> snapshot )
+{
+	std::atomic_store( &s_CurrentSnapshot, std::move( snapshot ) );
+}
+
+std::shared_ptr<const SchemaServiceSnapshot> CurrentSchemaServiceSnapshot()
+{
+	return std::atomic_load( &s_CurrentSnapshot );
+}
+
+std::string HandleSchemaServiceRequest( const std::string &request )
+{
+	// Request keeps its snapshot alive, even if a newer one gets published meanwhile
+	auto snapshot = CurrentSchemaServiceSnapshot();
+	if(!snapshot)
+		return ServiceError( "Schema snapshot isn't published yet" );
+
+	return snapshot->HandleRequest( request );
+}
+
+static std::string s_ServicePath;
+
+const std::string &GetSchemaServiceServerPath()
+{
+	return s_ServicePath;
+}
+
+#if defined( __linux__ )
+static std::thread s_ServiceThread;
+static std::atomic<bool> s_ServiceRunning = false;
+static int s_ServiceWakeFds[2] = { -1, -1 };
+
+// Identity of the socket file bound by the service, so only that file is removed on stop
+static dev_t s_ServiceSocketDev;
+static ino_t s_ServiceSocketIno;
+
+struct ServiceClient
+{
+	int m_Fd;
+	std::string m_Buffer;
+};
+
+static bool SendAll( int fd, const char *data, size_t size )
+{
+	while(size > 0)
+	{
+		ssize_t sent = send( fd, data, size, MSG_NOSIGNAL );
+		if(sent < 0 && errno == EINTR)
+			continue;
+
+		if(sent <= 0)
+			return false;
+
+		data += sent;
+		size -= sent;
+	}
+
+	return true;
+}
+
+// Returns false if connection should be closed
+static bool ProcessClient( ServiceClient &client )
+{
+	char buf[4096];
+	ssize_t received = recv( client.m_Fd, buf, sizeof( buf ), 0 );
+
+	if(received <= 0)
+		return received < 0 && errno == EINTR;
+
+	client.m_Buffer.append( buf, received );
+
+	while(client.m_Buffer.size() >= 4)
+	{
+		auto data = (const uint8_t *)client.m_Buffer.data();
+		uint32_t length = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+
+		if(length > SCHEMADUMP_SERVICE_MAX_REQUEST)
+			return false;
+
+		if(client.m_Buffer.size() < 4 + length)
+			break;
+
+		auto response = HandleSchemaServiceRequest( client.m_Buffer.substr( 4, length ) );
+		client.m_Buffer.erase( 0, 4 + length );
+
+		uint32_t response_length = (uint32_t)response.size();
+		uint8_t header[4] = { (uint8_t)response_length, (uint8_t)(response_length >> 8), (uint8_t)(response_length >> 16), (uint8_t)(response_length >> 24) };
+
+		if(!SendAll( client.m_Fd, (const char *)header, sizeof( header ) ) || !SendAll( client.m_Fd, response.data(), response.size() ))
+			return false;
+	}
+
+	return true;
+}
+
+static void ServiceThread( int listen_fd )
+{
+	std::vector<ServiceClient> clients;
+	std::vector<pollfd> fds;
+
+	while(s_ServiceRunning.load())
+	{
+		fds.clear();
+		fds.push_back( { s_ServiceWakeFds[0], POLLIN, 0 } );
+		fds.push_back( { listen_fd, POLLIN, 0 } );
+
+		for(auto &client : clients)
+			fds.push_back( { client.m_Fd, POLLIN, 0 } );
+
+		if(poll( fds.data(), fds.size(), -1 ) < 0)
+		{
+			if(errno == EINTR)
+				continue;
+
+			break;
+		}
+
+		if(fds[0].revents)
+			break;
+
+		// Clients are processed before accepting new ones, so fds and clients indices still match
+		for(size_t i = clients.size(); i-- > 0;)
+		{
+			if(!fds[i + 2].revents)
+				continue;
+
+			if(!(fds[i + 2].revents & POLLIN) || !ProcessClient( clients[i] ))
+			{
+				close( clients[i].m_Fd );
+				clients.erase( clients.begin() + i );
+			}
+		}
+
+		if(fds[1].revents & POLLIN)
+		{
+			int client_fd = accept4( listen_fd, nullptr, nullptr, SOCK_CLOEXEC );
+
+			if(client_fd >= 0)
+			{
+				// Don't let a stuck client stall the service forever
+				timeval timeout = { 5, 0 };
+				setsockopt( client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof( timeout ) );
+
+				clients.push_back( { client_fd, {} } );
+			}
+		}
+	}
+
+	for(auto &client : clients)
+		close( client.m_Fd );
+
+	close( listen_fd );
+}
+
+static std::string ErrnoString( const char *op )
+{
+	return std::string( op ) + ": " + std::strerror( errno );
+}
+
+// Removes the socket file bound by the service, leaving anything that replaced it alone
+static void UnlinkServiceSocket()
+{
+	struct stat st;
+	if(lstat( s_ServicePath.c_str(), &st ) == 0 && S_ISSOCK( st.st_mode ) && st.st_dev == s_ServiceSocketDev && st.st_ino == s_ServiceSocketIno)
+		unlink( s_ServicePath.c_str() );
+}
+
+bool StartSchemaServiceServer( const char *path, std::string &err )
+{
+	if(s_ServiceRunning.load())
+	{
+		err = "Schema service is already running at \"" + s_ServicePath + "\"";
+		return false;
+	}
+
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+
+	if(std::strlen( path ) >= sizeof( addr.sun_path ))
+	{
+		err = "Socket path is too long";
+		return false;
+	}
+
+	std::strcpy( addr.sun_path, path );
+
+	// Socket file of a previous run would make bind fail otherwise, but nothing else is ever removed
+	struct stat st;
+	if(lstat( path, &st ) == 0)
+	{
+		if(!S_ISSOCK( st.st_mode ))
+		{
+			err = "Path exists and isn't a socket, refusing to replace it";
+			return false;
+		}
+
+		if(unlink( path ) != 0)
+		{
+			err = ErrnoString( "Failed to remove stale socket" );
+			return false;
+		}
+	}
+	else if(errno != ENOENT)
+	{
+		err = ErrnoString( "Failed to stat socket path" );
+		return false;
+	}
+
+	int listen_fd = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+	if(listen_fd < 0)
+	{
+		err = ErrnoString( "Failed to create socket" );
+		return false;
+	}
+
+	if(bind( listen_fd, (sockaddr *)&addr, sizeof( addr ) ) != 0)
+	{
+		err = ErrnoString( "Failed to bind" );
+		close( listen_fd );
+		return false;
+	}
+
+	// Clients can't connect before listen, so restricting it here leaves no window
+	// for other users to reach the socket, which lives in /tmp by default
+	if(chmod( path, 0600 ) != 0 || lstat( path, &st ) != 0)
+	{
+		err = ErrnoString( "Failed to restrict socket permissions" );
+		close( listen_fd );
+		unlink( path );
+		return false;
+	}
+
+	s_ServicePath = path;
+	s_ServiceSocketDev = st.st_dev;
+	s_ServiceSocketIno = st.st_ino;
+
+	if(listen( listen_fd, 16 ) != 0)
+	{
+		err = ErrnoString( "Failed to listen" );
+		close( listen_fd );
+		UnlinkServiceSocket();
+		return false;
+	}
+
+	if(pipe2( s_ServiceWakeFds, O_CLOEXEC ) != 0)
+	{
+		err = ErrnoString( "Failed to create wake pipe" );
+		close( listen_fd );
+		UnlinkServiceSocket();
+		return false;
+	}
+
+	s_ServiceRunning.store( true );
+	s_ServiceThread = std::thread( ServiceThread, listen_fd );
+
+	return true;
+}
+
+void StopSchemaServiceServer()
+{
+	if(!s_ServiceRunning.exchange( false ))
+		return;
+
+	char wake = 0;
+	while(write( s_ServiceWakeFds[1], &wake, 1 ) < 0 && errno == EINTR) {}
+
+	if(s_ServiceThread.joinable())
+		s_ServiceThread.join();
+
+	close( s_ServiceWakeFds[0] );
+	close( s_ServiceWakeFds[1] );
+	s_ServiceWakeFds[0] = s_ServiceWakeFds[1] = -1;
+
+	UnlinkServiceSocket();
+}
+
+bool IsSchemaServiceServerRunning()
+{
+	return s_ServiceRunning.load();
+}
+#else
+bool StartSchemaServiceServer( const char *path, std::string &err )
+{
+	err = "Schema service is only supported on linux";
+	return false;
+}
+
+void StopSchemaServiceServer() {}
+bool IsSchemaServiceServerRunning() { return false; }
+#endif
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Sdk independent part of the schema service (see schemaservice.h): socket handling and requests
+// are served purely out of an immutable snapshot that owns copies of everything requests could touch,
+// as schema system memory could be freed on module unload while the service thread is reading it.
+// Snapshots are built and published on the game thread, tests/service_test.cpp publishes a stand-in one.
+
+struct SchemaServiceClass
+{
+	struct Base
+	{
+		std::string m_Name;
+		int m_nOffset;
+
+		// Index into snapshot classes, -1 if the base class isn't in the snapshot
+		int m_nClassIdx;
+	};
+
+	struct Field
+	{
+		std::string m_Name;
+		std::string m_TypeName;
+		int m_nOffset;
+		std::vector<std::string> m_MetaTags;
+	};
+
+	std::string m_Name;
+	std::string m_Scope;
+	std::string m_Project;
+	int m_nSize;
+	int m_nAlignment;
+	uint64_t m_LayoutHash;
+
+	std::vector<std::string> m_MetaTags;
+	std::vector<Base> m_Bases;
+	std::vector<Field> m_Fields;
+};
+
+struct SchemaServiceEnum
+{
+	struct Value
+	{
+		std::string m_Name;
+		int64_t m_nValue;
+	};
+
+	std::string m_Name;
+	std::string m_Scope;
+	int m_nSize;
+
+	std::vector<std::string> m_MetaTags;
+	std::vector<Value> m_Values;
+};
+
+class SchemaServiceSnapshot
+{
+public:
+	// Classes are expected in name and scope order, combined layout hash is computed in that order
+	SchemaServiceSnapshot( std::vector<SchemaServiceClass> classes, std::vector<SchemaServiceEnum> enums );
+
+	std::string HandleRequest( const std::string &request ) const;
+
+	// Classes and enums with the same name could exist in multiple scopes (e.g. server and client)
+	const std::vector<int> *FindClasses( std::string_view name ) const;
+	const std::vector<int> *FindEnums( std::string_view name ) const;
+
+	// Combined layout hash of every class, matches SchemaIndex::GetLayoutHash of the index it was built from
+	uint64_t GetLayoutHash() const { return m_LayoutHash; }
+
+	const std::vector<SchemaServiceClass> &GetClasses() const { return m_Classes; }
+	const std::vector<SchemaServiceEnum> &GetEnums() const { return m_Enums; }
+
+private:
+	struct FieldLocation
+	{
+		const SchemaServiceClass *m_pClass;
+		const SchemaServiceClass::Field *m_pField;
+
+		// Offset within the queried class, including base class offsets
+		int m_nAbsoluteOffset;
+	};
+
+	// Searches the class and its bases, returns false if field wasn't found
+	bool FindField( int class_idx, std::string_view field_name, FieldLocation &location ) const;
+
+	std::vector<SchemaServiceClass> m_Classes;
+	std::vector<SchemaServiceEnum> m_Enums;
+
+	// Keys point into m_Classes and m_Enums names, which never change after construction
+	std::unordered_map<std::string_view, std::vector<int>> m_ClassesByName;
+	std::unordered_map<std::string_view, std::vector<int>> m_EnumsByName;
+
+	uint64_t m_LayoutHash;
+};
+
+// Snapshot served by the service, publishing is safe from any thread
+void PublishSchemaServiceSnapshot( std::shared_ptr<const SchemaServiceSnapshot> snapshot );
+std::shared_ptr<const SchemaServiceSnapshot> CurrentSchemaServiceSnapshot();
+
+// Exposed separately from the socket handling so requests could be served from the console as well
+std::string HandleSchemaServiceRequest( const std::string &request );
+
+// Starts serving the current snapshot on a background thread. Only a socket file is ever replaced at path
+// (a stale one of a previous run), socket is made accessible to the owner only. Linux only
+bool StartSchemaServiceServer( const char *path, std::string &err );
+void StopSchemaServiceServer();
+bool IsSchemaServiceServerRunning();
+const std::string &GetSchemaServiceServerPath();
@@ -0,0 +1,227 @@
+#include "schemasnapshot.h"
+#include "schemaindex.h"
+#include "schemareader.h"
+#include "schemadump_hash.h"
+#include "plugin.h"
+
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <cerrno>
+
+#if PLATFORM_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Serialized tables that follow the header, offsets are relative to the start of the mapping
+struct SnapshotTables
+{
+	std::vector<SchemaSnapshotClass> m_Classes;
+	std::vector<SchemaSnapshotField> m_Fields;
+	std::vector<SchemaSnapshotBase> m_Bases;
+	std::string m_Strings;
+
+	std::unordered_map<std::string_view, uint32_t> m_StringOffsets;
+
+	uint32_t AddString( const char *str )
+	{
+		auto [iter, inserted] = m_StringOffsets.emplace( str, (uint32_t)m_Strings.size() );
+
+		if(inserted)
+			m_Strings.append( str, std::strlen( str ) + 1 );
+
+		return iter->second;
+	}
+};
+
+static size_t AlignSnapshotOffset( size_t offset )
+{
+	return (offset + 7) & ~(size_t)7;
+}
+
+static void BuildSnapshotTables( const SchemaIndex &index, SnapshotTables &tables )
+{
+	std::vector<std::pair<uint64_t, SchemaClassInfoData_t *>> classes;
+	classes.reserve( index.GetClassCount() );
+
+	for(auto &[name, infos] : index.GetClasses())
+	{
+		for(auto ci : infos)
+			classes.push_back( { SchemaDumpHashString( ci->m_pszName ), ci } );
+	}
+
+	std::sort( classes.begin(), classes.end(), []( const auto &a, const auto &b ) {
+		if(a.first != b.first)
+			return a.first < b.first;
+
+		return std::strcmp( a.second->m_pDeclaredClass->m_pTypeScope->GetScopeName(), b.second->m_pDeclaredClass->m_pTypeScope->GetScopeName() ) < 0;
+	} );
+
+	std::unordered_map<SchemaClassInfoData_t *, uint32_t> class_indices;
+	class_indices.reserve( classes.size() );
+
+	for(uint32_t i = 0; i < (uint32_t)classes.size(); i++)
+		class_indices[classes[i].second] = i;
+
+	tables.m_Classes.reserve( classes.size() );
+
+	for(auto &[name_hash, ci] : classes)
+	{
+		SchemaSnapshotClass entry = {};
+
+		entry.m_NameHash = name_hash;
+		entry.m_LayoutHash = SchemaReader::ComputeLayoutHash( ci->m_pDeclaredClass );
+		entry.m_NameOffset = tables.AddString( ci->m_pszName );
+		entry.m_ScopeOffset = tables.AddString( ci->m_pDeclaredClass->m_pTypeScope->GetScopeName() );
+		entry.m_ProjectOffset = tables.AddString( ci->m_pszProjectName ? ci->m_pszProjectName : "" );
+		entry.m_nSize = ci->m_nSize;
+		entry.m_nAlignment = ci->m_nAlignment;
+
+		entry.m_FirstField = (uint32_t)tables.m_Fields.size();
+		entry.m_FieldCount = ci->m_nFieldCount;
+
+		for(int i = 0; i < ci->m_nFieldCount; i++)
+		{
+			auto &field = ci->m_pFields[i];
+
+			int size = 0;
+			uint8 alignment;
+
+			if(field.m_pType->m_eTypeCategory != SCHEMA_TYPE_BITFIELD)
+				field.m_pType->GetSizeAndAlignment( size, alignment );
+
+			tables.m_Fields.push_back( { SchemaDumpHashString( field.m_pszName ), tables.AddString( field.m_pszName ),
+										 tables.AddString( field.m_pType->m_sTypeName.Get() ), field.m_nSingleInheritanceOffset, size } );
+		}
+
+		entry.m_FirstBase = (uint32_t)tables.m_Bases.size();
+		entry.m_BaseCount = ci->m_nBaseClassCount;
+
+		for(int i = 0; i < ci->m_nBaseClassCount; i++)
+		{
+			auto iter = class_indices.find( ci->m_pBaseClasses[i].m_pClass );
+			tables.m_Bases.push_back( { iter != class_indices.end() ? iter->second : UINT32_MAX, (int32_t)ci->m_pBaseClasses[i].m_nOffset } );
+		}
+
+		tables.m_Classes.push_back( entry );
+	}
+}
+
+#if PLATFORM_LINUX
+static int s_SnapshotFd = -1;
+static uint8_t *s_SnapshotMapping = nullptr;
+static size_t s_SnapshotMappedSize = 0;
+static std::string s_SnapshotName;
+
+static bool MapSnapshot( const char *name, size_t size )
+{
+	if(s_SnapshotFd != -1 && s_SnapshotName != name)
+	{
+		munmap( s_SnapshotMapping, s_SnapshotMappedSize );
+		close( s_SnapshotFd );
+
+		s_SnapshotFd = -1;
+		s_SnapshotMapping = nullptr;
+		s_SnapshotMappedSize = 0;
+	}
+
+	if(s_SnapshotFd == -1)
+	{
+		s_SnapshotFd = shm_open( name, O_CREAT | O_RDWR, 0644 );
+		if(s_SnapshotFd == -1)
+		{
+			META_CONPRINTF( "Failed to open shared memory object \"%s\": %s\n", name, std::strerror( errno ) );
+			return false;
+		}
+
+		s_SnapshotName = name;
+	}
+
+	if(s_SnapshotMapping && s_SnapshotMappedSize >= size)
+		return true;
+
+	// Object is only ever grown, so readers with an older smaller mapping stay valid
+	struct stat st;
+	if(fstat( s_SnapshotFd, &st ) != 0 || ((size_t)st.st_size < size && ftruncate( s_SnapshotFd, size ) != 0))
+	{
+		META_CONPRINTF( "Failed to resize shared memory object \"%s\": %s\n", name, std::strerror( errno ) );
+		return false;
+	}
+
+	size = (std::max)( size, (size_t)st.st_size );
+
+	if(s_SnapshotMapping)
+		munmap( s_SnapshotMapping, s_SnapshotMappedSize );
+
+	auto mapping = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, s_SnapshotFd, 0 );
+	if(mapping == MAP_FAILED)
+	{
+		META_CONPRINTF( "Failed to map shared memory object \"%s\": %s\n", name, std::strerror( errno ) );
+
+		s_SnapshotMapping = nullptr;
+		s_SnapshotMappedSize = 0;
+		return false;
+	}
+
+	s_SnapshotMapping = (uint8_t *)mapping;
+	s_SnapshotMappedSize = size;
+	return true;
+}
+
+bool PublishSchemaSnapshot( const SchemaIndex &index, const char *name )
+{
+	SnapshotTables tables;
+	BuildSnapshotTables( index, tables );
+
+	size_t classes_offset = AlignSnapshotOffset( sizeof( SchemaSnapshotHeader ) );
+	size_t fields_offset = AlignSnapshotOffset( classes_offset + tables.m_Classes.size() * sizeof( SchemaSnapshotClass ) );
+	size_t bases_offset = AlignSnapshotOffset( fields_offset + tables.m_Fields.size() * sizeof( SchemaSnapshotField ) );
+	size_t strings_offset = AlignSnapshotOffset( bases_offset + tables.m_Bases.size() * sizeof( SchemaSnapshotBase ) );
+	size_t total_size = strings_offset + tables.m_Strings.size();
+
+	if(!MapSnapshot( name, total_size ))
+		return false;
+
+	auto header = reinterpret_cast<SchemaSnapshotHeader *>(s_SnapshotMapping);
+
+	// Continue generation of an existing snapshot, so readers notice the refresh
+	uint64_t generation = header->m_Magic == SCHEMADUMP_SNAPSHOT_MAGIC ? header->m_Generation.load( std::memory_order_relaxed ) : 0;
+	generation += (generation & 1) ? 1 : 2;
+
+	header->m_Generation.store( generation - 1, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_release );
+
+	header->m_Magic = SCHEMADUMP_SNAPSHOT_MAGIC;
+	header->m_Version = SCHEMADUMP_SNAPSHOT_VERSION;
+	header->m_TotalSize = total_size;
+	header->m_ClassesOffset = classes_offset;
+	header->m_ClassCount = (uint32_t)tables.m_Classes.size();
+	header->m_FieldsOffset = fields_offset;
+	header->m_FieldCount = (uint32_t)tables.m_Fields.size();
+	header->m_BasesOffset = bases_offset;
+	header->m_BaseCount = (uint32_t)tables.m_Bases.size();
+	header->m_StringsOffset = strings_offset;
+	header->m_StringsSize = (uint32_t)tables.m_Strings.size();
+
+	std::memcpy( s_SnapshotMapping + classes_offset, tables.m_Classes.data(), tables.m_Classes.size() * sizeof( SchemaSnapshotClass ) );
+	std::memcpy( s_SnapshotMapping + fields_offset, tables.m_Fields.data(), tables.m_Fields.size() * sizeof( SchemaSnapshotField ) );
+	std::memcpy( s_SnapshotMapping + bases_offset, tables.m_Bases.data(), tables.m_Bases.size() * sizeof( SchemaSnapshotBase ) );
+	std::memcpy( s_SnapshotMapping + strings_offset, tables.m_Strings.data(), tables.m_Strings.size() );
+
+	header->m_Generation.store( generation, std::memory_order_release );
+
+	META_CONPRINTF( "Published schema snapshot \"%s\" (generation %llu, %d classes, %.2f MB).\n", name, (unsigned long long)generation,
+					(int)tables.m_Classes.size(), (double)total_size / (1024.0 * 1024.0) );
+
+	return true;
+}
+#else
+bool PublishSchemaSnapshot( const SchemaIndex &index, const char *name )
+{
+	META_CONPRINTF( "Shared memory schema snapshots are only supported on linux!\n" );
+	return false;
+}
+#endif
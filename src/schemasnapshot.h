@@ -0,0 +1,9 @@
+#pragma once
+
+#include "schemadump_snapshot.h"
+
+class SchemaIndex;
+
+// Publishes (or refreshes in place) binary snapshot of every indexed class into a POSIX
+// shared memory object, see public/schemadump_snapshot.h for the layout. Linux only
+bool PublishSchemaSnapshot( const SchemaIndex &index, const char *name = SCHEMADUMP_SNAPSHOT_DEFAULT_NAME );
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Short convenience helper method to replace all occurrences in a string with other
+inline std::string ReplaceString( std::string subject, const std::string &search, const std::string &replace )
+{
+	size_t pos = 0;
+	while((pos = subject.find( search, pos )) != std::string::npos)
+	{
+		subject.replace( pos, search.length(), replace );
+		pos += replace.length();
+	}
+	return subject;
+}
+
+// Splits templated name leaving only the base name (CUtlVector<int> -> CUtlVector)
+inline std::string SplitTemplatedName( const char *type_name )
+{
+	std::string name = type_name;
+
+	auto pos = name.find( '<' );
+	if(pos != std::string::npos)
+		name.resize( pos );
+
+	return name;
+}
+
+// Attributes of a type that are written for every reference to it
+struct SchemaTypeAttributes
+{
+	int m_nSize = 0;
+	uint8_t m_nAlignment = 0;
+
+	// Name with parent scopes flattened (A::B -> A__B), used by SR_IGNORE_PARENT_SCOPE profiles
+	std::string m_DisplayName;
+	std::string m_SplitName;
+};
+
+// Per dump memo of type attributes keyed by the type, so the virtual size query and name copies
+// happen once per type rather than once per reference. T is CSchemaType, or anything with the
+// same GetSizeAndAlignment and m_sTypeName (see tests/typememo_bench.cpp)
+template <typename T>
+class SchemaTypeMemo
+{
+public:
+	const SchemaTypeAttributes &Get( T *type )
+	{
+		auto [iter, inserted] = m_Attributes.try_emplace( type );
+		auto &attributes = iter->second;
+
+		if(inserted)
+			Compute( type, attributes );
+
+		return attributes;
+	}
+
+	static void Compute( T *type, SchemaTypeAttributes &attributes )
+	{
+		type->GetSizeAndAlignment( attributes.m_nSize, attributes.m_nAlignment );
+		attributes.m_DisplayName = ReplaceString( type->m_sTypeName.Get(), "::", "__" );
+		attributes.m_SplitName = SplitTemplatedName( type->m_sTypeName.Get() );
+	}
+
+	void Reserve( size_t count ) { m_Attributes.reserve( count ); }
+	size_t Count() const { return m_Attributes.size(); }
+	size_t BucketCount() const { return m_Attributes.bucket_count(); }
+
+private:
+	// Node based, so references handed out by Get stay valid
+	std::unordered_map<T *, SchemaTypeAttributes> m_Attributes;
+};
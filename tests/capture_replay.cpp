@@ -0,0 +1,605 @@
+#include "capture_replay.h"
+#include "schemareader.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+struct BuiltinStandIn
+{
+	const char *m_pszName;
+	int m_nSize;
+};
+
+// Builtins a capture doesn't reference still get dumped, so they are named up front
+static const BuiltinStandIn s_Builtins[SCHEMA_BUILTIN_TYPE_COUNT] = {
+	{ "invalid", 0 },
+	{ "void", 0 },
+	{ "char", 1 },
+	{ "int8", 1 },
+	{ "uint8", 1 },
+	{ "int16", 2 },
+	{ "uint16", 2 },
+	{ "int32", 4 },
+	{ "uint32", 4 },
+	{ "int64", 8 },
+	{ "uint64", 8 },
+	{ "float32", 4 },
+	{ "float64", 8 },
+	{ "bool", 1 }
+};
+
+// Layouts of CSchemaNetworkVarName and CSchemaNetworkOverride, schema_metadata.h registers
+// its tags globally and is only ever included by schemareader.cpp
+struct CSchemaNetworkVarNameStandIn
+{
+	const char *m_FieldName;
+	const char *m_TypeName;
+};
+
+struct CSchemaNetworkOverrideStandIn
+{
+	const char *m_TypeName;
+	const char *m_FieldName;
+};
+
+// Opaque payloads are function or module pointers, zeroed data reads as nullptr through any of them
+alignas(16) static uint8 s_OpaquePayload[64] = {};
+
+SchemaCaptureReplay::SchemaCaptureReplay()
+{
+	auto gts = m_SchemaSystem.GlobalTypeScope();
+
+	for(int i = 0; i < SCHEMA_BUILTIN_TYPE_COUNT; i++)
+	{
+		auto &builtin = gts->m_BuiltinTypes[i];
+
+		builtin.m_sTypeName = s_Builtins[i].m_pszName;
+		builtin.m_nSize = (uint8)s_Builtins[i].m_nSize;
+		builtin.m_nStandInSize = s_Builtins[i].m_nSize;
+		builtin.m_nStandInAlignment = (uint8)s_Builtins[i].m_nSize;
+	}
+}
+
+bool SchemaCaptureReplay::Load( const char *path, std::string &err )
+{
+	std::ifstream inp( path, std::ios::binary );
+	if(!inp.is_open())
+	{
+		err = std::string( "Failed to open " ) + path;
+		return false;
+	}
+
+	std::stringstream buf;
+	buf << inp.rdbuf();
+
+	KeyValues3 root;
+	CUtlString parse_err;
+	if(!LoadKV3FromJSON( &root, &parse_err, buf.str().c_str(), path ))
+	{
+		err = parse_err.Get();
+		return false;
+	}
+
+	// Payload kinds were added in version 2, older captures can't have their metadata rebuilt
+	int capture_version = root.GetMemberInt( "capture_version" );
+	if(capture_version < 2 || capture_version > SR_CAPTURE_FORMAT_VERSION)
+	{
+		err = "Unsupported capture format version " + std::to_string( capture_version ) + ", replay supports 2 to " + std::to_string( SR_CAPTURE_FORMAT_VERSION );
+		return false;
+	}
+
+	auto scopes = root.FindMember( "scopes" );
+	if(!scopes || scopes->GetArrayElementCount() == 0)
+	{
+		err = "Capture has no type scopes";
+		return false;
+	}
+
+	return LoadScopes( scopes, err );
+}
+
+bool SchemaCaptureReplay::LoadScopes( KeyValues3 *scopes, std::string &err )
+{
+	std::vector<CSchemaSystemTypeScope *> type_scopes;
+
+	// First scope is always the global one
+	for(int i = 0; i < scopes->GetArrayElementCount(); i++)
+	{
+		const char *name = scopes->GetArrayElement( i )->GetMemberString( "name" );
+		CSchemaSystemTypeScope *ts;
+
+		if(i == 0)
+		{
+			ts = m_SchemaSystem.GlobalTypeScope();
+			ts->SetScopeName( name );
+		}
+		else
+		{
+			m_TypeScopes.push_back( std::make_unique<CSchemaSystemTypeScope>( name ) );
+			ts = m_TypeScopes.back().get();
+			m_SchemaSystem.m_TypeScopes.m_Elements.push_back( ts );
+		}
+
+		if(!m_ScopesByName.emplace( name, ts ).second)
+		{
+			err = std::string( "Duplicate type scope " ) + name;
+			return false;
+		}
+
+		type_scopes.push_back( ts );
+	}
+
+	// Every declared type is known before any field references it
+	for(int i = 0; i < scopes->GetArrayElementCount(); i++)
+	{
+		auto scope = scopes->GetArrayElement( i );
+		auto classes = scope->FindMember( "classes" );
+		auto enums = scope->FindMember( "enums" );
+
+		if(auto atomics = scope->FindMember( "atomics" ))
+			LoadAtomics( type_scopes[i], atomics );
+
+		for(int k = 0; classes && k < classes->GetArrayElementCount(); k++)
+			DeclareClass( type_scopes[i], classes->GetArrayElement( k ) );
+
+		for(int k = 0; enums && k < enums->GetArrayElementCount(); k++)
+			LoadEnum( type_scopes[i], enums->GetArrayElement( k ) );
+	}
+
+	for(int i = 0; i < scopes->GetArrayElementCount(); i++)
+	{
+		auto classes = scopes->GetArrayElement( i )->FindMember( "classes" );
+		auto &scope_types = m_TypesByKey[type_scopes[i]];
+
+		for(int k = 0; classes && k < classes->GetArrayElementCount(); k++)
+		{
+			auto kv = classes->GetArrayElement( k );
+			auto type = scope_types[std::to_string( SCHEMA_TYPE_DECLARED_CLASS ) + ":" + kv->GetMemberString( "name" )];
+
+			LoadClass( type->ReinterpretAs<CSchemaType_DeclaredClass>(), kv );
+		}
+	}
+
+	return true;
+}
+
+void SchemaCaptureReplay::LoadAtomics( CSchemaSystemTypeScope *ts, KeyValues3 *atomics )
+{
+	for(int i = 0; i < atomics->GetArrayElementCount(); i++)
+	{
+		auto kv = atomics->GetArrayElement( i );
+		auto info = Allocate<SchemaAtomicTypeInfo_t>();
+
+		info->m_pszName = Intern( kv->GetMemberString( "name" ) );
+		info->m_pszTokenName = info->m_pszName;
+		info->m_nAtomicID = kv->GetMemberInt( "token", -1 );
+		info->m_pStaticMetadata = LoadMetaTags( kv, info->m_nStaticMetadataCount );
+
+		ts->AddAtomicInfo( info );
+		m_AtomicsByToken.emplace( info->m_nAtomicID, info );
+	}
+}
+
+void SchemaCaptureReplay::LoadEnum( CSchemaSystemTypeScope *ts, KeyValues3 *kv )
+{
+	auto type = Allocate<CSchemaType_DeclaredEnum>();
+
+	type->m_sTypeName = kv->GetMemberString( "name" );
+	type->m_pTypeScope = ts;
+	type->m_eTypeCategory = SCHEMA_TYPE_DECLARED_ENUM;
+
+	m_TypesByKey[ts].emplace( std::to_string( SCHEMA_TYPE_DECLARED_ENUM ) + ":" + type->m_sTypeName.Get(), type );
+
+	// Enums without an info only have their name captured
+	if(kv->FindMember( "project" ))
+	{
+		auto ei = Allocate<CSchemaEnumInfo>();
+
+		ei->m_pSelf = ei;
+		ei->m_pszName = Intern( type->m_sTypeName.Get() );
+		ei->m_pszProjectName = Intern( kv->GetMemberString( "project" ) );
+		ei->m_nSize = (uint8)kv->GetMemberInt( "size" );
+		ei->m_nAlignment = (uint8)kv->GetMemberInt( "alignment" );
+		ei->m_nFlags = (uint8)kv->GetMemberUInt( "flags" );
+		ei->m_nMinEnumeratorValue = kv->GetMemberInt64( "min_value" );
+		ei->m_nMaxEnumeratorValue = kv->GetMemberInt64( "max_value" );
+		ei->m_pTypeScope = ts;
+
+		int metatag_count;
+		ei->m_pStaticMetadata = LoadMetaTags( kv, metatag_count );
+		ei->m_nStaticMetadataCount = (uint16)metatag_count;
+
+		auto enumerators = kv->FindMember( "enumerators" );
+		ei->m_nEnumeratorCount = enumerators ? (uint16)enumerators->GetArrayElementCount() : 0;
+		ei->m_pEnumerators = AllocateArray<SchemaEnumeratorInfoData_t>( ei->m_nEnumeratorCount );
+
+		for(int i = 0; i < ei->m_nEnumeratorCount; i++)
+		{
+			auto enumerator_kv = enumerators->GetArrayElement( i );
+			auto &enumerator = ei->m_pEnumerators[i];
+
+			enumerator.m_pszName = Intern( enumerator_kv->GetMemberString( "name" ) );
+			enumerator.m_nValue = enumerator_kv->GetMemberInt64( "value" );
+			enumerator.m_pStaticMetadata = LoadMetaTags( enumerator_kv, enumerator.m_nStaticMetadataCount );
+		}
+
+		type->m_pEnumInfo = ei;
+		type->m_nStandInSize = ei->m_nSize;
+		type->m_nStandInAlignment = ei->m_nAlignment;
+	}
+
+	ts->AddDeclaredEnum( type );
+	m_nEnumCount++;
+}
+
+void SchemaCaptureReplay::DeclareClass( CSchemaSystemTypeScope *ts, KeyValues3 *kv )
+{
+	auto type = Allocate<CSchemaType_DeclaredClass>();
+
+	type->m_sTypeName = kv->GetMemberString( "name" );
+	type->m_pTypeScope = ts;
+	type->m_eTypeCategory = SCHEMA_TYPE_DECLARED_CLASS;
+
+	m_TypesByKey[ts].emplace( std::to_string( SCHEMA_TYPE_DECLARED_CLASS ) + ":" + type->m_sTypeName.Get(), type );
+
+	// Classes without an info only have their name captured, bases and fields are filled in by LoadClass
+	if(kv->FindMember( "project" ))
+	{
+		auto ci = Allocate<CSchemaClassInfo>();
+
+		ci->m_pSelf = ci;
+		ci->m_pszName = Intern( type->m_sTypeName.Get() );
+		ci->m_pszProjectName = Intern( kv->GetMemberString( "project" ) );
+		ci->m_nSize = kv->GetMemberInt( "size" );
+		ci->m_nAlignment = (uint8)kv->GetMemberInt( "alignment" );
+		ci->m_nFlags1 = kv->GetMemberUInt( "flags1" );
+		ci->m_nFlags2 = kv->GetMemberUInt( "flags2" );
+		ci->m_nMultipleInheritanceDepth = (uint16)kv->GetMemberUInt( "multi_depth" );
+		ci->m_nSingleInheritanceDepth = (uint16)kv->GetMemberUInt( "single_depth" );
+		ci->m_pTypeScope = ts;
+		ci->m_pDeclaredClass = type;
+
+		int metatag_count;
+		ci->m_pStaticMetadata = LoadMetaTags( kv, metatag_count );
+		ci->m_nStaticMetadataCount = (uint16)metatag_count;
+
+		type->m_pClassInfo = ci;
+		type->m_nStandInSize = ci->m_nSize;
+		type->m_nStandInAlignment = ci->m_nAlignment;
+	}
+
+	ts->AddDeclaredClass( type );
+	m_nClassCount++;
+}
+
+void SchemaCaptureReplay::LoadClass( CSchemaType_DeclaredClass *type, KeyValues3 *kv )
+{
+	auto ci = type->m_pClassInfo;
+	if(!ci)
+		return;
+
+	if(auto bases = kv->FindMember( "bases" ))
+	{
+		ci->m_pBaseClasses = AllocateArray<SchemaBaseClassInfoData_t>( bases->GetArrayElementCount() );
+
+		for(int i = 0; i < bases->GetArrayElementCount(); i++)
+		{
+			auto base_kv = bases->GetArrayElement( i );
+			auto base_type = ResolveDeclaredType( base_kv, SCHEMA_TYPE_DECLARED_CLASS, type->m_pTypeScope )->ReinterpretAs<CSchemaType_DeclaredClass>();
+
+			// Reader expects every base to have an info, these only happen with truncated captures
+			if(!base_type->m_pClassInfo)
+			{
+				META_CONPRINTF( "Base class \"%s\" of \"%s\" isn't captured, skipping it.\n", base_type->m_sTypeName.Get(), ci->m_pszName );
+				continue;
+			}
+
+			ci->m_pBaseClasses[ci->m_nBaseClassCount++] = { base_kv->GetMemberUInt( "offset" ), base_type->m_pClassInfo };
+		}
+	}
+
+	if(auto fields = kv->FindMember( "fields" ))
+	{
+		ci->m_nFieldCount = (uint16)fields->GetArrayElementCount();
+		ci->m_pFields = AllocateArray<SchemaClassFieldData_t>( ci->m_nFieldCount );
+
+		for(int i = 0; i < ci->m_nFieldCount; i++)
+		{
+			auto field_kv = fields->GetArrayElement( i );
+			auto &field = ci->m_pFields[i];
+
+			field.m_pszName = Intern( field_kv->GetMemberString( "name" ) );
+			field.m_nSingleInheritanceOffset = field_kv->GetMemberInt( "offset" );
+			field.m_pStaticMetadata = LoadMetaTags( field_kv, field.m_nStaticMetadataCount );
+			field.m_pType = ResolveType( type->m_pTypeScope, field_kv->FindMember( "type" ) );
+		}
+
+		m_nFieldCount += ci->m_nFieldCount;
+	}
+}
+
+CSchemaSystemTypeScope *SchemaCaptureReplay::FindScope( const char *name )
+{
+	auto iter = m_ScopesByName.find( name );
+	return iter != m_ScopesByName.end() ? iter->second : nullptr;
+}
+
+CSchemaType *SchemaCaptureReplay::ResolveDeclaredType( KeyValues3 *kv, SchemaTypeCategory_t category, CSchemaSystemTypeScope *fallback )
+{
+	auto ts = FindScope( kv->GetMemberString( "scope" ) );
+	if(!ts)
+		ts = fallback;
+
+	auto key = std::to_string( category ) + ":" + kv->GetMemberString( "name" );
+	auto &type = m_TypesByKey[ts][key];
+
+	// Referenced but not registered in its scope, the reader sees such types with no info attached
+	if(!type)
+	{
+		if(category == SCHEMA_TYPE_DECLARED_CLASS)
+			type = Allocate<CSchemaType_DeclaredClass>();
+		else
+			type = Allocate<CSchemaType_DeclaredEnum>();
+
+		type->m_sTypeName = kv->GetMemberString( "name" );
+		type->m_pTypeScope = ts;
+		type->m_eTypeCategory = category;
+	}
+
+	return type;
+}
+
+CSchemaType *SchemaCaptureReplay::ResolveType( CSchemaSystemTypeScope *ts, KeyValues3 *kv )
+{
+	auto category = (SchemaTypeCategory_t)kv->GetMemberInt( "category", SCHEMA_TYPE_INVALID );
+
+	switch(category)
+	{
+		case SCHEMA_TYPE_BUILTIN:
+		{
+			int builtin = kv->GetMemberInt( "builtin" );
+			if(builtin > SCHEMA_BUILTIN_TYPE_INVALID && builtin < SCHEMA_BUILTIN_TYPE_COUNT)
+				return &m_SchemaSystem.GlobalTypeScope()->m_BuiltinTypes[builtin];
+
+			break;
+		}
+
+		case SCHEMA_TYPE_DECLARED_CLASS:
+		case SCHEMA_TYPE_DECLARED_ENUM:
+		{
+			return ResolveDeclaredType( kv, category, ts );
+		}
+
+		default:
+			break;
+	}
+
+	// Bitfields and fixed arrays of the same name can still differ in their counts
+	auto key = std::to_string( category ) + ":" + kv->GetMemberString( "name" ) + ":" + std::to_string( kv->GetMemberInt( "count" ) );
+	auto &scope_types = m_TypesByKey[ts];
+
+	auto iter = scope_types.find( key );
+	if(iter != scope_types.end())
+		return iter->second;
+
+	CSchemaType *type;
+
+	switch(category)
+	{
+		case SCHEMA_TYPE_POINTER:
+		{
+			auto ptr = Allocate<CSchemaType_Ptr>();
+			ptr->m_pObjectType = ResolveType( ts, kv->FindOrCreateMember( "inner" ) );
+
+			type = ptr;
+			break;
+		}
+
+		case SCHEMA_TYPE_FIXED_ARRAY:
+		{
+			auto fixed_array = Allocate<CSchemaType_FixedArray>();
+
+			fixed_array->m_nElementCount = kv->GetMemberInt( "count" );
+			fixed_array->m_nElementSize = (uint16)kv->GetMemberInt( "element_size" );
+			fixed_array->m_nElementAlignment = (uint8)kv->GetMemberInt( "element_alignment" );
+			fixed_array->m_pElementType = ResolveType( ts, kv->FindOrCreateMember( "inner" ) );
+
+			type = fixed_array;
+			break;
+		}
+
+		case SCHEMA_TYPE_BITFIELD:
+		{
+			auto bitfield = Allocate<CSchemaType_Bitfield>();
+			bitfield->m_nBitfieldCount = kv->GetMemberInt( "count" );
+
+			type = bitfield;
+			break;
+		}
+
+		case SCHEMA_TYPE_ATOMIC:
+		{
+			auto atomic_category = (SchemaAtomicCategory_t)kv->GetMemberInt( "atomic_category", SCHEMA_ATOMIC_INVALID );
+			auto templ = kv->FindOrCreateMember( "template" );
+			CSchemaType_Atomic *atomic;
+
+			switch(atomic_category)
+			{
+				case SCHEMA_ATOMIC_T:
+				{
+					auto atomic_t = Allocate<CSchemaType_Atomic_T>();
+					atomic_t->m_pTemplateType = ResolveType( ts, templ->GetArrayElement( 0 ) );
+
+					atomic = atomic_t;
+					break;
+				}
+
+				case SCHEMA_ATOMIC_COLLECTION_OF_T:
+				{
+					auto collection = Allocate<CSchemaType_Atomic_CollectionOfT>();
+
+					collection->m_nElementSize = (uint16)kv->GetMemberInt( "element_size" );
+					collection->m_nFixedBufferCount = kv->GetMemberUInt64( "fixed_buffer_count" );
+					collection->m_pTemplateType = ResolveType( ts, templ->GetArrayElement( 0 ) );
+
+					atomic = collection;
+					break;
+				}
+
+				case SCHEMA_ATOMIC_TT:
+				{
+					auto atomic_tt = Allocate<CSchemaType_Atomic_TT>();
+
+					atomic_tt->m_pTemplateType = ResolveType( ts, templ->GetArrayElement( 0 ) );
+					atomic_tt->m_pTemplateType2 = ResolveType( ts, templ->GetArrayElement( 1 ) );
+
+					atomic = atomic_tt;
+					break;
+				}
+
+				case SCHEMA_ATOMIC_I:
+				{
+					auto atomic_i = Allocate<CSchemaType_Atomic_I>();
+					atomic_i->m_nInteger = kv->GetMemberInt( "integer" );
+
+					atomic = atomic_i;
+					break;
+				}
+
+				default:
+				{
+					atomic = Allocate<CSchemaType_Atomic>();
+					break;
+				}
+			}
+
+			auto info = m_AtomicsByToken.find( kv->GetMemberInt( "atomic_token", -1 ) );
+
+			atomic->m_eAtomicCategory = atomic_category;
+			atomic->m_pAtomicInfo = info != m_AtomicsByToken.end() ? info->second : nullptr;
+			atomic->m_nAtomicID = kv->GetMemberInt( "atomic_token", -1 );
+			atomic->m_nSize = (uint16)kv->GetMemberInt( "size" );
+			atomic->m_nAlignment = (uint8)kv->GetMemberInt( "alignment" );
+
+			type = atomic;
+			break;
+		}
+
+		default:
+		{
+			type = Allocate<CSchemaType>();
+			break;
+		}
+	}
+
+	type->m_sTypeName = kv->GetMemberString( "name" );
+	type->m_pTypeScope = ts;
+	type->m_eTypeCategory = category;
+	type->m_nStandInSize = kv->GetMemberInt( "size" );
+	type->m_nStandInAlignment = (uint8)kv->GetMemberInt( "alignment" );
+
+	scope_types.emplace( key, type );
+	return type;
+}
+
+SchemaMetadataEntryData_t *SchemaCaptureReplay::LoadMetaTags( KeyValues3 *kv, int &count )
+{
+	auto metatags = kv->FindMember( "metatags" );
+
+	count = metatags ? metatags->GetArrayElementCount() : 0;
+	auto data = AllocateArray<SchemaMetadataEntryData_t>( count );
+
+	for(int i = 0; i < count; i++)
+	{
+		auto metatag = metatags->GetArrayElement( i );
+
+		data[i].m_pszName = Intern( metatag->GetMemberString( "name" ) );
+		data[i].m_pData = MakePayload( metatag->GetMemberString( "kind", "opaque" ), metatag->GetMemberString( "value" ) );
+	}
+
+	return data;
+}
+
+void *SchemaCaptureReplay::MakePayload( const char *kind, const char *value )
+{
+	if(std::strcmp( kind, "empty" ) == 0)
+		return nullptr;
+
+	if(std::strcmp( kind, "string" ) == 0)
+	{
+		auto payload = Allocate<const char *>();
+		*payload = Intern( value );
+		return payload;
+	}
+
+	if(std::strcmp( kind, "inline_string" ) == 0)
+	{
+		auto payload = AllocateArray<char>( 8 );
+		std::memcpy( payload, value, std::min<size_t>( std::strlen( value ), 8 ) );
+		return payload;
+	}
+
+	if(std::strcmp( kind, "int" ) == 0)
+	{
+		auto payload = Allocate<int>();
+		*payload = (int)std::strtol( value, nullptr, 10 );
+		return payload;
+	}
+
+	if(std::strcmp( kind, "float" ) == 0)
+	{
+		auto payload = Allocate<float>();
+		*payload = std::strtof( value, nullptr );
+		return payload;
+	}
+
+	// Stringified as "type field", type is optional
+	if(std::strcmp( kind, "var_name" ) == 0)
+	{
+		auto payload = Allocate<CSchemaNetworkVarNameStandIn>();
+		std::string str = value;
+
+		auto split = str.rfind( ' ' );
+		if(split == std::string::npos)
+		{
+			payload->m_FieldName = Intern( value );
+		}
+		else
+		{
+			payload->m_FieldName = Intern( str.substr( split + 1 ).c_str() );
+			payload->m_TypeName = Intern( str.substr( 0, split ).c_str() );
+		}
+
+		return payload;
+	}
+
+	// Stringified as "Class::field", class is optional
+	if(std::strcmp( kind, "override" ) == 0)
+	{
+		auto payload = Allocate<CSchemaNetworkOverrideStandIn>();
+		std::string str = value;
+
+		auto split = str.rfind( "::" );
+		if(split == std::string::npos)
+		{
+			payload->m_FieldName = Intern( value );
+		}
+		else
+		{
+			payload->m_FieldName = Intern( str.substr( split + 2 ).c_str() );
+			payload->m_TypeName = Intern( str.substr( 0, split ).c_str() );
+		}
+
+		return payload;
+	}
+
+	return s_OpaquePayload;
+}
+
+const char *SchemaCaptureReplay::Intern( const char *str )
+{
+	m_Strings.emplace_back( str );
+	return m_Strings.back().c_str();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "schemasystem/schemasystem.h"
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Rebuilds schema system stand-ins (type scopes, class, enum and atomic infos) out of a capture
+// written by the "capture" dump flag, so the reader can be run over real data without the game.
+// Metadata payloads are rebuilt from their stringified values by the payload kind recorded with them,
+// opaque ones (function and module pointers) point to zeroed data
+class SchemaCaptureReplay
+{
+public:
+	SchemaCaptureReplay();
+
+	// Returns false and sets err if the capture can't be replayed
+	bool Load( const char *path, std::string &err );
+
+	CSchemaSystem *GetSchemaSystem() { return &m_SchemaSystem; }
+
+	int GetClassCount() const { return m_nClassCount; }
+	int GetEnumCount() const { return m_nEnumCount; }
+	int GetFieldCount() const { return m_nFieldCount; }
+
+private:
+	bool LoadScopes( KeyValues3 *scopes, std::string &err );
+	void LoadAtomics( CSchemaSystemTypeScope *ts, KeyValues3 *atomics );
+	void LoadEnum( CSchemaSystemTypeScope *ts, KeyValues3 *kv );
+	void DeclareClass( CSchemaSystemTypeScope *ts, KeyValues3 *kv );
+	void LoadClass( CSchemaType_DeclaredClass *type, KeyValues3 *kv );
+
+	CSchemaSystemTypeScope *FindScope( const char *name );
+	CSchemaType *ResolveType( CSchemaSystemTypeScope *ts, KeyValues3 *kv );
+	CSchemaType *ResolveDeclaredType( KeyValues3 *kv, SchemaTypeCategory_t category, CSchemaSystemTypeScope *fallback );
+
+	SchemaMetadataEntryData_t *LoadMetaTags( KeyValues3 *kv, int &count );
+	void *MakePayload( const char *kind, const char *value );
+
+	const char *Intern( const char *str );
+
+	template <typename T>
+	T *Allocate()
+	{
+		auto obj = new T();
+		m_Allocations.push_back( std::shared_ptr<void>( obj, []( void *ptr ) { delete (T *)ptr; } ) );
+		return obj;
+	}
+
+	template <typename T>
+	T *AllocateArray( int count )
+	{
+		if(count <= 0)
+			return nullptr;
+
+		auto arr = new T[count]();
+		m_Allocations.push_back( std::shared_ptr<void>( arr, []( void *ptr ) { delete[] (T *)ptr; } ) );
+		return arr;
+	}
+
+	CSchemaSystem m_SchemaSystem;
+	std::vector<std::unique_ptr<CSchemaSystemTypeScope>> m_TypeScopes;
+	std::unordered_map<std::string, CSchemaSystemTypeScope *> m_ScopesByName;
+
+	std::deque<std::string> m_Strings;
+	std::vector<std::shared_ptr<void>> m_Allocations;
+
+	// Non declared types are unique per scope and contents, as they are in schema system
+	std::unordered_map<CSchemaSystemTypeScope *, std::unordered_map<std::string, CSchemaType *>> m_TypesByKey;
+	std::unordered_map<int, SchemaAtomicTypeInfo_t *> m_AtomicsByToken;
+
+	int m_nClassCount = 0;
+	int m_nEnumCount = 0;
+	int m_nFieldCount = 0;
+};
@@ -0,0 +1,10 @@
+// Stand-in for a game module exporting ExtractModuleMetadata, built by tests/Makefile with a fixed build id
+// (see STUB_BUILD_ID there). Real modules return a KeyValues3, tests only check that the symbol resolves
+
+static int s_StubMetadata = 44;
+
+void *ExtractModuleMetadata( void *additional_info )
+{
+	(void)additional_info;
+	return &s_StubMetadata;
+}
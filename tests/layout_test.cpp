@@ -0,0 +1,80 @@
+#include "schemalayout.h"
+
+#include <cstdio>
+#include <cstring>
+
+static int s_nFailures = 0;
+
+#define EXPECT( cond ) \
+	do { if(!(cond)) { std::printf( "%s:%d: EXPECT( %s ) failed\n", __FILE__, __LINE__, #cond ); s_nFailures++; } } while(0)
+
+// struct { int32 m_nFirst; uint16 m_bA : 3, m_nB : 5; uint16 m_nC : 9; int32 m_nLast; }, bitfields
+// are added the way ReadLayoutReports does, one field per storage unit
+static void TestBitfieldRun()
+{
+	const char *names[] = { "m_bA", "m_nB", "m_nC" };
+	const bool networked[] = { false, true, false };
+	const int bit_counts[] = { 3, 5, 9 };
+
+	SchemaBitfieldPlacement placements[3];
+	int end = PlaceSchemaBitfieldRun( 4, bit_counts, 3, placements );
+
+	EXPECT( end == 8 );
+	EXPECT( placements[0].m_nStorageOffset == 4 && placements[0].m_nUnitSize == 2 && placements[0].m_nShift == 0 );
+	EXPECT( placements[1].m_nStorageOffset == 4 && placements[1].m_nShift == 3 && placements[1].m_nMask == 0x1f );
+	EXPECT( placements[2].m_nStorageOffset == 6 && placements[2].m_nShift == 0 );
+
+	std::vector<SchemaLayoutField> fields;
+	fields.push_back( { "m_nFirst", 0, 4, true } );
+
+	for(int i = 0; i < 3; i++)
+		AddSchemaBitfieldUnit( fields, names[i], placements[i].m_nStorageOffset, placements[i].m_nUnitSize, networked[i] );
+
+	fields.push_back( { "m_nLast", end, 4, false } );
+
+	EXPECT( fields.size() == 4 );
+	EXPECT( std::strcmp( fields[1].m_pszName, "m_bA" ) == 0 && fields[1].m_bNetworked );
+	EXPECT( std::strcmp( fields[2].m_pszName, "m_nC" ) == 0 && !fields[2].m_bNetworked );
+
+	auto report = AnalyzeSchemaLayout( 12, fields );
+
+	// Units cover the bytes between the surrounding members, so there's nothing wasted
+	EXPECT( report.m_Holes.empty() );
+	EXPECT( report.m_nWastedBytes == 0 && report.m_nTailPadding == 0 );
+	EXPECT( report.m_nCacheLines == 1 );
+
+	EXPECT( report.m_SharedNetworkLines.size() == 1 );
+	EXPECT( report.m_SharedNetworkLines.size() == 1 && report.m_SharedNetworkLines[0].m_Fields.size() == 2 );
+}
+
+// Storage units of a later run at the same offset aren't merged into a non bitfield
+static void TestUnitsDontMergeWithFields()
+{
+	std::vector<SchemaLayoutField> fields;
+	fields.push_back( { "m_Union", 0, 4, false } );
+
+	AddSchemaBitfieldUnit( fields, "m_bA", 0, 1, false );
+	AddSchemaBitfieldUnit( fields, "m_bB", 1, 1, false );
+
+	EXPECT( fields.size() == 3 );
+	EXPECT( fields[1].m_bBitfieldUnit && fields[2].m_bBitfieldUnit );
+
+	// Trailing padding after the union still shows up
+	auto report = AnalyzeSchemaLayout( 8, fields );
+	EXPECT( report.m_Holes.empty() && report.m_nTailPadding == 4 && report.m_nWastedBytes == 4 );
+}
+
+int main()
+{
+	TestBitfieldRun();
+	TestUnitsDontMergeWithFields();
+
+	if(s_nFailures)
+	{
+		std::printf( "layout_test: %d failures\n", s_nFailures );
+		return 1;
+	}
+
+	std::printf( "layout_test: ok\n" );
+	return 0;
+}
@@ -0,0 +1,101 @@
+#include "schemamodules.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <dlfcn.h>
+#include <stdlib.h>
+
+static int s_nFailures = 0;
+
+#define EXPECT( cond ) \
+	do { if(!(cond)) { std::printf( "%s:%d: EXPECT( %s ) failed\n", __FILE__, __LINE__, #cond ); s_nFailures++; } } while(0)
+
+#ifndef STUB_MODULE_PATH
+#error STUB_MODULE_PATH and STUB_BUILD_ID have to be provided by the build
+#endif
+
+static const SchemaLoadedModule *FindModule( const std::vector<SchemaLoadedModule> &modules, const std::string &path )
+{
+	for(auto &module : modules)
+	{
+		if(std::filesystem::equivalent( module.m_Path, path ))
+			return &module;
+	}
+
+	return nullptr;
+}
+
+static void TestBuildId()
+{
+	auto path = std::filesystem::absolute( STUB_MODULE_PATH ).string();
+
+	EXPECT( !FindModule( EnumerateLoadedModules(), path ) );
+
+	void *handle = dlopen( path.c_str(), RTLD_NOW );
+	EXPECT( handle );
+	if(!handle)
+		return;
+
+	auto modules = EnumerateLoadedModules();
+	auto module = FindModule( modules, path );
+
+	EXPECT( module && module->m_BuildId == STUB_BUILD_ID );
+
+	// Same way the reader gets to the symbol of an already loaded module
+	void *noload = module ? dlopen( module->m_Path.c_str(), RTLD_NOW | RTLD_NOLOAD ) : nullptr;
+	EXPECT( noload );
+
+	if(noload)
+	{
+		auto func = (void *(*)( void * ))dlsym( noload, "ExtractModuleMetadata" );
+		EXPECT( func && *(int *)func( nullptr ) == 44 );
+		dlclose( noload );
+	}
+
+	dlclose( handle );
+}
+
+static void TestCache()
+{
+	char dir_template[] = "/tmp/schemadump_modules_test_XXXXXX";
+	if(!mkdtemp( dir_template ))
+	{
+		EXPECT( false );
+		return;
+	}
+
+	SchemaModuleCache cache( dir_template );
+	std::string content;
+
+	// Modules without a build id are never cached
+	EXPECT( cache.GetPath( "" ).empty() );
+	EXPECT( !cache.Load( "", content ) );
+
+	EXPECT( cache.GetPath( STUB_BUILD_ID ) == std::filesystem::path( dir_template ) / (STUB_BUILD_ID ".kv3") );
+	EXPECT( !cache.Load( STUB_BUILD_ID, content ) );
+
+	std::ofstream( cache.GetPath( STUB_BUILD_ID ) ) << "{ has_metadata = false }";
+
+	EXPECT( cache.Load( STUB_BUILD_ID, content ) && content == "{ has_metadata = false }" );
+
+	// Other build of the same module misses
+	EXPECT( !cache.Load( "00" STUB_BUILD_ID, content ) );
+
+	std::filesystem::remove_all( dir_template );
+}
+
+int main()
+{
+	TestBuildId();
+	TestCache();
+
+	if(s_nFailures)
+	{
+		std::printf( "modules_test: %d failures\n", s_nFailures );
+		return 1;
+	}
+
+	std::printf( "modules_test: ok\n" );
+	return 0;
+}
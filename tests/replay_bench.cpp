@@ -0,0 +1,87 @@
+#include "capture_replay.h"
+#include "schemareader.h"
+#include "ISmmPlugin.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Runs the reader over a replayed capture, so dumper changes can be benchmarked on real schemas without the game:
+//   replay_bench [capture.json] [profiles] [iterations]
+// Dumps of the last iteration are written to build/replay/addons/schemadump/dumps
+static const char *s_DefaultCapture = "fixtures/sample_capture.json";
+static const char *s_DefaultProfiles = "all graph flattened layout_report net_report hierarchy topo_order | for_cpp metatags topo_order";
+static const int s_nDefaultIterations = 50;
+
+// Need live game data: module metadata and pulse bindings aren't part of captures, shm snapshots would be published
+static const uint32 s_LiveOnlyFlags = SchemaReader::SR_DUMP_PULSE_BINDINGS | SchemaReader::SR_DUMP_MODULE_METADATA | SchemaReader::SR_SHM_SNAPSHOT;
+
+int main( int argc, char **argv )
+{
+	const char *capture_path = argc > 1 ? argv[1] : s_DefaultCapture;
+	const char *profiles_str = argc > 2 ? argv[2] : s_DefaultProfiles;
+	int iterations = argc > 3 ? std::atoi( argv[3] ) : s_nDefaultIterations;
+
+	if(iterations <= 0)
+		iterations = 1;
+
+	auto load_start = std::chrono::steady_clock::now();
+
+	SchemaCaptureReplay replay;
+	std::string err;
+	if(!replay.Load( capture_path, err ))
+	{
+		std::printf( "replay_bench: %s\n", err.c_str() );
+		return 1;
+	}
+
+	auto load_end = std::chrono::steady_clock::now();
+
+	g_pSchemaSystem = replay.GetSchemaSystem();
+	g_SMAPI->SetBaseDir( "build/replay" );
+
+	auto profiles = SchemaReader::ParseDumpProfiles( profiles_str );
+	for(auto &profile : profiles)
+		profile &= ~s_LiveOnlyFlags;
+
+	// First read is done unmuted and untimed, so warnings of the replayed data are visible once
+	std::unique_ptr<SchemaReader> reader = std::make_unique<SchemaReader>();
+	if(!reader->ReadSchema( profiles ))
+	{
+		std::printf( "replay_bench: reader rejected profiles \"%s\"\n", profiles_str );
+		return 1;
+	}
+
+	g_bStandInConsoleMuted = true;
+
+	auto read_start = std::chrono::steady_clock::now();
+	for(int i = 0; i < iterations; i++)
+	{
+		reader = std::make_unique<SchemaReader>();
+		reader->ReadSchema( profiles );
+	}
+	auto read_end = std::chrono::steady_clock::now();
+
+	auto write_start = std::chrono::steady_clock::now();
+	bool written = reader->WriteToOutDir();
+	auto write_end = std::chrono::steady_clock::now();
+
+	g_bStandInConsoleMuted = false;
+
+	if(!written)
+	{
+		std::printf( "replay_bench: failed to write dumps\n" );
+		return 1;
+	}
+
+	auto load_ms = std::chrono::duration<double, std::milli>( load_end - load_start ).count();
+	auto read_ms = std::chrono::duration<double, std::milli>( read_end - read_start ).count() / iterations;
+	auto write_ms = std::chrono::duration<double, std::milli>( write_end - write_start ).count();
+
+	std::printf( "replay_bench: %s, %d classes, %d fields, %d enums, %zu profiles, load %.2f ms, read %.3f ms (avg of %d), write %.2f ms\n",
+				 capture_path, replay.GetClassCount(), replay.GetFieldCount(), replay.GetEnumCount(), profiles.size(), load_ms, read_ms, iterations, write_ms );
+	return 0;
+}
@@ -0,0 +1,70 @@
+#include "schemadump_test_kv3.h"
+#include "schemadump_resolver.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Synthetic dump sized like a real server project, every class derives from the previous one
+// of its chain, so flattening and lookups both see deep inheritance
+static const int s_nClassCount = 4000;
+static const int s_nChainLength = 8;
+static const int s_nMembersPerClass = 12;
+static const int s_nLookups = 4000000;
+
+static std::string ClassName( int idx ) { return "C_SynthClass" + std::to_string( idx ); }
+static std::string MemberName( int idx, int k ) { return "m_nField" + std::to_string( idx ) + "_" + std::to_string( k ); }
+
+int main()
+{
+	auto defs = TestKV3::Array( { TestKV3::Object( { { "type", "builtin" }, { "name", "int32" }, { "size", 4 } } ) } );
+
+	for(int i = 0; i < s_nClassCount; i++)
+	{
+		auto members = TestKV3::Array( {} );
+		for(int k = 0; k < s_nMembersPerClass; k++)
+		{
+			auto subtype = TestKV3::Object( { { "type", "ref" }, { "ref_idx", 0 } } );
+			members.AddArrayElement( TestKV3::Object( { { "name", MemberName( i, k ).c_str() }, { "offset", 8 + k * 4 }, { "traits", TestKV3::Object( { { "subtype", subtype } } ) } } ) );
+		}
+
+		auto baseclasses = TestKV3::Array( {} );
+		if(i % s_nChainLength != 0)
+			baseclasses.AddArrayElement( TestKV3::Object( { { "ref_idx", i } } ) );
+
+		defs.AddArrayElement( TestKV3::Object( {
+			{ "type", "class" },
+			{ "name", ClassName( i ).c_str() },
+			{ "project", "server" },
+			{ "size", 64 },
+			{ "traits", TestKV3::Object( { { "members", members }, { "baseclasses", baseclasses } } ) }
+		} ) );
+	}
+
+	auto root = TestKV3::Object( { { "defs", defs } } );
+
+	std::vector<std::pair<uint64_t, uint64_t>> keys;
+	for(int i = 0; i < s_nClassCount; i++)
+		keys.emplace_back( SchemaDumpHashString( ClassName( i ).c_str() ), SchemaDumpHashString( MemberName( i - i % s_nChainLength, i % s_nMembersPerClass ).c_str() ) );
+
+	SchemaDumpResolver resolver;
+
+	auto build_start = std::chrono::steady_clock::now();
+	resolver.Build( &root, "server" );
+	auto build_end = std::chrono::steady_clock::now();
+
+	int64_t checksum = 0;
+	auto lookup_start = std::chrono::steady_clock::now();
+	for(int i = 0; i < s_nLookups; i++)
+	{
+		auto &key = keys[((size_t)i * 7919) % keys.size()];
+		checksum += resolver.FindOffset( key.first, key.second );
+	}
+	auto lookup_end = std::chrono::steady_clock::now();
+
+	auto build_ms = std::chrono::duration<double, std::milli>( build_end - build_start ).count();
+	auto lookup_ns = std::chrono::duration<double, std::nano>( lookup_end - lookup_start ).count() / s_nLookups;
+
+	std::printf( "resolver_bench: %zu entries, build %.2f ms, lookup %.1f ns (checksum %lld)\n", resolver.Count(), build_ms, lookup_ns, (long long)checksum );
+	return 0;
+}
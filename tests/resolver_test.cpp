@@ -0,0 +1,160 @@
+#include "schemadump_test_kv3.h"
+#include "schemadump_resolver.h"
+
+#include <cstdio>
+
+static int s_nFailures = 0;
+
+#define EXPECT( cond ) \
+	do { if(!(cond)) { std::printf( "%s:%d: EXPECT( %s ) failed\n", __FILE__, __LINE__, #cond ); s_nFailures++; } } while(0)
+
+static TestKV3 MakeRef( int idx )
+{
+	return TestKV3::Object( { { "type", "ref" }, { "ref_idx", idx } } );
+}
+
+static TestKV3 MakeMember( const char *name, int offset, TestKV3 subtype )
+{
+	return TestKV3::Object( { { "name", name }, { "offset", offset }, { "traits", TestKV3::Object( { { "subtype", std::move( subtype ) } } ) } } );
+}
+
+static TestKV3 MakeClass( const char *name, TestKV3 project, int size, std::vector<TestKV3> members, std::vector<TestKV3> baseclasses = {} )
+{
+	return TestKV3::Object( {
+		{ "type", "class" },
+		{ "name", name },
+		{ "project", std::move( project ) },
+		{ "size", size },
+		{ "traits", TestKV3::Object( { { "members", TestKV3::Array( std::move( members ) ) }, { "baseclasses", TestKV3::Array( std::move( baseclasses ) ) } } ) }
+	} );
+}
+
+static TestKV3 MakeBase( int idx, int offset )
+{
+	return TestKV3::Object( { { "ref_idx", idx }, { "offset", offset } } );
+}
+
+// Server and client both declare CBaseEntity with different layouts, CPlayer derives from the server one
+static TestKV3 MakeDump( bool interned )
+{
+	auto project = [interned]( const char *name, int idx ) { return interned ? TestKV3( idx ) : TestKV3( name ); };
+
+	auto defs = TestKV3::Array( {
+		TestKV3::Object( { { "type", "builtin" }, { "name", "int32" }, { "size", 4 } } ),
+		MakeClass( "CBaseEntity", project( "server", 0 ), 32, {
+			MakeMember( "m_iHealth", 16, MakeRef( 0 ) ),
+			MakeMember( "m_pOwner", 24, TestKV3::Object( { { "type", "ptr" } } ) )
+		} ),
+		MakeClass( "CBaseEntity", project( "client", 1 ), 48, {
+			MakeMember( "m_iHealth", 40, MakeRef( 0 ) )
+		} ),
+		MakeClass( "CPlayer", project( "server", 0 ), 64, {
+			MakeMember( "m_iHealth", 32, MakeRef( 0 ) ),
+			MakeMember( "m_Flags", 36, TestKV3::Object( { { "type", "bitfield" }, { "count", 3 }, { "storage_offset", 4 }, { "unit_size", 4 }, { "shift", 5 }, { "placement", "heuristic" } } ) ),
+			MakeMember( "m_Ammo", 40, TestKV3::Object( { { "type", "fixed_array" }, { "count", 4 }, { "subtype", MakeRef( 0 ) } } ) )
+		}, { MakeBase( 1, 0 ) } ),
+	} );
+
+	auto root = TestKV3::Object( { { "defs", std::move( defs ) } } );
+	if(interned)
+		root.SetMember( "strings", TestKV3::Array( { "server", "client" } ) );
+
+	return root;
+}
+
+static void TestUnfilteredReportsAmbiguity()
+{
+	auto root = MakeDump( false );
+
+	SchemaDumpResolver resolver;
+	EXPECT( resolver.Build( &root ) );
+
+	EXPECT( resolver.IsAmbiguous( SCHEMADUMP_HASH( "CBaseEntity" ) ) );
+	EXPECT( resolver.AmbiguousClasses().size() == 1 );
+	EXPECT( resolver.FindClassIdx( SCHEMADUMP_HASH( "CBaseEntity" ) ) == -1 );
+	EXPECT( resolver.Find( "CBaseEntity", "m_iHealth" ) == nullptr );
+
+	// Unambiguous classes are still resolved, inheriting from the def they reference
+	EXPECT( resolver.FindOffset( SCHEMADUMP_HASH( "CPlayer" ), SCHEMADUMP_HASH( "m_pOwner" ) ) == 24 );
+}
+
+static void TestProjectFilter( bool interned )
+{
+	auto root = MakeDump( interned );
+
+	SchemaDumpResolver server, client;
+	EXPECT( server.Build( &root, "server" ) );
+	EXPECT( client.Build( &root, "client" ) );
+
+	EXPECT( server.AmbiguousClasses().empty() );
+	EXPECT( client.AmbiguousClasses().empty() );
+
+	EXPECT( server.FindOffset( SCHEMADUMP_HASH( "CBaseEntity" ), SCHEMADUMP_HASH( "m_iHealth" ) ) == 16 );
+	EXPECT( client.FindOffset( SCHEMADUMP_HASH( "CBaseEntity" ), SCHEMADUMP_HASH( "m_iHealth" ) ) == 40 );
+	EXPECT( server.FindClassIdx( SCHEMADUMP_HASH( "CBaseEntity" ) ) == 1 );
+	EXPECT( client.FindClassIdx( SCHEMADUMP_HASH( "CBaseEntity" ) ) == 2 );
+	EXPECT( client.FindClassIdx( SCHEMADUMP_HASH( "CPlayer" ) ) == -1 );
+
+	// Derived field shadows the inherited one
+	EXPECT( server.FindOffset( SCHEMADUMP_HASH( "CPlayer" ), SCHEMADUMP_HASH( "m_iHealth" ) ) == 32 );
+
+	auto owner = server.Find( "CPlayer", "m_pOwner" );
+	EXPECT( owner && owner->m_Kind == SDFK_PTR && owner->m_nSize == (int32_t)sizeof( void * ) );
+
+	auto flags = server.Find( "CPlayer", "m_Flags" );
+	EXPECT( flags && flags->m_Kind == SDFK_BITFIELD && flags->m_nOffset == 4 && flags->m_nSize == 4 && flags->m_nBitShift == 5 && flags->m_nBitCount == 3 && flags->m_bInferredPlacement );
+
+	auto ammo = server.Find( "CPlayer", "m_Ammo" );
+	EXPECT( ammo && ammo->m_Kind == SDFK_FIXED_ARRAY && ammo->m_nSize == 16 && ammo->m_nTypeIdx == 0 );
+}
+
+static void TestMergedProjects()
+{
+	auto root = MakeDump( false );
+
+	// Def merged by dedupe_projects covers both projects
+	auto merged = root.FindMember( "defs" )->GetArrayElement( 1 );
+	merged->SetMember( "projects", TestKV3::Array( { "server", "client" } ) );
+
+	SchemaDumpResolver client;
+	EXPECT( client.Build( &root, "client" ) );
+	EXPECT( client.IsAmbiguous( SCHEMADUMP_HASH( "CBaseEntity" ) ) );
+	EXPECT( client.Find( "CBaseEntity", "m_iHealth" ) == nullptr );
+}
+
+static void TestHierarchy()
+{
+	auto root = MakeDump( false );
+	auto defs = root.FindMember( "defs" );
+
+	defs->GetArrayElement( 1 )->SetMember( "isa", TestKV3::Object( { { "pre", 0 }, { "post", 1 } } ) );
+	defs->GetArrayElement( 3 )->SetMember( "isa", TestKV3::Object( { { "pre", 1 }, { "post", 1 } } ) );
+
+	SchemaDumpResolver server;
+	EXPECT( server.Build( &root, "server" ) );
+	EXPECT( server.IsA( "CPlayer", "CBaseEntity" ) );
+	EXPECT( !server.IsA( "CBaseEntity", "CPlayer" ) );
+
+	// Ambiguous base can't be answered for
+	SchemaDumpResolver all;
+	EXPECT( all.Build( &root ) );
+	EXPECT( !all.IsA( "CPlayer", "CBaseEntity" ) );
+}
+
+int main()
+{
+	TestUnfilteredReportsAmbiguity();
+	TestProjectFilter( false );
+	TestProjectFilter( true );
+	TestMergedProjects();
+	TestHierarchy();
+
+	if(s_nFailures)
+	{
+		std::printf( "resolver_test: %d failures\n", s_nFailures );
+		return 1;
+	}
+
+	std::printf( "resolver_test: ok\n" );
+	return 0;
+}
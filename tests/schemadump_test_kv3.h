@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal in-memory node with the same accessors as KeyValues3 that public headers rely on,
+// used to build synthetic dumps without the sdk
+class TestKV3
+{
+public:
+	TestKV3() = default;
+	TestKV3( const char *value ) : m_String( value ), m_bIsString( true ) {}
+	TestKV3( int64_t value ) : m_nInt( value ) {}
+	TestKV3( int value ) : m_nInt( value ) {}
+
+	static TestKV3 Object( std::vector<std::pair<std::string, TestKV3>> members )
+	{
+		TestKV3 kv;
+		kv.m_Members = std::move( members );
+		return kv;
+	}
+
+	static TestKV3 Array( std::vector<TestKV3> elements )
+	{
+		TestKV3 kv;
+		kv.m_Elements = std::move( elements );
+		return kv;
+	}
+
+	TestKV3 *FindMember( const char *name )
+	{
+		for(auto &[member_name, value] : m_Members)
+		{
+			if(member_name == name)
+				return &value;
+		}
+
+		return nullptr;
+	}
+
+	void SetMember( const char *name, TestKV3 value )
+	{
+		if(auto member = FindMember( name ))
+			*member = std::move( value );
+		else
+			m_Members.emplace_back( name, std::move( value ) );
+	}
+
+	int GetArrayElementCount() const { return (int)m_Elements.size(); }
+	TestKV3 *GetArrayElement( int idx ) { return &m_Elements[idx]; }
+	void AddArrayElement( TestKV3 value ) { m_Elements.push_back( std::move( value ) ); }
+
+	const char *GetString( const char *def ) const { return m_bIsString ? m_String.c_str() : def; }
+	int GetInt( int def ) const { return m_bIsString ? def : (int)m_nInt; }
+
+private:
+	std::string m_String;
+	bool m_bIsString = false;
+	int64_t m_nInt = 0;
+
+	std::vector<std::pair<std::string, TestKV3>> m_Members;
+	std::vector<TestKV3> m_Elements;
+};
@@ -0,0 +1,227 @@
+#include "schemaservice.h"
+#include "schemadump_hash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+static int s_nFailures = 0;
+
+#define EXPECT( cond ) \
+	do { if(!(cond)) { std::printf( "%s:%d: EXPECT( %s ) failed\n", __FILE__, __LINE__, #cond ); s_nFailures++; } } while(0)
+
+static bool Contains( const std::string &str, const char *what )
+{
+	return str.find( what ) != std::string::npos;
+}
+
+// Stand-in for what the game thread copies out of schema system: CBaseEntity exists in both
+// server and client scopes, CPlayer derives from the server one
+static std::shared_ptr<const SchemaServiceSnapshot> MakeStandInSnapshot( uint64_t player_layout_hash )
+{
+	std::vector<SchemaServiceClass> classes( 3 );
+
+	classes[0] = { "CBaseEntity", "client.dll", "client", 48, 8, 0x1111, {}, {}, { { "m_iHealth", "int32", 40, {} } } };
+	classes[1] = { "CBaseEntity", "server.dll", "server", 32, 8, 0x2222, { "MNetworkVarNames" }, {}, { { "m_iHealth", "int32", 16, { "MNetworkEnable" } } } };
+	classes[2] = { "CPlayer", "server.dll", "server", 64, 8, player_layout_hash, {}, { { "CBaseEntity", 0, 1 } }, { { "m_iAmmo", "int32", 32, {} } } };
+
+	std::vector<SchemaServiceEnum> enums( 1 );
+	enums[0] = { "MoveType_t", "server.dll", 1, {}, { { "MOVETYPE_NONE", 0 }, { "MOVETYPE_WALK", 2 } } };
+
+	return std::make_shared<SchemaServiceSnapshot>( std::move( classes ), std::move( enums ) );
+}
+
+// Test client speaking the service framing over the socket, no game involved
+class TestClient
+{
+public:
+	explicit TestClient( const char *path )
+	{
+		m_Fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+
+		sockaddr_un addr = {};
+		addr.sun_family = AF_UNIX;
+		std::strcpy( addr.sun_path, path );
+
+		if(connect( m_Fd, (sockaddr *)&addr, sizeof( addr ) ) != 0)
+		{
+			close( m_Fd );
+			m_Fd = -1;
+		}
+	}
+
+	~TestClient()
+	{
+		if(m_Fd >= 0)
+			close( m_Fd );
+	}
+
+	bool IsConnected() const { return m_Fd >= 0; }
+
+	std::string Request( const std::string &request )
+	{
+		uint32_t length = (uint32_t)request.size();
+		uint8_t header[4] = { (uint8_t)length, (uint8_t)(length >> 8), (uint8_t)(length >> 16), (uint8_t)(length >> 24) };
+
+		if(write( m_Fd, header, 4 ) != 4 || write( m_Fd, request.data(), request.size() ) != (ssize_t)request.size())
+			return "";
+
+		if(!ReadExact( header, 4 ))
+			return "";
+
+		std::string response( header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24), '\0' );
+		return ReadExact( response.data(), response.size() ) ? response : "";
+	}
+
+private:
+	bool ReadExact( void *data, size_t size )
+	{
+		for(size_t received = 0; received < size;)
+		{
+			ssize_t result = read( m_Fd, (uint8_t *)data + received, size - received );
+			if(result <= 0)
+				return false;
+
+			received += result;
+		}
+
+		return true;
+	}
+
+	int m_Fd = -1;
+};
+
+static void TestRequests( const char *path )
+{
+	TestClient client( path );
+	EXPECT( client.IsConnected() );
+
+	auto response = client.Request( "class CBaseEntity" );
+	EXPECT( Contains( response, "\"scope\":\"client.dll\"" ) && Contains( response, "\"scope\":\"server.dll\"" ) );
+	EXPECT( !Contains( response, "metatags" ) );
+
+	response = client.Request( "def CBaseEntity" );
+	EXPECT( Contains( response, "\"metatags\":[\"MNetworkVarNames\"]" ) && Contains( response, "\"metatags\":[\"MNetworkEnable\"]" ) );
+
+	response = client.Request( "def MoveType_t" );
+	EXPECT( Contains( response, "{\"name\":\"MOVETYPE_WALK\",\"value\":2}" ) );
+
+	response = client.Request( "field CPlayer m_iHealth" );
+	EXPECT( response == "{\"fields\":[{\"scope\":\"server.dll\",\"offset\":16,\"type\":\"int32\",\"declared_in\":\"CBaseEntity\"}]}" );
+
+	response = client.Request( "field CPlayer m_nMissing" );
+	EXPECT( response == "{\"fields\":[]}" );
+
+	response = client.Request( "changed CPlayer 0000000000003333" );
+	EXPECT( response == "{\"changed\":false,\"layout_hash\":\"0000000000003333\"}" );
+
+	// Same named classes of different scopes differing counts as a change
+	response = client.Request( "changed CBaseEntity 0000000000002222" );
+	EXPECT( Contains( response, "\"changed\":true" ) );
+
+	EXPECT( Contains( client.Request( "class CMissing" ), "\"error\"" ) );
+	EXPECT( Contains( client.Request( "bogus" ), "\"error\"" ) );
+}
+
+static void TestRepublish( const char *path )
+{
+	TestClient client( path );
+
+	auto before = client.Request( "changed CPlayer 0000000000003333" );
+	EXPECT( Contains( before, "\"changed\":false" ) );
+
+	auto combined = client.Request( "changed 0" );
+	auto combined_hash = combined.substr( combined.find( "layout_hash" ) );
+
+	// Game thread publishing a new snapshot is picked up by an already connected client
+	PublishSchemaServiceSnapshot( MakeStandInSnapshot( 0x4444 ) );
+
+	auto after = client.Request( "changed CPlayer 0000000000003333" );
+	EXPECT( after == "{\"changed\":true,\"layout_hash\":\"0000000000004444\"}" );
+
+	combined = client.Request( "changed 0" );
+	EXPECT( combined.substr( combined.find( "layout_hash" ) ) != combined_hash );
+
+	PublishSchemaServiceSnapshot( nullptr );
+	EXPECT( Contains( client.Request( "class CPlayer" ), "\"error\"" ) );
+}
+
+static void TestSocketFile( const std::string &dir )
+{
+	std::string err;
+
+	// Regular file at the path is left alone
+	auto file_path = dir + "/not_a_socket";
+	close( open( file_path.c_str(), O_CREAT | O_WRONLY, 0644 ) );
+
+	EXPECT( !StartSchemaServiceServer( file_path.c_str(), err ) );
+	EXPECT( !err.empty() );
+	EXPECT( access( file_path.c_str(), F_OK ) == 0 );
+	unlink( file_path.c_str() );
+
+	// Stale socket of a previous run gets replaced
+	auto socket_path = dir + "/stale.sock";
+	int stale_fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	std::strcpy( addr.sun_path, socket_path.c_str() );
+	EXPECT( bind( stale_fd, (sockaddr *)&addr, sizeof( addr ) ) == 0 );
+	close( stale_fd );
+
+	EXPECT( StartSchemaServiceServer( socket_path.c_str(), err ) );
+
+	struct stat st;
+	EXPECT( lstat( socket_path.c_str(), &st ) == 0 && S_ISSOCK( st.st_mode ) && (st.st_mode & 0777) == 0600 );
+
+	// Second instance can't take over the running one
+	EXPECT( !StartSchemaServiceServer( socket_path.c_str(), err ) );
+
+	StopSchemaServiceServer();
+	EXPECT( access( socket_path.c_str(), F_OK ) != 0 );
+}
+
+int main()
+{
+	char dir_template[] = "/tmp/schemadump_service_test_XXXXXX";
+	if(!mkdtemp( dir_template ))
+	{
+		std::printf( "service_test: failed to create temp dir\n" );
+		return 1;
+	}
+
+	std::string dir = dir_template;
+	std::string path = dir + "/service.sock";
+	std::string err;
+
+	EXPECT( Contains( HandleSchemaServiceRequest( "class CPlayer" ), "\"error\"" ) );
+
+	PublishSchemaServiceSnapshot( MakeStandInSnapshot( 0x3333 ) );
+
+	EXPECT( StartSchemaServiceServer( path.c_str(), err ) );
+	EXPECT( IsSchemaServiceServerRunning() );
+
+	TestRequests( path.c_str() );
+	TestRepublish( path.c_str() );
+
+	StopSchemaServiceServer();
+	EXPECT( !IsSchemaServiceServerRunning() );
+	EXPECT( access( path.c_str(), F_OK ) != 0 );
+
+	TestSocketFile( dir );
+	rmdir( dir.c_str() );
+
+	if(s_nFailures)
+	{
+		std::printf( "service_test: %d failures\n", s_nFailures );
+		return 1;
+	}
+
+	std::printf( "service_test: ok\n" );
+	return 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "standin_platform.h"
+
+#include <string>
+
+typedef int PluginId;
+
+class ISmmAPI
+{
+public:
+	const char *GetBaseDir() { return m_BaseDir.c_str(); }
+
+	// Stand-in only, the real one is the game directory
+	void SetBaseDir( std::string base_dir ) { m_BaseDir = std::move( base_dir ); }
+
+private:
+	std::string m_BaseDir;
+};
+
+extern ISmmAPI *g_SMAPI;
+
+class ISmmPlugin {};
+class IMetamodListener {};
+
+#define PLUGIN_GLOBALVARS()
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "standin_platform.h"
+
+#include <memory>
+#include <unordered_map>
+
+class CKV3MemberName
+{
+public:
+	CKV3MemberName( const char *name ) : m_pszName( name ) {}
+	const char *GetString() const { return m_pszName; }
+
+private:
+	const char *m_pszName;
+};
+
+enum KV3SubType_t
+{
+	KV3_SUBTYPE_STRING
+};
+
+// Tree of heap allocated nodes, so node pointers handed out stay valid while the tree grows
+// the same way they do within a kv3 arena
+class KeyValues3
+{
+public:
+	enum Kind_t
+	{
+		KIND_NULL,
+		KIND_BOOL,
+		KIND_INT,
+		KIND_UINT,
+		KIND_DOUBLE,
+		KIND_STRING,
+		KIND_ARRAY,
+		KIND_TABLE
+	};
+
+	KeyValues3() = default;
+	KeyValues3( const KeyValues3 &other ) { *this = other; }
+	KeyValues3 &operator=( const KeyValues3 &other );
+
+	KeyValues3 *FindMember( const CKV3MemberName &name, KeyValues3 *def = nullptr );
+	KeyValues3 *FindOrCreateMember( const CKV3MemberName &name, bool *created = nullptr );
+	int GetMemberCount() const { return (int)m_Members.size(); }
+	const char *GetMemberName( int idx ) const { return m_Members[idx].first.c_str(); }
+	KeyValues3 *GetMember( int idx ) { return m_Members[idx].second.get(); }
+
+	KeyValues3 *ArrayAddElementToTail();
+	KeyValues3 *GetArrayElement( int idx ) { return m_Elements[idx].get(); }
+	int GetArrayElementCount() const { return (int)m_Elements.size(); }
+	void SetArrayElementCount( int count );
+
+	void SetToNull();
+	void SetToEmptyTable();
+	void SetToEmptyArray();
+
+	void SetString( const char *value, KV3SubType_t = KV3_SUBTYPE_STRING );
+	void SetStringExternal( const char *value, KV3SubType_t subtype = KV3_SUBTYPE_STRING ) { SetString( value, subtype ); }
+	void SetBool( bool value );
+	void SetInt( int value ) { SetInt64( value ); }
+	void SetUInt( uint32 value ) { SetUInt64( value ); }
+	void SetInt64( int64 value );
+	void SetUInt64( uint64 value );
+	void SetFloat( float value ) { SetDouble( value ); }
+	void SetDouble( double value );
+
+	Kind_t GetKind() const { return m_Kind; }
+	bool IsNull() const { return m_Kind == KIND_NULL; }
+	bool IsArray() const { return m_Kind == KIND_ARRAY; }
+	bool IsTable() const { return m_Kind == KIND_TABLE; }
+
+	const char *GetString( const char *def = "" ) const { return m_Kind == KIND_STRING ? m_String.c_str() : def; }
+	bool GetBool( bool def = false ) const;
+	int GetInt( int def = 0 ) const { return (int)GetInt64( def ); }
+	uint32 GetUInt( uint32 def = 0 ) const { return (uint32)GetUInt64( def ); }
+	int64 GetInt64( int64 def = 0 ) const;
+	uint64 GetUInt64( uint64 def = 0 ) const;
+	float GetFloat( float def = 0 ) const { return (float)GetDouble( def ); }
+	double GetDouble( double def = 0 ) const;
+
+	const char *GetMemberString( const CKV3MemberName &name, const char *def = "" );
+	int GetMemberInt( const CKV3MemberName &name, int def = 0 );
+	uint32 GetMemberUInt( const CKV3MemberName &name, uint32 def = 0 );
+	int64 GetMemberInt64( const CKV3MemberName &name, int64 def = 0 );
+	uint64 GetMemberUInt64( const CKV3MemberName &name, uint64 def = 0 );
+
+	void SetMemberString( const CKV3MemberName &name, const char *value ) { FindOrCreateMember( name )->SetString( value ); }
+	void SetMemberInt( const CKV3MemberName &name, int value ) { FindOrCreateMember( name )->SetInt( value ); }
+	void SetMemberUInt( const CKV3MemberName &name, uint32 value ) { FindOrCreateMember( name )->SetUInt( value ); }
+	void SetMemberInt64( const CKV3MemberName &name, int64 value ) { FindOrCreateMember( name )->SetInt64( value ); }
+	void SetMemberUInt64( const CKV3MemberName &name, uint64 value ) { FindOrCreateMember( name )->SetUInt64( value ); }
+	void SetMemberUInt8( const CKV3MemberName &name, uint8 value ) { FindOrCreateMember( name )->SetUInt( value ); }
+	void SetMemberUShort( const CKV3MemberName &name, uint16 value ) { FindOrCreateMember( name )->SetUInt( value ); }
+	void SetMemberFloat( const CKV3MemberName &name, float value ) { FindOrCreateMember( name )->SetFloat( value ); }
+	void SetMemberDouble( const CKV3MemberName &name, double value ) { FindOrCreateMember( name )->SetDouble( value ); }
+	void SetMemberBool( const CKV3MemberName &name, bool value ) { FindOrCreateMember( name )->SetBool( value ); }
+
+private:
+	void Reset( Kind_t kind );
+
+	Kind_t m_Kind = KIND_NULL;
+
+	union
+	{
+		bool m_bBool;
+		int64 m_nInt;
+		uint64 m_nUInt;
+		double m_flDouble;
+	};
+
+	std::string m_String;
+	std::vector<std::unique_ptr<KeyValues3>> m_Elements;
+	std::vector<std::pair<std::string, std::unique_ptr<KeyValues3>>> m_Members;
+
+	// Member lookup by name, built once a table grows past a few members as the real tables hash their names too
+	std::unique_ptr<std::unordered_map<std::string, int>> m_MemberIndex;
+};
+
+class CKV3Arena
+{
+public:
+	CKV3Arena( bool = true ) {}
+	KeyValues3 *Root() { return &m_Root; }
+
+private:
+	KeyValues3 m_Root;
+};
+
+struct KV3ID_t
+{
+	const char *m_name;
+	uint64 m_nGUID1;
+	uint64 m_nGUID2;
+};
+
+extern KV3ID_t g_KV3Encoding_Text;
+extern KV3ID_t g_KV3Format_Generic;
+
+bool SaveKV3Text_ToString( const KV3ID_t &format, const KeyValues3 *kv, CUtlString *err, CUtlString *out, uint flags = 0 );
+bool SaveKV3Text_NoHeader( const KeyValues3 *kv, CUtlString *err, CUtlString *out, uint flags = 0 );
+bool SaveKV3AsJSON( const KeyValues3 *kv, CUtlString *err, CUtlString *out );
+
+// Text kv3 parsing isn't part of the stand-in and always fails, captures are json
+bool LoadKV3( KeyValues3 *kv, CUtlString *err, const char *input, const KV3ID_t &format = g_KV3Format_Generic, const char *name = nullptr, uint flags = 0 );
+bool LoadKV3FromJSON( KeyValues3 *kv, CUtlString *err, const char *input, const char *name = nullptr );
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "schematypes.h"
+
+#include <vector>
+
+class ISchemaSystem
+{
+public:
+	bool SchemaSystemIsReady() { return true; }
+};
+
+template <typename T>
+struct CUtlTSHashStandIn
+{
+	int GetNumStrings() const { return (int)m_Elements.size(); }
+	T operator[]( int idx ) const { return m_Elements[idx]; }
+
+	std::vector<T> m_Elements;
+};
+
+class CSchemaSystem : public ISchemaSystem
+{
+public:
+	CSchemaSystem() : m_GlobalTypeScope( "GlobalTypeScope" ) {}
+
+	CSchemaSystemTypeScope *GlobalTypeScope() { return &m_GlobalTypeScope; }
+
+	// Only unqualified names of the global scope are looked up, module qualified ones aren't supported
+	SchemaHandle<CSchemaClassInfo> FindClassByScopedName( const char *name ) { return m_GlobalTypeScope.FindDeclaredClass( name ); }
+
+	CUtlTSHashStandIn<CSchemaSystemTypeScope *> m_TypeScopes;
+
+private:
+	CSchemaSystemTypeScope m_GlobalTypeScope;
+};
+
+extern ISchemaSystem *g_pSchemaSystem;
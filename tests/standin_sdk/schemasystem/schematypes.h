@@ -0,0 +1,355 @@
+#pragma once
+
+#include "keyvalues3.h"
+
+#include <string>
+#include <unordered_map>
+
+class CSchemaSystemTypeScope;
+class CSchemaClassInfo;
+class CSchemaEnumInfo;
+class CSchemaType_DeclaredClass;
+class CSchemaType_DeclaredEnum;
+
+enum SchemaTypeCategory_t : uint8
+{
+	SCHEMA_TYPE_BUILTIN,
+	SCHEMA_TYPE_POINTER,
+	SCHEMA_TYPE_BITFIELD,
+	SCHEMA_TYPE_FIXED_ARRAY,
+	SCHEMA_TYPE_ATOMIC,
+	SCHEMA_TYPE_DECLARED_CLASS,
+	SCHEMA_TYPE_DECLARED_ENUM,
+	SCHEMA_TYPE_INVALID
+};
+
+enum SchemaAtomicCategory_t : uint8
+{
+	SCHEMA_ATOMIC_BASIC,
+	SCHEMA_ATOMIC_T,
+	SCHEMA_ATOMIC_COLLECTION_OF_T,
+	SCHEMA_ATOMIC_TF,
+	SCHEMA_ATOMIC_TT,
+	SCHEMA_ATOMIC_TTF,
+	SCHEMA_ATOMIC_I,
+	SCHEMA_ATOMIC_INVALID
+};
+
+enum SchemaBuiltinType_t
+{
+	SCHEMA_BUILTIN_TYPE_INVALID,
+	SCHEMA_BUILTIN_TYPE_VOID,
+	SCHEMA_BUILTIN_TYPE_CHAR,
+	SCHEMA_BUILTIN_TYPE_INT8,
+	SCHEMA_BUILTIN_TYPE_UINT8,
+	SCHEMA_BUILTIN_TYPE_INT16,
+	SCHEMA_BUILTIN_TYPE_UINT16,
+	SCHEMA_BUILTIN_TYPE_INT32,
+	SCHEMA_BUILTIN_TYPE_UINT32,
+	SCHEMA_BUILTIN_TYPE_INT64,
+	SCHEMA_BUILTIN_TYPE_UINT64,
+	SCHEMA_BUILTIN_TYPE_FLOAT32,
+	SCHEMA_BUILTIN_TYPE_FLOAT64,
+	SCHEMA_BUILTIN_TYPE_BOOL,
+	SCHEMA_BUILTIN_TYPE_COUNT
+};
+
+enum
+{
+	SCHEMA_CF1_HAS_VIRTUAL_MEMBERS = (1 << 0),
+	SCHEMA_CF1_IS_ABSTRACT = (1 << 1),
+	SCHEMA_CF1_HAS_TRIVIAL_CONSTRUCTOR = (1 << 2),
+	SCHEMA_CF1_HAS_TRIVIAL_DESTRUCTOR = (1 << 3),
+	SCHEMA_CF1_LIMITED_METADATA = (1 << 4),
+	SCHEMA_CF1_INHERITANCE_DEPTH_CALCULATED = (1 << 5),
+	SCHEMA_CF1_MODULE_LOCAL_TYPE_SCOPE = (1 << 6),
+	SCHEMA_CF1_GLOBAL_TYPE_SCOPE = (1 << 7),
+	SCHEMA_CF1_CONSTRUCT_ALLOWED = (1 << 8),
+	SCHEMA_CF1_CONSTRUCT_DISALLOWED = (1 << 9),
+	SCHEMA_CF1_INFO_TAG_MNetworkAssumeNotNetworkable = (1 << 10),
+	SCHEMA_CF1_INFO_TAG_MNetworkNoBase = (1 << 11),
+	SCHEMA_CF1_INFO_TAG_MIgnoreTypeScopeMetaChecks = (1 << 12),
+	SCHEMA_CF1_INFO_TAG_MDisableDataDescValidation = (1 << 13),
+	SCHEMA_CF1_INFO_TAG_MClassHasEntityLimitedDataDesc = (1 << 14),
+	SCHEMA_CF1_INFO_TAG_MClassHasCustomAlignedNewDelete = (1 << 15),
+	SCHEMA_CF1_UNK016 = (1 << 16),
+	SCHEMA_CF1_INFO_TAG_MConstructibleClassBase = (1 << 17),
+	SCHEMA_CF1_INFO_TAG_MHasKV3TransferPolymorphicClassname = (1 << 18)
+};
+
+enum
+{
+	SCHEMA_EF_IS_REGISTERED = (1 << 0),
+	SCHEMA_EF_MODULE_LOCAL_TYPE_SCOPE = (1 << 1),
+	SCHEMA_EF_GLOBAL_TYPE_SCOPE = (1 << 2)
+};
+
+struct SchemaMetadataEntryData_t
+{
+	const char *m_pszName;
+	void *m_pData;
+};
+
+template <typename T>
+struct CSchemaTypePtr
+{
+	T *Get() const { return m_pType; }
+
+	T *m_pType;
+};
+
+template <typename T>
+struct SchemaHandle
+{
+	T *Get() const { return m_pObject; }
+
+	T *m_pObject;
+};
+
+class CSchemaType
+{
+public:
+	virtual ~CSchemaType() = default;
+
+	// Sizes come from the capture rather than being computed from the type contents
+	virtual bool GetSizeAndAlignment( int &size, uint8 &alignment ) const
+	{
+		size = m_nStandInSize;
+		alignment = m_nStandInAlignment;
+		return true;
+	}
+
+	template <typename T>
+	bool IsA() const { return T::StandInMatches( this ); }
+
+	// nullptr on category mismatch, the real one asserts instead
+	template <typename T>
+	T *ReinterpretAs() const { return IsA<T>() ? static_cast<T *>(const_cast<CSchemaType *>(this)) : nullptr; }
+
+	static bool StandInMatches( const CSchemaType * ) { return true; }
+
+	CUtlString m_sTypeName;
+	CSchemaSystemTypeScope *m_pTypeScope = nullptr;
+	SchemaTypeCategory_t m_eTypeCategory = SCHEMA_TYPE_INVALID;
+	SchemaAtomicCategory_t m_eAtomicCategory = SCHEMA_ATOMIC_INVALID;
+
+	int m_nStandInSize = 0;
+	uint8 m_nStandInAlignment = 0;
+};
+
+class CSchemaType_Builtin : public CSchemaType
+{
+public:
+	static bool StandInMatches( const CSchemaType *type ) { return type->m_eTypeCategory == SCHEMA_TYPE_BUILTIN; }
+
+	SchemaBuiltinType_t m_eBuiltinType = SCHEMA_BUILTIN_TYPE_INVALID;
+	uint8 m_nSize = 0;
+};
+
+class CSchemaType_Ptr : public CSchemaType
+{
+public:
+	static bool StandInMatches( const CSchemaType *type ) { return type->m_eTypeCategory == SCHEMA_TYPE_POINTER; }
+
+	CSchemaTypePtr<CSchemaType> GetInnerType() const { return { m_pObjectType }; }
+
+	CSchemaType *m_pObjectType = nullptr;
+};
+
+struct SchemaAtomicTypeInfo_t
+{
+	const char *m_pszName;
+	const char *m_pszTokenName;
+	int m_nAtomicID;
+	int m_nStaticMetadataCount;
+	SchemaMetadataEntryData_t *m_pStaticMetadata;
+};
+
+class CSchemaType_Atomic : public CSchemaType
+{
+public:
+	static bool StandInMatches( const CSchemaType *type ) { return type->m_eTypeCategory == SCHEMA_TYPE_ATOMIC; }
+
+	SchemaAtomicTypeInfo_t *m_pAtomicInfo = nullptr;
+	int m_nAtomicID = -1;
+	uint16 m_nSize = 0;
+	uint8 m_nAlignment = 0;
+};
+
+class CSchemaType_Atomic_T : public CSchemaType_Atomic
+{
+public:
+	static bool StandInMatches( const CSchemaType *type )
+	{
+		return CSchemaType_Atomic::StandInMatches( type ) && (type->m_eAtomicCategory == SCHEMA_ATOMIC_T || type->m_eAtomicCategory == SCHEMA_ATOMIC_COLLECTION_OF_T || type->m_eAtomicCategory == SCHEMA_ATOMIC_TT);
+	}
+
+	void *m_pFuncs = nullptr;
+	CSchemaType *m_pTemplateType = nullptr;
+};
+
+class CSchemaType_Atomic_CollectionOfT : public CSchemaType_Atomic_T
+{
+public:
+	static bool StandInMatches( const CSchemaType *type ) { return CSchemaType_Atomic::StandInMatches( type ) && type->m_eAtomicCategory == SCHEMA_ATOMIC_COLLECTION_OF_T; }
+
+	uint16 m_nElementSize = 0;
+	uint64 m_nFixedBufferCount = 0;
+};
+
+class CSchemaType_Atomic_TT : public CSchemaType_Atomic_T
+{
+public:
+	static bool StandInMatches( const CSchemaType *type ) { return CSchemaType_Atomic::StandInMatches( type ) && type->m_eAtomicCategory == SCHEMA_ATOMIC_TT; }
+
+	CSchemaType *m_pTemplateType2 = nullptr;
+};
+
+class CSchemaType_Atomic_I : public CSchemaType_Atomic
+{
+public:
+	static bool StandInMatches( const CSchemaType *type ) { return CSchemaType_Atomic::StandInMatches( type ) && type->m_eAtomicCategory == SCHEMA_ATOMIC_I; }
+
+	int m_nInteger = 0;
+};
+
+class CSchemaType_DeclaredClass : public CSchemaType
+{
+public:
+	static bool StandInMatches( const CSchemaType *type ) { return type->m_eTypeCategory == SCHEMA_TYPE_DECLARED_CLASS; }
+
+	CSchemaClassInfo *m_pClassInfo = nullptr;
+	bool m_bGlobalPromotionRequired = false;
+};
+
+class CSchemaType_DeclaredEnum : public CSchemaType
+{
+public:
+	static bool StandInMatches( const CSchemaType *type ) { return type->m_eTypeCategory == SCHEMA_TYPE_DECLARED_ENUM; }
+
+	CSchemaEnumInfo *m_pEnumInfo = nullptr;
+};
+
+class CSchemaType_FixedArray : public CSchemaType
+{
+public:
+	static bool StandInMatches( const CSchemaType *type ) { return type->m_eTypeCategory == SCHEMA_TYPE_FIXED_ARRAY; }
+
+	CSchemaTypePtr<CSchemaType> GetInnerType() const { return { m_pElementType }; }
+
+	int m_nElementCount = 0;
+	uint16 m_nElementSize = 0;
+	uint8 m_nElementAlignment = 0;
+	CSchemaType *m_pElementType = nullptr;
+};
+
+class CSchemaType_Bitfield : public CSchemaType
+{
+public:
+	static bool StandInMatches( const CSchemaType *type ) { return type->m_eTypeCategory == SCHEMA_TYPE_BITFIELD; }
+
+	int m_nBitfieldCount = 0;
+};
+
+struct SchemaClassFieldData_t
+{
+	const char *m_pszName;
+	CSchemaType *m_pType;
+	int m_nSingleInheritanceOffset;
+	int m_nStaticMetadataCount;
+	SchemaMetadataEntryData_t *m_pStaticMetadata;
+};
+
+struct SchemaBaseClassInfoData_t
+{
+	uint m_nOffset;
+	CSchemaClassInfo *m_pClass;
+};
+
+struct SchemaClassInfoData_t
+{
+	void *m_pSelf;
+	const char *m_pszName;
+	const char *m_pszProjectName;
+	int m_nSize;
+	uint16 m_nFieldCount;
+	uint16 m_nStaticFieldCount;
+	uint16 m_nStaticMetadataCount;
+	uint8 m_nAlignment;
+	uint8 m_nBaseClassCount;
+	uint16 m_nMultipleInheritanceDepth;
+	uint16 m_nSingleInheritanceDepth;
+	SchemaClassFieldData_t *m_pFields;
+	void *m_pStaticFields;
+	SchemaBaseClassInfoData_t *m_pBaseClasses;
+	void *m_pFieldMetadataOverrides;
+	SchemaMetadataEntryData_t *m_pStaticMetadata;
+	CSchemaSystemTypeScope *m_pTypeScope;
+	CSchemaType_DeclaredClass *m_pDeclaredClass;
+	uint m_nFlags1;
+	uint m_nFlags2;
+	void *m_pFn;
+};
+
+class CSchemaClassInfo : public SchemaClassInfoData_t {};
+
+struct SchemaEnumeratorInfoData_t
+{
+	const char *m_pszName;
+	int64 m_nValue;
+	int m_nStaticMetadataCount;
+	SchemaMetadataEntryData_t *m_pStaticMetadata;
+};
+
+struct SchemaEnumInfoData_t
+{
+	void *m_pSelf;
+	const char *m_pszName;
+	const char *m_pszProjectName;
+	uint8 m_nSize;
+	uint8 m_nAlignment;
+	uint8 m_nFlags;
+	uint16 m_nEnumeratorCount;
+	uint16 m_nStaticMetadataCount;
+	SchemaEnumeratorInfoData_t *m_pEnumerators;
+	SchemaMetadataEntryData_t *m_pStaticMetadata;
+	CSchemaSystemTypeScope *m_pTypeScope;
+	int64 m_nMinEnumeratorValue;
+	int64 m_nMaxEnumeratorValue;
+};
+
+class CSchemaEnumInfo : public SchemaEnumInfoData_t {};
+
+template <typename T>
+struct CSchemaPtrMap
+{
+	CUtlOrderedMap<int, T> m_Map;
+};
+
+class CSchemaSystemTypeScope
+{
+public:
+	explicit CSchemaSystemTypeScope( const char *name );
+
+	const char *GetScopeName() { return m_ScopeName.c_str(); }
+
+	SchemaHandle<CSchemaClassInfo> FindDeclaredClass( const char *name );
+	SchemaHandle<CSchemaEnumInfo> FindDeclaredEnum( const char *name );
+
+	// Stand-in registration, the real scopes are filled in by the modules installing their schemas
+	void SetScopeName( const char *name );
+	void AddDeclaredClass( CSchemaType_DeclaredClass *type );
+	void AddDeclaredEnum( CSchemaType_DeclaredEnum *type );
+	void AddAtomicInfo( SchemaAtomicTypeInfo_t *info );
+
+	CSchemaType_Builtin m_BuiltinTypes[SCHEMA_BUILTIN_TYPE_COUNT];
+	CSchemaPtrMap<CSchemaType_DeclaredClass *> m_DeclaredClasses;
+	CSchemaPtrMap<CSchemaType_DeclaredEnum *> m_DeclaredEnums;
+	CSchemaPtrMap<SchemaHandle<SchemaAtomicTypeInfo_t>> m_AtomicInfos;
+
+private:
+	std::string m_ScopeName;
+
+	std::unordered_map<std::string, CSchemaType_DeclaredClass *> m_ClassesByName;
+	std::unordered_map<std::string, CSchemaType_DeclaredEnum *> m_EnumsByName;
+};
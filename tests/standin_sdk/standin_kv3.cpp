@@ -0,0 +1,698 @@
+#include "keyvalues3.h"
+
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+
+KV3ID_t g_KV3Encoding_Text = { "text", 0x41C58A33E21C7F3Cull, 0xADA7D3332AA7797Dull };
+KV3ID_t g_KV3Format_Generic = { "generic", 0x469806E97412167Cull, 0xE73790B53EE6F2AFull };
+
+static const int s_nMemberIndexThreshold = 16;
+
+KeyValues3 &KeyValues3::operator=( const KeyValues3 &other )
+{
+	if(this == &other)
+		return *this;
+
+	Reset( other.m_Kind );
+
+	switch(m_Kind)
+	{
+		case KIND_BOOL: m_bBool = other.m_bBool; break;
+		case KIND_INT: m_nInt = other.m_nInt; break;
+		case KIND_UINT: m_nUInt = other.m_nUInt; break;
+		case KIND_DOUBLE: m_flDouble = other.m_flDouble; break;
+		case KIND_STRING: m_String = other.m_String; break;
+
+		case KIND_ARRAY:
+		{
+			m_Elements.reserve( other.m_Elements.size() );
+			for(auto &elem : other.m_Elements)
+				m_Elements.push_back( std::make_unique<KeyValues3>( *elem ) );
+			break;
+		}
+
+		case KIND_TABLE:
+		{
+			m_Members.reserve( other.m_Members.size() );
+			for(auto &[name, member] : other.m_Members)
+				m_Members.emplace_back( name, std::make_unique<KeyValues3>( *member ) );
+
+			if(other.m_MemberIndex)
+				m_MemberIndex = std::make_unique<std::unordered_map<std::string, int>>( *other.m_MemberIndex );
+			break;
+		}
+
+		default: break;
+	}
+
+	return *this;
+}
+
+void KeyValues3::Reset( Kind_t kind )
+{
+	m_Kind = kind;
+	m_nUInt = 0;
+	m_String.clear();
+	m_Elements.clear();
+	m_Members.clear();
+	m_MemberIndex.reset();
+}
+
+KeyValues3 *KeyValues3::FindMember( const CKV3MemberName &name, KeyValues3 *def )
+{
+	if(m_Kind != KIND_TABLE)
+		return def;
+
+	if(m_MemberIndex)
+	{
+		auto iter = m_MemberIndex->find( name.GetString() );
+		return iter != m_MemberIndex->end() ? m_Members[iter->second].second.get() : def;
+	}
+
+	for(auto &[member_name, member] : m_Members)
+	{
+		if(member_name == name.GetString())
+			return member.get();
+	}
+
+	return def;
+}
+
+KeyValues3 *KeyValues3::FindOrCreateMember( const CKV3MemberName &name, bool *created )
+{
+	if(m_Kind != KIND_TABLE)
+		Reset( KIND_TABLE );
+
+	auto member = FindMember( name );
+
+	if(created)
+		*created = member == nullptr;
+
+	if(member)
+		return member;
+
+	m_Members.emplace_back( name.GetString(), std::make_unique<KeyValues3>() );
+
+	if(m_MemberIndex)
+	{
+		m_MemberIndex->emplace( m_Members.back().first, (int)m_Members.size() - 1 );
+	}
+	else if((int)m_Members.size() > s_nMemberIndexThreshold)
+	{
+		m_MemberIndex = std::make_unique<std::unordered_map<std::string, int>>();
+		for(int i = 0; i < (int)m_Members.size(); i++)
+			m_MemberIndex->emplace( m_Members[i].first, i );
+	}
+
+	return m_Members.back().second.get();
+}
+
+KeyValues3 *KeyValues3::ArrayAddElementToTail()
+{
+	if(m_Kind != KIND_ARRAY)
+		Reset( KIND_ARRAY );
+
+	m_Elements.push_back( std::make_unique<KeyValues3>() );
+	return m_Elements.back().get();
+}
+
+void KeyValues3::SetArrayElementCount( int count )
+{
+	if(m_Kind != KIND_ARRAY)
+		Reset( KIND_ARRAY );
+
+	m_Elements.reserve( count );
+
+	while((int)m_Elements.size() < count)
+		m_Elements.push_back( std::make_unique<KeyValues3>() );
+
+	m_Elements.resize( count );
+}
+
+void KeyValues3::SetToNull() { Reset( KIND_NULL ); }
+void KeyValues3::SetToEmptyTable() { Reset( KIND_TABLE ); }
+void KeyValues3::SetToEmptyArray() { Reset( KIND_ARRAY ); }
+
+void KeyValues3::SetString( const char *value, KV3SubType_t )
+{
+	Reset( KIND_STRING );
+	m_String = value ? value : "";
+}
+
+void KeyValues3::SetBool( bool value )
+{
+	Reset( KIND_BOOL );
+	m_bBool = value;
+}
+
+void KeyValues3::SetInt64( int64 value )
+{
+	Reset( KIND_INT );
+	m_nInt = value;
+}
+
+void KeyValues3::SetUInt64( uint64 value )
+{
+	Reset( KIND_UINT );
+	m_nUInt = value;
+}
+
+void KeyValues3::SetDouble( double value )
+{
+	Reset( KIND_DOUBLE );
+	m_flDouble = value;
+}
+
+bool KeyValues3::GetBool( bool def ) const
+{
+	switch(m_Kind)
+	{
+		case KIND_BOOL: return m_bBool;
+		case KIND_INT: return m_nInt != 0;
+		case KIND_UINT: return m_nUInt != 0;
+		default: return def;
+	}
+}
+
+int64 KeyValues3::GetInt64( int64 def ) const
+{
+	switch(m_Kind)
+	{
+		case KIND_BOOL: return m_bBool;
+		case KIND_INT: return m_nInt;
+		case KIND_UINT: return (int64)m_nUInt;
+		case KIND_DOUBLE: return (int64)m_flDouble;
+		default: return def;
+	}
+}
+
+uint64 KeyValues3::GetUInt64( uint64 def ) const
+{
+	switch(m_Kind)
+	{
+		case KIND_BOOL: return m_bBool;
+		case KIND_INT: return (uint64)m_nInt;
+		case KIND_UINT: return m_nUInt;
+		case KIND_DOUBLE: return (uint64)m_flDouble;
+		default: return def;
+	}
+}
+
+double KeyValues3::GetDouble( double def ) const
+{
+	switch(m_Kind)
+	{
+		case KIND_BOOL: return m_bBool;
+		case KIND_INT: return (double)m_nInt;
+		case KIND_UINT: return (double)m_nUInt;
+		case KIND_DOUBLE: return m_flDouble;
+		default: return def;
+	}
+}
+
+const char *KeyValues3::GetMemberString( const CKV3MemberName &name, const char *def )
+{
+	auto member = FindMember( name );
+	return member ? member->GetString( def ) : def;
+}
+
+int KeyValues3::GetMemberInt( const CKV3MemberName &name, int def )
+{
+	auto member = FindMember( name );
+	return member ? member->GetInt( def ) : def;
+}
+
+uint32 KeyValues3::GetMemberUInt( const CKV3MemberName &name, uint32 def )
+{
+	auto member = FindMember( name );
+	return member ? member->GetUInt( def ) : def;
+}
+
+int64 KeyValues3::GetMemberInt64( const CKV3MemberName &name, int64 def )
+{
+	auto member = FindMember( name );
+	return member ? member->GetInt64( def ) : def;
+}
+
+uint64 KeyValues3::GetMemberUInt64( const CKV3MemberName &name, uint64 def )
+{
+	auto member = FindMember( name );
+	return member ? member->GetUInt64( def ) : def;
+}
+
+static void WriteQuotedString( std::string &out, const std::string &str )
+{
+	out += '"';
+
+	for(unsigned char c : str)
+	{
+		switch(c)
+		{
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\r': out += "\\r"; break;
+			case '\t': out += "\\t"; break;
+
+			default:
+			{
+				if(c < 0x20)
+				{
+					char buf[8];
+					std::snprintf( buf, sizeof( buf ), "\\u%04x", c );
+					out += buf;
+				}
+				else
+				{
+					out += (char)c;
+				}
+			}
+		}
+	}
+
+	out += '"';
+}
+
+static void WriteNumber( std::string &out, const KeyValues3 *kv )
+{
+	char buf[64];
+	std::to_chars_result result;
+
+	if(kv->GetKind() == KeyValues3::KIND_INT)
+		result = std::to_chars( buf, buf + sizeof( buf ), kv->GetInt64() );
+	else if(kv->GetKind() == KeyValues3::KIND_UINT)
+		result = std::to_chars( buf, buf + sizeof( buf ), kv->GetUInt64() );
+	else
+		result = std::to_chars( buf, buf + sizeof( buf ), kv->GetDouble() );
+
+	out.append( buf, result.ptr );
+}
+
+static void WriteJSON( std::string &out, KeyValues3 *kv, int depth )
+{
+	switch(kv->GetKind())
+	{
+		case KeyValues3::KIND_NULL: out += "null"; break;
+		case KeyValues3::KIND_BOOL: out += kv->GetBool() ? "true" : "false"; break;
+		case KeyValues3::KIND_STRING: WriteQuotedString( out, kv->GetString() ); break;
+
+		case KeyValues3::KIND_INT:
+		case KeyValues3::KIND_UINT:
+		case KeyValues3::KIND_DOUBLE:
+		{
+			WriteNumber( out, kv );
+			break;
+		}
+
+		case KeyValues3::KIND_ARRAY:
+		{
+			out += '[';
+			for(int i = 0; i < kv->GetArrayElementCount(); i++)
+			{
+				out += i == 0 ? "\n" : ",\n";
+				out.append( depth + 1, '\t' );
+				WriteJSON( out, kv->GetArrayElement( i ), depth + 1 );
+			}
+
+			if(kv->GetArrayElementCount() > 0)
+			{
+				out += '\n';
+				out.append( depth, '\t' );
+			}
+			out += ']';
+			break;
+		}
+
+		case KeyValues3::KIND_TABLE:
+		{
+			out += '{';
+			for(int i = 0; i < kv->GetMemberCount(); i++)
+			{
+				out += i == 0 ? "\n" : ",\n";
+				out.append( depth + 1, '\t' );
+				WriteQuotedString( out, kv->GetMemberName( i ) );
+				out += ": ";
+				WriteJSON( out, kv->GetMember( i ), depth + 1 );
+			}
+
+			if(kv->GetMemberCount() > 0)
+			{
+				out += '\n';
+				out.append( depth, '\t' );
+			}
+			out += '}';
+			break;
+		}
+	}
+}
+
+static bool IsBareKV3Key( const std::string &name )
+{
+	if(name.empty() || std::isdigit( (unsigned char)name[0] ))
+		return false;
+
+	for(unsigned char c : name)
+	{
+		if(!std::isalnum( c ) && c != '_' && c != '.')
+			return false;
+	}
+
+	return true;
+}
+
+static void WriteKV3Text( std::string &out, KeyValues3 *kv, int depth )
+{
+	switch(kv->GetKind())
+	{
+		case KeyValues3::KIND_ARRAY:
+		{
+			out += "[\n";
+			for(int i = 0; i < kv->GetArrayElementCount(); i++)
+			{
+				out.append( depth + 1, '\t' );
+				WriteKV3Text( out, kv->GetArrayElement( i ), depth + 1 );
+				out += ",\n";
+			}
+			out.append( depth, '\t' );
+			out += ']';
+			break;
+		}
+
+		case KeyValues3::KIND_TABLE:
+		{
+			out += "{\n";
+			for(int i = 0; i < kv->GetMemberCount(); i++)
+			{
+				std::string name = kv->GetMemberName( i );
+
+				out.append( depth + 1, '\t' );
+				if(IsBareKV3Key( name ))
+					out += name;
+				else
+					WriteQuotedString( out, name );
+
+				out += " = ";
+				WriteKV3Text( out, kv->GetMember( i ), depth + 1 );
+				out += '\n';
+			}
+			out.append( depth, '\t' );
+			out += '}';
+			break;
+		}
+
+		default:
+		{
+			WriteJSON( out, kv, depth );
+			break;
+		}
+	}
+}
+
+bool SaveKV3Text_NoHeader( const KeyValues3 *kv, CUtlString *, CUtlString *out, uint )
+{
+	std::string buf;
+	WriteKV3Text( buf, const_cast<KeyValues3 *>(kv), 0 );
+	out->Set( std::move( buf ) );
+
+	return true;
+}
+
+bool SaveKV3Text_ToString( const KV3ID_t &format, const KeyValues3 *kv, CUtlString *, CUtlString *out, uint )
+{
+	std::string buf = "<!-- kv3 encoding:text:version{e21c7f3c-8a33-41c5-9977-a76d3a32aa0d} format:";
+	buf += format.m_name;
+	buf += ":version{7412167c-06e9-4698-aff2-e63eb59037e7} -->\n";
+
+	WriteKV3Text( buf, const_cast<KeyValues3 *>(kv), 0 );
+	buf += '\n';
+	out->Set( std::move( buf ) );
+
+	return true;
+}
+
+bool SaveKV3AsJSON( const KeyValues3 *kv, CUtlString *, CUtlString *out )
+{
+	std::string buf;
+	WriteJSON( buf, const_cast<KeyValues3 *>(kv), 0 );
+	buf += '\n';
+	out->Set( std::move( buf ) );
+
+	return true;
+}
+
+bool LoadKV3( KeyValues3 *, CUtlString *err, const char *, const KV3ID_t &, const char *, uint )
+{
+	err->Set( "text kv3 parsing isn't supported by the stand-in sdk" );
+	return false;
+}
+
+class JSONParser
+{
+public:
+	JSONParser( const char *input ) : m_pCur( input ) {}
+
+	bool Parse( KeyValues3 *kv, std::string &err )
+	{
+		if(!ParseValue( kv, 0 ))
+		{
+			err = m_Error;
+			return false;
+		}
+
+		SkipWhitespace();
+		if(*m_pCur != '\0')
+		{
+			err = "Trailing data after json root";
+			return false;
+		}
+
+		return true;
+	}
+
+private:
+	bool Fail( const char *what )
+	{
+		m_Error = what;
+		return false;
+	}
+
+	void SkipWhitespace()
+	{
+		while(*m_pCur == ' ' || *m_pCur == '\t' || *m_pCur == '\n' || *m_pCur == '\r')
+			m_pCur++;
+	}
+
+	bool Consume( char c )
+	{
+		SkipWhitespace();
+		if(*m_pCur != c)
+			return false;
+
+		m_pCur++;
+		return true;
+	}
+
+	bool ParseString( std::string &out )
+	{
+		if(!Consume( '"' ))
+			return Fail( "Expected string" );
+
+		while(*m_pCur != '"')
+		{
+			if(*m_pCur == '\0')
+				return Fail( "Unterminated string" );
+
+			if(*m_pCur != '\\')
+			{
+				out += *m_pCur++;
+				continue;
+			}
+
+			m_pCur++;
+			switch(*m_pCur++)
+			{
+				case '"': out += '"'; break;
+				case '\\': out += '\\'; break;
+				case '/': out += '/'; break;
+				case 'b': out += '\b'; break;
+				case 'f': out += '\f'; break;
+				case 'n': out += '\n'; break;
+				case 'r': out += '\r'; break;
+				case 't': out += '\t'; break;
+
+				case 'u':
+				{
+					unsigned int code = 0;
+					auto result = std::from_chars( m_pCur, m_pCur + 4, code, 16 );
+					if(result.ptr != m_pCur + 4)
+						return Fail( "Bad unicode escape" );
+
+					m_pCur += 4;
+
+					// Surrogate pairs aren't expected in schema names, encode what we get as utf8
+					if(code < 0x80)
+					{
+						out += (char)code;
+					}
+					else if(code < 0x800)
+					{
+						out += (char)(0xC0 | (code >> 6));
+						out += (char)(0x80 | (code & 0x3F));
+					}
+					else
+					{
+						out += (char)(0xE0 | (code >> 12));
+						out += (char)(0x80 | ((code >> 6) & 0x3F));
+						out += (char)(0x80 | (code & 0x3F));
+					}
+					break;
+				}
+
+				default: return Fail( "Bad escape sequence" );
+			}
+		}
+
+		m_pCur++;
+		return true;
+	}
+
+	bool ParseNumber( KeyValues3 *kv )
+	{
+		const char *start = m_pCur;
+		bool is_float = false;
+
+		if(*m_pCur == '-')
+			m_pCur++;
+
+		while(std::isdigit( (unsigned char)*m_pCur ) || *m_pCur == '.' || *m_pCur == 'e' || *m_pCur == 'E' || *m_pCur == '+' || *m_pCur == '-')
+		{
+			if(!std::isdigit( (unsigned char)*m_pCur ))
+				is_float = true;
+
+			m_pCur++;
+		}
+
+		if(start == m_pCur)
+			return Fail( "Expected value" );
+
+		if(!is_float)
+		{
+			int64 value = 0;
+			if(std::from_chars( start, m_pCur, value ).ptr == m_pCur)
+			{
+				kv->SetInt64( value );
+				return true;
+			}
+
+			uint64 uvalue = 0;
+			if(std::from_chars( start, m_pCur, uvalue ).ptr == m_pCur)
+			{
+				kv->SetUInt64( uvalue );
+				return true;
+			}
+		}
+
+		kv->SetDouble( std::strtod( start, nullptr ) );
+		return true;
+	}
+
+	bool ParseLiteral( const char *literal )
+	{
+		size_t len = std::strlen( literal );
+		if(std::strncmp( m_pCur, literal, len ) != 0)
+			return false;
+
+		m_pCur += len;
+		return true;
+	}
+
+	bool ParseValue( KeyValues3 *kv, int depth )
+	{
+		if(depth > 512)
+			return Fail( "Json nesting is too deep" );
+
+		SkipWhitespace();
+
+		switch(*m_pCur)
+		{
+			case '{':
+			{
+				m_pCur++;
+				kv->SetToEmptyTable();
+
+				if(Consume( '}' ))
+					return true;
+
+				do
+				{
+					std::string name;
+					if(!ParseString( name ))
+						return false;
+
+					if(!Consume( ':' ))
+						return Fail( "Expected ':' after member name" );
+
+					if(!ParseValue( kv->FindOrCreateMember( name.c_str() ), depth + 1 ))
+						return false;
+				} while(Consume( ',' ));
+
+				return Consume( '}' ) || Fail( "Expected '}'" );
+			}
+
+			case '[':
+			{
+				m_pCur++;
+				kv->SetToEmptyArray();
+
+				if(Consume( ']' ))
+					return true;
+
+				do
+				{
+					if(!ParseValue( kv->ArrayAddElementToTail(), depth + 1 ))
+						return false;
+				} while(Consume( ',' ));
+
+				return Consume( ']' ) || Fail( "Expected ']'" );
+			}
+
+			case '"':
+			{
+				std::string value;
+				if(!ParseString( value ))
+					return false;
+
+				kv->SetString( value.c_str() );
+				return true;
+			}
+
+			default:
+			{
+				if(ParseLiteral( "null" ))
+					kv->SetToNull();
+				else if(ParseLiteral( "true" ))
+					kv->SetBool( true );
+				else if(ParseLiteral( "false" ))
+					kv->SetBool( false );
+				else
+					return ParseNumber( kv );
+
+				return true;
+			}
+		}
+	}
+
+	const char *m_pCur;
+	std::string m_Error;
+};
+
+bool LoadKV3FromJSON( KeyValues3 *kv, CUtlString *err, const char *input, const char *name )
+{
+	std::string parse_err;
+	if(JSONParser( input ).Parse( kv, parse_err ))
+		return true;
+
+	err->Set( std::string( name ? name : "json" ) + ": " + parse_err );
+	return false;
+}
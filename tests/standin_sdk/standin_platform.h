@@ -0,0 +1,130 @@
+#pragma once
+
+// Stand-in of the tier0/tier1 pieces the dumper uses, just enough to run the reader offline
+// against a replayed capture (see capture_replay.h). Not a reimplementation of the sdk,
+// only the behaviour the dumper relies on is mirrored
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <utility>
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+typedef int64_t int64;
+typedef unsigned int uint;
+
+#define SE_CS2 1
+#define SOURCE_ENGINE SE_CS2
+
+#define ARRAYSIZE( a ) ((int)(sizeof( a ) / sizeof( (a)[0] )))
+#define META_CONPRINTF( ... ) StandInConPrintf( __VA_ARGS__ )
+
+// Console output can be muted, so timed runs aren't dominated by printing
+extern bool g_bStandInConsoleMuted;
+void StandInConPrintf( const char *fmt, ... );
+
+struct empty_t {};
+
+struct Vector
+{
+	float x, y, z;
+};
+
+struct Color
+{
+	int r() const { return m_Color[0]; }
+	int g() const { return m_Color[1]; }
+	int b() const { return m_Color[2]; }
+	int a() const { return m_Color[3]; }
+
+	uint8 m_Color[4];
+};
+
+struct CUtlStringToken
+{
+	uint32 m_nHashCode;
+};
+
+class CUtlString
+{
+public:
+	CUtlString() = default;
+	CUtlString( const char *str ) : m_String( str ? str : "" ) {}
+
+	const char *Get() const { return m_String.c_str(); }
+	const char *String() const { return m_String.c_str(); }
+	int Length() const { return (int)m_String.length(); }
+	bool IsEmpty() const { return m_String.empty(); }
+	operator const char *() const { return m_String.c_str(); }
+
+	void Set( std::string str ) { m_String = std::move( str ); }
+
+private:
+	std::string m_String;
+};
+
+class CBufferString
+{
+public:
+	const char *Get() const { return m_String.c_str(); }
+
+	std::string m_String;
+};
+
+template <typename T>
+class CUtlVector
+{
+public:
+	int Count() const { return (int)m_Elements.size(); }
+	T &operator[]( int idx ) { return m_Elements[idx]; }
+	const T &operator[]( int idx ) const { return m_Elements[idx]; }
+	void AddToTail( const T &elem ) { m_Elements.push_back( elem ); }
+
+private:
+	std::vector<T> m_Elements;
+};
+
+// Empty pieces are never kept
+class CSplitString
+{
+public:
+	CSplitString( const char *str, const char *separator );
+	CSplitString( const char *str, const char **separators, int separator_count, bool include_empty = false );
+
+	int Count() const { return (int)m_Pieces.size(); }
+	const char *operator[]( int idx ) const { return m_Pieces[idx].c_str(); }
+	void Remove( int idx ) { m_Pieces.erase( m_Pieces.begin() + idx ); }
+
+private:
+	std::vector<std::string> m_Pieces;
+};
+
+// Ordered map stand-in, iterated in insertion order which is all the dumper relies on
+template <typename K, typename V>
+class CUtlOrderedMap
+{
+public:
+	V &Element( int idx ) { return m_Elements[idx].second; }
+	const V &Element( int idx ) const { return m_Elements[idx].second; }
+	int Count() const { return (int)m_Elements.size(); }
+	int FirstInorder() const { return m_Elements.empty() ? InvalidIndex() : 0; }
+	int NextInorder( int idx ) const { return idx + 1 < Count() ? idx + 1 : InvalidIndex(); }
+	static int InvalidIndex() { return -1; }
+
+	void Insert( const K &key, const V &value ) { m_Elements.emplace_back( key, value ); }
+
+private:
+	std::vector<std::pair<K, V>> m_Elements;
+};
+
+#define FOR_EACH_MAP( mapName, iteratorName ) for(int iteratorName = (mapName).FirstInorder(); iteratorName != (mapName).InvalidIndex(); iteratorName = (mapName).NextInorder( iteratorName ))
@@ -0,0 +1,109 @@
+#include "schemasystem/schemasystem.h"
+#include "ISmmPlugin.h"
+#include "plugin.h"
+
+#include <cstdarg>
+
+static ISmmAPI s_SMAPI;
+
+ISmmAPI *g_SMAPI = &s_SMAPI;
+ISchemaSystem *g_pSchemaSystem = nullptr;
+MMSPlugin g_ThisPlugin;
+bool g_bStandInConsoleMuted = false;
+
+void StandInConPrintf( const char *fmt, ... )
+{
+	if(g_bStandInConsoleMuted)
+		return;
+
+	va_list args;
+	va_start( args, fmt );
+	std::vprintf( fmt, args );
+	va_end( args );
+}
+
+CSplitString::CSplitString( const char *str, const char *separator )
+	: CSplitString( str, &separator, 1 )
+{}
+
+CSplitString::CSplitString( const char *str, const char **separators, int separator_count, bool include_empty )
+{
+	std::string piece;
+
+	while(*str)
+	{
+		int matched = 0;
+		for(int i = 0; i < separator_count && matched == 0; i++)
+		{
+			int len = (int)std::strlen( separators[i] );
+			if(len > 0 && std::strncmp( str, separators[i], len ) == 0)
+				matched = len;
+		}
+
+		if(matched == 0)
+		{
+			piece += *str++;
+			continue;
+		}
+
+		if(include_empty || !piece.empty())
+			m_Pieces.push_back( piece );
+
+		piece.clear();
+		str += matched;
+	}
+
+	if(include_empty || !piece.empty())
+		m_Pieces.push_back( piece );
+}
+
+CSchemaSystemTypeScope::CSchemaSystemTypeScope( const char *name )
+	: m_ScopeName( name )
+{
+	for(int i = 0; i < SCHEMA_BUILTIN_TYPE_COUNT; i++)
+	{
+		m_BuiltinTypes[i].m_eTypeCategory = SCHEMA_TYPE_BUILTIN;
+		m_BuiltinTypes[i].m_eBuiltinType = (SchemaBuiltinType_t)i;
+		m_BuiltinTypes[i].m_pTypeScope = this;
+	}
+}
+
+SchemaHandle<CSchemaClassInfo> CSchemaSystemTypeScope::FindDeclaredClass( const char *name )
+{
+	auto iter = m_ClassesByName.find( name );
+	if(iter == m_ClassesByName.end())
+		return { nullptr };
+
+	return { iter->second->m_pClassInfo };
+}
+
+SchemaHandle<CSchemaEnumInfo> CSchemaSystemTypeScope::FindDeclaredEnum( const char *name )
+{
+	auto iter = m_EnumsByName.find( name );
+	if(iter == m_EnumsByName.end())
+		return { nullptr };
+
+	return { iter->second->m_pEnumInfo };
+}
+
+void CSchemaSystemTypeScope::SetScopeName( const char *name )
+{
+	m_ScopeName = name;
+}
+
+void CSchemaSystemTypeScope::AddDeclaredClass( CSchemaType_DeclaredClass *type )
+{
+	m_DeclaredClasses.m_Map.Insert( m_DeclaredClasses.m_Map.Count(), type );
+	m_ClassesByName.emplace( type->m_sTypeName.Get(), type );
+}
+
+void CSchemaSystemTypeScope::AddDeclaredEnum( CSchemaType_DeclaredEnum *type )
+{
+	m_DeclaredEnums.m_Map.Insert( m_DeclaredEnums.m_Map.Count(), type );
+	m_EnumsByName.emplace( type->m_sTypeName.Get(), type );
+}
+
+void CSchemaSystemTypeScope::AddAtomicInfo( SchemaAtomicTypeInfo_t *info )
+{
+	m_AtomicInfos.m_Map.Insert( info->m_nAtomicID, { info } );
+}
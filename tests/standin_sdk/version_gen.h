@@ -0,0 +1,10 @@
+#pragma once
+
+#define PLUGIN_AUTHOR ""
+#define PLUGIN_DISPLAY_NAME "SchemaDump"
+#define PLUGIN_DESCRIPTION ""
+#define PLUGIN_URL ""
+#define PLUGIN_LICENSE ""
+#define PLUGIN_FULL_VERSION "replay"
+#define PLUGIN_LOGTAG "SCHEMADUMP"
+#define PLUGIN_NAME "schemadump"
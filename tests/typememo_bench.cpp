@@ -0,0 +1,105 @@
+#include "schematypememo.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Stand-in of CSchemaType, size query is virtual as it is in schema system
+struct BenchTypeName
+{
+	std::string m_Name;
+	const char *Get() const { return m_Name.c_str(); }
+};
+
+struct BenchType
+{
+	BenchType( std::string name, int size, uint8_t alignment ) : m_sTypeName{ std::move( name ) }, m_nSize( size ), m_nAlignment( alignment ) {}
+	virtual ~BenchType() = default;
+
+	virtual bool GetSizeAndAlignment( int &size, uint8_t &alignment )
+	{
+		size = m_nSize;
+		alignment = m_nAlignment;
+		return true;
+	}
+
+	BenchTypeName m_sTypeName;
+	int m_nSize;
+	uint8_t m_nAlignment;
+};
+
+// Synthetic schema with heavy atomic reuse: few distinct types, most of them scoped and templated atomics,
+// referenced by every member of every class as a real server project does with CHandle, CNetworkVar etc.
+static const int s_nClassCount = 4000;
+static const int s_nMembersPerClass = 24;
+static const int s_nTypeCount = 256;
+static const int s_nPasses = 4;
+
+static const char *s_AtomicNames[] = {
+	"CHandle< CBaseEntity >",
+	"CUtlVector< CHandle< CBaseEntity > >",
+	"CNetworkUtlVectorBase< CEntityHandle >",
+	"CUtlSymbolLarge",
+	"CEntityIOOutput::CEntityOutputTemplate< float32 >",
+	"CStrongHandle< InfoForResourceTypeCModel >",
+	"CResourceNameTyped< CWeakHandle< InfoForResourceTypeCPostProcessingResource > >",
+	"GameTime_t::Value_t"
+};
+
+int main()
+{
+	std::vector<std::unique_ptr<BenchType>> types;
+	for(int i = 0; i < s_nTypeCount; i++)
+	{
+		auto &name = s_AtomicNames[i % (sizeof( s_AtomicNames ) / sizeof( s_AtomicNames[0] ))];
+		types.push_back( std::make_unique<BenchType>( std::string( "Scope" ) + std::to_string( i ) + "::" + name, 8 + (i % 4) * 8, 8 ) );
+	}
+
+	// Skewed towards the first types, as handles and network vars dominate real member lists
+	std::vector<BenchType *> references;
+	references.reserve( s_nClassCount * s_nMembersPerClass );
+	for(int i = 0; i < s_nClassCount * s_nMembersPerClass; i++)
+		references.push_back( types[((size_t)i * 7919) % ((i % 3) ? 16 : s_nTypeCount)].get() );
+
+	size_t checksum_uncached = 0, checksum_memo = 0;
+
+	auto uncached_start = std::chrono::steady_clock::now();
+	for(int pass = 0; pass < s_nPasses; pass++)
+	{
+		for(auto type : references)
+		{
+			SchemaTypeAttributes attributes;
+			SchemaTypeMemo<BenchType>::Compute( type, attributes );
+			checksum_uncached += attributes.m_nSize + attributes.m_DisplayName.size() + attributes.m_SplitName.size();
+		}
+	}
+	auto uncached_end = std::chrono::steady_clock::now();
+
+	SchemaTypeMemo<BenchType> memo;
+
+	auto memo_start = std::chrono::steady_clock::now();
+	for(int pass = 0; pass < s_nPasses; pass++)
+	{
+		for(auto type : references)
+		{
+			auto &attributes = memo.Get( type );
+			checksum_memo += attributes.m_nSize + attributes.m_DisplayName.size() + attributes.m_SplitName.size();
+		}
+	}
+	auto memo_end = std::chrono::steady_clock::now();
+
+	if(checksum_uncached != checksum_memo)
+	{
+		std::printf( "typememo_bench: memo results differ from uncached ones\n" );
+		return 1;
+	}
+
+	auto uncached_ms = std::chrono::duration<double, std::milli>( uncached_end - uncached_start ).count();
+	auto memo_ms = std::chrono::duration<double, std::milli>( memo_end - memo_start ).count();
+
+	std::printf( "typememo_bench: %zu references of %zu types, uncached %.2f ms, memo %.2f ms (%.1fx)\n",
+				 references.size() * s_nPasses, memo.Count(), uncached_ms, memo_ms, uncached_ms / memo_ms );
+	return 0;
+}